@@ -0,0 +1,43 @@
+//
+// Created by volt on 2026-10-19.
+//
+
+
+
+
+#ifndef LPG_ENGINE_BENCH_SRC_BENCHMARK_HPP_
+#define LPG_ENGINE_BENCH_SRC_BENCHMARK_HPP_
+
+#include <algorithm>
+#include <chrono>
+#include <limits>
+
+namespace lpg::bench {
+
+    /*
+     * Runs fn once to warm up, then numRuns times, and returns the fastest run in seconds.
+     */
+    template<typename Fn>
+    double MeasureFastest(int numRuns, Fn&& fn) {
+        fn();
+        double fastest = std::numeric_limits<double>::infinity();
+        for (int i = 0; i < numRuns; i++) {
+            auto start = std::chrono::steady_clock::now();
+            fn();
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            fastest = std::min(fastest, elapsed.count());
+        }
+        return fastest;
+    }
+
+    /*
+     * Each prints one line per measurement.
+     */
+    void RunSerializationBenchmark();
+    void RunConfigBenchmark();
+    void RunTransformBenchmark();
+    void RunCollisionBenchmark();
+
+} // lpg::bench
+
+#endif //LPG_ENGINE_BENCH_SRC_BENCHMARK_HPP_
@@ -0,0 +1,191 @@
+//
+// Created by volt on 2026-10-19.
+//
+
+
+
+
+#include "Benchmark.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <span>
+#include <vector>
+
+#include <bullet/btBulletDynamicsCommon.h>
+
+#include <lpg/core/World.hpp>
+#include <lpg/core/entity_codegen.hpp>
+#include <lpg/systems/SimpleCollisionSystem.hpp>
+#include <lpg/util/SimdKernels.hpp>
+
+namespace lpg::bench {
+
+    struct MovingBoxTrigger {
+        al::Vec3f position;
+        al::Vec3f rotation;
+        al::Vec3f scale {1.0f, 1.0f, 1.0f};
+    };
+
+    struct MovingSphereTrigger {
+        al::Vec3f position;
+        al::Vec3f rotation;
+        al::Vec3f scale {1.0f, 1.0f, 1.0f};
+    };
+
+    LPG_REGISTER_ENTITY_TYPE(MovingBoxTrigger);
+    LPG_REGISTER_ENTITY_TYPE(MovingSphereTrigger);
+
+    namespace detail {
+        /*
+         * Writes positions into the entities of the type in page order, i.e. the order in which they were spawned.
+         */
+        template<typename TEntity>
+        static void SetPositions(World& world, std::span<const al::Vec3f> positions) {
+            size_t next = 0;
+            for (int pageId: world.getPagesOfType(lpg::detail::GetEntityTypeId<TEntity>())) {
+                auto& page = world.getPage(pageId);
+                for (auto [beg, end]: page.getActiveRanges()) {
+                    for (int slot = beg; slot < end; slot++) {
+                        static_cast<TEntity*>(page.entityPtr(slot))->position = positions[next++];
+                    }
+                }
+            }
+        }
+
+        static const char* InstructionSetName(simd::InstructionSet instructionSet) {
+            switch (instructionSet) {
+                case simd::InstructionSet::AVX2: return "AVX2";
+                case simd::InstructionSet::SSE2: return "SSE2";
+                default: return "scalar";
+            }
+        }
+
+        /*
+         * Bounces off the walls of the cube [-halfSize, halfSize]^3.
+         */
+        static void Move(float& coordinate, float& velocity, float halfSize, double deltaTime) {
+            coordinate += velocity * static_cast<float>(deltaTime);
+            if (coordinate < -halfSize || coordinate > halfSize) {
+                velocity = -velocity;
+            }
+        }
+
+        static int CountBulletOverlaps(btCollisionDispatcher& dispatcher) {
+            int result = 0;
+            for (int i = 0; i < dispatcher.getNumManifolds(); i++) {
+                if (dispatcher.getManifoldByIndexInternal(i)->getNumContacts() > 0) {
+                    result++;
+                }
+            }
+            return result;
+        }
+    }
+
+    void RunCollisionBenchmark() {
+        constexpr int NumTriggers = 50'000; // the first half boxes, the second half spheres
+        constexpr int NumSteps = 120;
+        constexpr float HalfSize = 50.0f; // about 10k overlaps between unit colliders
+        constexpr float MaxSpeed = 5.0f;
+        constexpr double DeltaTime = 1.0 / 60.0;
+
+        // the collider gather runs on these
+        for (const auto& report: simd::ValidateKernels()) {
+            std::printf("collision: %s gather/scatter kernels %s validation against scalar\n",
+                        detail::InstructionSetName(report.instructionSet), report.passed() ? "pass" : "FAIL");
+        }
+
+        std::mt19937 rng(1);
+        std::uniform_real_distribution<float> coordinate(-HalfSize, HalfSize);
+        std::uniform_real_distribution<float> speed(-MaxSpeed, MaxSpeed);
+        std::vector<al::Vec3f> positions(NumTriggers), velocities(NumTriggers);
+        for (int i = 0; i < NumTriggers; i++) {
+            positions[i] = {coordinate(rng), coordinate(rng), coordinate(rng)};
+            velocities[i] = {speed(rng), speed(rng), speed(rng)};
+        }
+        std::span<const al::Vec3f> boxPositions = std::span(positions).first(NumTriggers / 2);
+        std::span<const al::Vec3f> spherePositions = std::span(positions).subspan(NumTriggers / 2);
+
+        World world;
+        world.setNumWorkerThreads(0);
+        world.finalizeInit();
+        for (const auto& position: boxPositions) {
+            world.spawnEntity<MovingBoxTrigger>(MovingBoxTrigger {.position = position});
+        }
+        for (const auto& position: spherePositions) {
+            world.spawnEntity<MovingSphereTrigger>(MovingSphereTrigger {.position = position});
+        }
+        SimpleCollisionSystem collisionSystem(world);
+        collisionSystem.addEntityType<MovingBoxTrigger>({.shape = SimpleColliderShape::Box});
+        collisionSystem.addEntityType<MovingSphereTrigger>({.shape = SimpleColliderShape::Sphere});
+
+        // the usual Bullet setup for triggers: collision objects without contact response, in a collision world only;
+        // collision objects start out static, and static objects are filtered out of pairs with each other
+        btDefaultCollisionConfiguration collisionConfiguration;
+        btCollisionDispatcher dispatcher {&collisionConfiguration};
+        btDbvtBroadphase broadphase;
+        btBoxShape boxShape {btVector3(0.5f, 0.5f, 0.5f)};
+        btSphereShape sphereShape {0.5f};
+        std::vector<btCollisionObject> objects(NumTriggers);
+        btCollisionWorld collisionWorld {&dispatcher, &broadphase, &collisionConfiguration};
+        for (int i = 0; i < NumTriggers; i++) {
+            auto& object = objects[i];
+            object.setCollisionShape(i < NumTriggers / 2 ? static_cast<btCollisionShape*>(&boxShape) : &sphereShape);
+            object.setCollisionFlags((object.getCollisionFlags() & ~btCollisionObject::CF_STATIC_OBJECT) | btCollisionObject::CF_NO_CONTACT_RESPONSE);
+            object.getWorldTransform().setOrigin(btVector3(positions[i].x, positions[i].y, positions[i].z));
+            collisionWorld.addCollisionObject(&object);
+        }
+
+        std::chrono::duration<double> lpgSeconds {}, bulletSeconds {};
+        long long lpgOverlaps = 0, bulletOverlaps = 0;
+        FixedUpdateMessage message {DeltaTime};
+        // step 0 builds the sweep order and the tree from scratch, and is not counted
+        for (int step = 0; step <= NumSteps; step++) {
+            if (step > 0) {
+                for (int i = 0; i < NumTriggers; i++) {
+                    detail::Move(positions[i].x, velocities[i].x, HalfSize, DeltaTime);
+                    detail::Move(positions[i].y, velocities[i].y, HalfSize, DeltaTime);
+                    detail::Move(positions[i].z, velocities[i].z, HalfSize, DeltaTime);
+                }
+                detail::SetPositions<MovingBoxTrigger>(world, boxPositions);
+                detail::SetPositions<MovingSphereTrigger>(world, spherePositions);
+            }
+
+            auto start = std::chrono::steady_clock::now();
+            collisionSystem.msg(&message);
+            auto lpgEnd = std::chrono::steady_clock::now();
+            for (int i = 0; i < NumTriggers; i++) {
+                objects[i].getWorldTransform().setOrigin(btVector3(positions[i].x, positions[i].y, positions[i].z));
+            }
+            collisionWorld.performDiscreteCollisionDetection();
+            auto bulletEnd = std::chrono::steady_clock::now();
+
+            if (step > 0) {
+                lpgSeconds += lpgEnd - start;
+                bulletSeconds += bulletEnd - lpgEnd;
+                lpgOverlaps += collisionSystem.getLastStepStats().numOverlaps;
+                bulletOverlaps += detail::CountBulletOverlaps(dispatcher);
+            }
+        }
+
+        // the same positions again with the scalar kernels
+        std::vector<OverlapPair> overlaps(collisionSystem.getOverlaps().begin(), collisionSystem.getOverlaps().end());
+        simd::InstructionSet instructionSet = simd::GetInstructionSet();
+        simd::SetInstructionSet(simd::InstructionSet::Scalar);
+        collisionSystem.msg(&message);
+        bool sameOverlaps = std::ranges::equal(overlaps, collisionSystem.getOverlaps());
+        simd::SetInstructionSet(instructionSet);
+
+        double lpgStepMs = lpgSeconds.count() * 1e3 / NumSteps;
+        double bulletStepMs = bulletSeconds.count() * 1e3 / NumSteps;
+        std::printf("collision: %d moving triggers, %d steps\n", NumTriggers, NumSteps);
+        std::printf("collision: SimpleCollisionSystem %.2f ms/step, %lld overlaps/step\n", lpgStepMs, lpgOverlaps / NumSteps);
+        std::printf("collision: %s and scalar gathers find %s overlaps\n", detail::InstructionSetName(instructionSet), sameOverlaps ? "the same" : "DIFFERENT");
+        // Bullet keeps pairs within its contact breaking threshold, so it may report slightly more
+        std::printf("collision: Bullet btCollisionWorld (btDbvtBroadphase) %.2f ms/step, %lld overlaps/step\n", bulletStepMs, bulletOverlaps / NumSteps);
+        std::printf("collision: SimpleCollisionSystem is %.1fx the speed of Bullet\n", bulletStepMs / lpgStepMs);
+    }
+
+} // lpg::bench
@@ -0,0 +1,139 @@
+//
+// Created by volt on 2026-10-19.
+//
+
+
+
+
+#include "Benchmark.hpp"
+
+#include <cstdio>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <lpg/core/ConfigLoader.hpp>
+#include <lpg/core/Registry.hpp>
+
+namespace lpg::bench {
+
+    namespace detail {
+        constexpr int NumConfigKeys = 100'000;
+        constexpr int NumConfigKeysPerSection = 64;
+
+        static std::string GetConfigSection(int i) {
+            return std::format("s{}", i / NumConfigKeysPerSection);
+        }
+
+        static std::string GetConfigKey(int i) {
+            return std::format("k{}", i);
+        }
+
+        /*
+         * Key i holds an int, a float, a bool, a Vec3f or a string, in turn; variant shifts every value.
+         */
+        static std::string FormatConfigValue(int i, int variant, bool json) {
+            int value = i + variant;
+            switch (i % 5) {
+                case 0: return std::format("{}", value);
+                case 1: return std::format("{}.5", value % 1000);
+                case 2: return value % 2 ? "true" : "false";
+                case 3: return json ? std::format("[{}, {}.25, -{}]", value % 100, value % 7, value % 13)
+                                    : std::format("{},{}.25,-{}", value % 100, value % 7, value % 13);
+                default: return std::format("\"player{}\"", value);
+            }
+        }
+
+        static std::string MakeKeyValueConfig(int variant) {
+            std::string text;
+            for (int i = 0; i < NumConfigKeys; i++) {
+                if (i % NumConfigKeysPerSection == 0) {
+                    text += std::format("[mod.{}]\n", GetConfigSection(i));
+                }
+                text += std::format("{} = {}\n", GetConfigKey(i), FormatConfigValue(i, variant, false));
+            }
+            return text;
+        }
+
+        static std::string MakeJsonConfig(int variant) {
+            std::string text = "{\"mod\": {";
+            for (int i = 0; i < NumConfigKeys; i++) {
+                if (i % NumConfigKeysPerSection == 0) {
+                    text += std::format("{}\"{}\": {{", i == 0 ? "" : "}, ", GetConfigSection(i));
+                } else {
+                    text += ", ";
+                }
+                text += std::format("\"{}\": {}", GetConfigKey(i), FormatConfigValue(i, variant, true));
+            }
+            text += "}}}";
+            return text;
+        }
+
+        static void PrintConfigLoadResult(const char* what, size_t numBytes, double seconds, const ConfigLoadResult& result) {
+            std::printf("config: %s, %d keys (%.2f MB) in %.3f ms, %d changed%s\n",
+                        what, result.numLoaded, static_cast<double>(numBytes) / 1e6, seconds * 1e3, result.numChanged,
+                        result.errors.empty() ? "" : std::format(" ({} ERRORS, first: {})", result.errors.size(), result.errors.front()).c_str());
+        }
+    }
+
+    void RunConfigBenchmark() {
+        constexpr int NumRuns = 10;
+
+        Registry registry;
+        std::vector<RegistryValueDeclaration> declarations;
+        for (int i = 0; i < detail::NumConfigKeys; i++) {
+            DataUnit defaultValue;
+            switch (i % 5) {
+                case 0: defaultValue = int32_t{0}; break;
+                case 1: defaultValue = 0.0f; break;
+                case 2: defaultValue = false; break;
+                case 3: defaultValue = al::Vec3f {}; break;
+                default: defaultValue = std::string(); break;
+            }
+            declarations.push_back({
+                .key = std::format("mod.{}.{}", detail::GetConfigSection(i), detail::GetConfigKey(i)),
+                .defaultValue = std::move(defaultValue),
+                .range = {.min = -1e6, .max = 1e6}
+            });
+        }
+        registry.registerValues(declarations);
+
+        // alternating between two configs, so that every load changes every value
+        std::string keyValueConfigs[2] = {detail::MakeKeyValueConfig(0), detail::MakeKeyValueConfig(1)};
+        std::string jsonConfigs[2] = {detail::MakeJsonConfig(0), detail::MakeJsonConfig(1)};
+        int variant = 0;
+        ConfigLoadResult result;
+
+        double seconds = MeasureFastest(NumRuns, [&] {
+            variant ^= 1;
+            result = LoadConfig(registry, keyValueConfigs[variant]);
+            registry.reclaim();
+        });
+        detail::PrintConfigLoadResult("key = value", keyValueConfigs[0].size(), seconds, result);
+
+        seconds = MeasureFastest(NumRuns, [&] {
+            variant ^= 1;
+            result = LoadConfig(registry, jsonConfigs[variant]);
+            registry.reclaim();
+        });
+        detail::PrintConfigLoadResult("JSON", jsonConfigs[0].size(), seconds, result);
+
+        std::filesystem::path paths[2];
+        for (int i = 0; i < 2; i++) {
+            paths[i] = std::filesystem::temp_directory_path() / std::format("lpg_engine_bench_config{}.ini", i);
+            std::ofstream(paths[i], std::ios::binary) << keyValueConfigs[i];
+        }
+        seconds = MeasureFastest(NumRuns, [&] {
+            variant ^= 1;
+            result = LoadConfigFile(registry, paths[variant].string());
+            registry.reclaim();
+        });
+        detail::PrintConfigLoadResult("key = value file", keyValueConfigs[0].size(), seconds, result);
+        for (const auto& path: paths) {
+            std::filesystem::remove(path);
+        }
+    }
+
+} // lpg::bench
@@ -0,0 +1,110 @@
+//
+// Created by volt on 2026-10-19.
+//
+
+
+
+
+#include "Benchmark.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <lpg/core/World.hpp>
+#include <lpg/core/entity_codegen.hpp>
+
+namespace lpg::bench {
+
+    // the Quantize attributes only apply to the packed form
+    struct SerializedNpc {
+        al::Vec3f position;
+        LPG_ATTR(Quantize<FixedPoint<int16_t>>{}, MinValue{-3.15}, MaxValue{3.15})
+        al::Vec3f rotation;
+        al::Vec3f scale {1.0f, 1.0f, 1.0f};
+        int32_t hp;
+        LPG_ATTR(Quantize<Half>{})
+        float speed;
+        bool hostile;
+    };
+
+    LPG_REGISTER_ENTITY_TYPE(SerializedNpc);
+
+    void RunSerializationBenchmark() {
+        constexpr int NumEntities = 100'000;
+        constexpr int NumRuns = 10;
+
+        World world;
+        world.setNumWorkerThreads(0);
+        world.finalizeInit();
+
+        std::mt19937 rng(1);
+        std::uniform_real_distribution<float> coordinate(-1000.0f, 1000.0f);
+        std::uniform_real_distribution<float> angle(-3.14159f, 3.14159f);
+        for (int i = 0; i < NumEntities; i++) {
+            world.spawnEntity<SerializedNpc>(SerializedNpc {
+                .position = {coordinate(rng), coordinate(rng), coordinate(rng)},
+                .rotation = {angle(rng), angle(rng), angle(rng)},
+                .hp = static_cast<int32_t>(rng() % 1000),
+                .speed = angle(rng) + 4.0f,
+                .hostile = rng() % 2 == 0
+            });
+        }
+
+        // whole pages, into a buffer that is reused like the World::entitiesToJSON doc recommends
+        std::string json;
+        double writeSeconds = MeasureFastest(NumRuns, [&] {
+            json.clear();
+            world.entitiesToJSON<SerializedNpc>(json);
+        });
+        double megabytes = static_cast<double>(json.size()) / 1e6;
+        std::printf("serialization: write %d entities (%.2f MB) in %.3f ms, %.0f MB/s\n",
+                    NumEntities, megabytes, writeSeconds * 1e3, megabytes / writeSeconds);
+
+        // the array written above, into a fresh World each run so that every run spawns into new pages
+        double readSeconds = std::numeric_limits<double>::infinity();
+        int numRead = 0;
+        for (int run = 0; run <= NumRuns; run++) {
+            World readWorld;
+            readWorld.setNumWorkerThreads(0);
+            readWorld.finalizeInit();
+            auto start = std::chrono::steady_clock::now();
+            numRead = readWorld.entitiesFromJSON<SerializedNpc>(json);
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            if (run > 0) {
+                readSeconds = std::min(readSeconds, elapsed.count());
+            }
+        }
+        std::printf("serialization: read %d entities (%.2f MB) in %.3f ms, %.0f MB/s%s\n",
+                    numRead, megabytes, readSeconds * 1e3, megabytes / readSeconds, numRead == NumEntities ? "" : " (COUNT MISMATCH)");
+
+        std::vector<std::byte> packed;
+        writeSeconds = MeasureFastest(NumRuns, [&] {
+            packed.clear();
+            world.entitiesToPacked<SerializedNpc>(packed);
+        });
+        megabytes = static_cast<double>(packed.size()) / 1e6;
+        std::printf("serialization: write packed %d entities (%.2f MB, %zu of %zu bytes each) in %.3f ms, %.0f MB/s\n",
+                    NumEntities, megabytes, packed.size() / NumEntities, sizeof(SerializedNpc), writeSeconds * 1e3, megabytes / writeSeconds);
+
+        readSeconds = std::numeric_limits<double>::infinity();
+        for (int run = 0; run <= NumRuns; run++) {
+            World readWorld;
+            readWorld.setNumWorkerThreads(0);
+            readWorld.finalizeInit();
+            auto start = std::chrono::steady_clock::now();
+            numRead = readWorld.entitiesFromPacked<SerializedNpc>(packed);
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            if (run > 0) {
+                readSeconds = std::min(readSeconds, elapsed.count());
+            }
+        }
+        std::printf("serialization: read packed %d entities (%.2f MB) in %.3f ms, %.0f MB/s%s\n",
+                    numRead, megabytes, readSeconds * 1e3, megabytes / readSeconds, numRead == NumEntities ? "" : " (COUNT MISMATCH)");
+    }
+
+} // lpg::bench
@@ -0,0 +1,162 @@
+//
+// Created by volt on 2026-10-19.
+//
+
+
+
+
+#include "Benchmark.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <numbers>
+#include <random>
+#include <vector>
+
+#include <lpg/core/entity_codegen.hpp>
+#include <lpg/math/TransformKernels.hpp>
+
+namespace lpg::bench {
+
+    struct TransformedEntity {
+        al::Vec3f position;
+        al::Vec3f rotation;
+        al::Vec3f scale {1.0f, 1.0f, 1.0f};
+    };
+
+    namespace detail {
+        /*
+         * vec3 0..4: translations, angles, scales, points, transformed points; mat4 0..2: TRS, inverse, product.
+         * The arrays are a cache line more than count apart: the kernels stream up to 48 of them at once,
+         * and at a power-of-two distance they would all compete for the same L1 sets.
+         */
+        struct TransformBatch {
+            static constexpr int NumVec3 = 5;
+            static constexpr int NumMat4 = 3;
+
+            size_t stride;
+            std::vector<float> storage;
+
+            explicit TransformBatch(size_t count): stride(count + 16), storage(stride * (NumVec3 * 3 + NumMat4 * 16)) {}
+
+            [[nodiscard]] math::Vec3fArrays vec3(int index) {
+                float* first = &storage[index * 3 * stride];
+                return {first, first + stride, first + 2 * stride};
+            }
+
+            [[nodiscard]] math::Mat4Arrays mat4(int index) {
+                math::Mat4Arrays result;
+                for (int k = 0; k < 16; k++) {
+                    result.m[k] = &storage[(NumVec3 * 3 + index * 16 + k) * stride];
+                }
+                return result;
+            }
+        };
+
+        static void PrintTransformTiming(const char* what, size_t count, double seconds, double baselineSeconds = 0.0) {
+            std::printf("transform: %s, %.2f ns/element", what, seconds * 1e9 / static_cast<double>(count));
+            if (baselineSeconds > 0.0) {
+                std::printf(", %.1fx the one-at-a-time al::Transform path", baselineSeconds / seconds);
+            }
+            std::printf("\n");
+        }
+    }
+
+    void RunTransformBenchmark() {
+        constexpr size_t Count = 16384;
+        constexpr int NumRuns = 50;
+
+        auto validation = math::ValidateTransformKernels();
+        std::printf("transform: kernels %s validation against al::Transform\n", validation.passed() ? "pass" : "FAIL");
+
+        detail::TransformBatch batch(Count);
+        std::mt19937 rng(1);
+        std::uniform_real_distribution<float> angle(-std::numbers::pi_v<float>, std::numbers::pi_v<float>);
+        std::uniform_real_distribution<float> scale(0.5f, 2.0f);
+        std::uniform_real_distribution<float> coordinate(-100.0f, 100.0f);
+        auto translations = batch.vec3(0), angles = batch.vec3(1), scales = batch.vec3(2), points = batch.vec3(3);
+        for (size_t i = 0; i < Count; i++) {
+            translations.x[i] = coordinate(rng), translations.y[i] = coordinate(rng), translations.z[i] = coordinate(rng);
+            angles.x[i] = angle(rng), angles.y[i] = angle(rng), angles.z[i] = angle(rng);
+            scales.x[i] = scale(rng), scales.y[i] = scale(rng), scales.z[i] = scale(rng);
+            points.x[i] = coordinate(rng), points.y[i] = coordinate(rng), points.z[i] = coordinate(rng);
+        }
+
+        // what EntApplyTransform does per entity
+        std::vector<al::Transform> transforms(Count);
+        double baselineComposeSeconds = MeasureFastest(NumRuns, [&] {
+            for (size_t i = 0; i < Count; i++) {
+                auto& transform = transforms[i];
+                for (int k = 0; k < 16; k++) {
+                    transform.m[k / 4][k % 4] = k % 5 == 0 ? 1.0f : 0.0f;
+                }
+                transform.rotate({angles.x[i], angles.y[i], angles.z[i]})
+                         .scale({scales.x[i], scales.y[i], scales.z[i]})
+                         .translate({translations.x[i], translations.y[i], translations.z[i]});
+            }
+        });
+        detail::PrintTransformTiming("al::Transform rotate, scale, translate", Count, baselineComposeSeconds);
+
+        double seconds = MeasureFastest(NumRuns, [&] {
+            math::ComposeTRS(batch.vec3(0), batch.vec3(1), batch.vec3(2), batch.mat4(0), Count);
+        });
+        detail::PrintTransformTiming("ComposeTRS", Count, seconds, baselineComposeSeconds);
+
+        seconds = MeasureFastest(NumRuns, [&] {
+            math::InverseAffine(batch.mat4(0), batch.mat4(1), Count);
+        });
+        detail::PrintTransformTiming("InverseAffine", Count, seconds);
+
+        seconds = MeasureFastest(NumRuns, [&] {
+            math::Compose(batch.mat4(0), batch.mat4(1), batch.mat4(2), Count);
+        });
+        detail::PrintTransformTiming("Compose", Count, seconds);
+
+        // onto the transforms above, as when composing parents with children
+        std::vector<TransformedEntity> entities(Count);
+        for (size_t i = 0; i < Count; i++) {
+            entities[i] = {
+                .position = {translations.x[i], translations.y[i], translations.z[i]},
+                .rotation = {angles.x[i], angles.y[i], angles.z[i]},
+                .scale = {scales.x[i], scales.y[i], scales.z[i]}
+            };
+        }
+        const auto& entityInterface = GetEntityInterface<TransformedEntity>();
+        std::vector<al::Transform> accumulated(Count);
+        double baselineAccumulateSeconds = MeasureFastest(NumRuns, [&] {
+            std::ranges::copy(transforms, accumulated.begin());
+            for (size_t i = 0; i < Count; i++) {
+                entityInterface.accumulateTransform(&entities[i], accumulated[i]);
+            }
+        });
+        detail::PrintTransformTiming("accumulateTransform, one entity at a time", Count, baselineAccumulateSeconds);
+
+        seconds = MeasureFastest(NumRuns, [&] {
+            std::ranges::copy(transforms, accumulated.begin());
+            entityInterface.accumulateTransformsContiguous(entities.data(), Count, accumulated.data());
+        });
+        detail::PrintTransformTiming("accumulateTransformsContiguous", Count, seconds, baselineAccumulateSeconds);
+
+        std::vector<al::Vec3f> transformedPoints(Count);
+        // one transform for every point, e.g. a mesh's vertices
+        const auto& shared = transforms.front();
+        double baselinePointsSeconds = MeasureFastest(NumRuns, [&] {
+            const auto& m = shared.m;
+            for (size_t i = 0; i < Count; i++) {
+                float x = points.x[i], y = points.y[i], z = points.z[i];
+                transformedPoints[i] = {
+                    m[0][0] * x + m[1][0] * y + m[2][0] * z + m[3][0],
+                    m[0][1] * x + m[1][1] * y + m[2][1] * z + m[3][1],
+                    m[0][2] * x + m[1][2] * y + m[2][2] * z + m[3][2]
+                };
+            }
+        });
+        detail::PrintTransformTiming("al::Transform points, one shared transform", Count, baselinePointsSeconds);
+
+        seconds = MeasureFastest(NumRuns, [&] {
+            math::TransformPoints(shared, batch.vec3(3), batch.vec3(4), Count);
+        });
+        detail::PrintTransformTiming("TransformPoints, one shared transform", Count, seconds, baselinePointsSeconds);
+    }
+
+} // lpg::bench
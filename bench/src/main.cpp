@@ -0,0 +1,50 @@
+//
+// Created by volt on 2026-10-19.
+//
+
+
+
+
+#include "Benchmark.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <string_view>
+
+namespace {
+    struct Benchmark {
+        std::string_view name;
+        void (*run)();
+    };
+
+    constexpr Benchmark Benchmarks[] = {
+        {"serialization", &lpg::bench::RunSerializationBenchmark},
+        {"config", &lpg::bench::RunConfigBenchmark},
+        {"transform", &lpg::bench::RunTransformBenchmark},
+        {"collision", &lpg::bench::RunCollisionBenchmark},
+    };
+}
+
+/*
+ * lpg_engine_bench [name...] runs the named benchmarks, or all of them. Build with optimizations.
+ */
+int main(int argc, char** argv) {
+    if (argc <= 1) {
+        for (const auto& benchmark: Benchmarks) {
+            benchmark.run();
+        }
+        return 0;
+    }
+
+    int result = 0;
+    for (int i = 1; i < argc; i++) {
+        auto it = std::ranges::find(Benchmarks, std::string_view(argv[i]), &Benchmark::name);
+        if (it == std::ranges::end(Benchmarks)) {
+            std::fprintf(stderr, "unknown benchmark: %s\n", argv[i]);
+            result = 1;
+            continue;
+        }
+        it->run();
+    }
+    return result;
+}
@@ -9,61 +9,10 @@
 
 #include <iostream>
 
-using namespace al::ColorLiterals;
-
-
-class PerlinNoiseGenerator
-{
-public:
-	PerlinNoiseGenerator(uint32_t seed = 0x12345678): seed(seed) {}
-
-	float operator()(al::Vec2f pos, int octaves = 1)
-	{
-		octaves = std::max(1, octaves);
-		float sum = 0, max = 0;
-		for(int i=0; i<octaves; i++) {
-			double coeff = 1.0 / (1 << i);
-			max += coeff;
-			sum += baseOctave(pos * (1<<i)) * coeff;
-		}
-		return sum / max;
-	}
-
-	float baseOctave(al::Vec2f pos)
-	{
-		// https://en.wikipedia.org/wiki/Perlin_noise
-		al::Vec2f floorPos(std::floor(pos.x), std::floor(pos.y));
-		auto interp = pos - floorPos;
-
-		float n[4];
-		for(int i=0; i<4; i++) {
-			al::Vec2f ipos = floorPos + al::Vec2f(!!(i&1), !!(i&2));
-			n[i] = randomGradient(ipos).dot(pos-ipos);
-		}
-
-		float ix0 = interpolate(n[0], n[1], interp.x);
-		float ix1 = interpolate(n[2], n[3], interp.x);
-		
-		return std::clamp(interpolate(ix0, ix1, interp.y), -1.0f, 1.0f) * 0.5 + 0.5;
-	}
-private:
-	uint32_t seed = 0x12345678;
+#include <lpg/entities/PerlinNoiseTerrain.hpp>
+#include <lpg/util/HeightGrid.hpp>
 
-	static float interpolate(float a, float b, float weight) 
-	{
-		weight = std::clamp(weight, 0.0f, 1.0f);
-		return (b - a) * (3.0 - weight * 2.0) * weight * weight + a;
-	}
-
-	al::Vec2f randomGradient(al::Vec2<int> pos)
-	{
-		uint32_t a = pos.x * 89733 + pos.y * 2879327 + 0xB16B00B5;
-		a = a<<13 | a>>19;
-		a ^= seed;
-		a *= 0xD398A93F;
-		return al::Vec2f(std::cos(a), std::sin(a));
-	}
-};
+using namespace al::ColorLiterals;
 
 
 struct Mesh 
@@ -172,24 +121,21 @@ struct Skybox {
 
 
 
-Mesh CreateTerrain(int sx, int sy, float height)
+void UpdateTerrainMesh(Mesh& mesh, const lpg::HeightGrid& grid, lpg::HeightGridRegion region)
 {
-	Mesh result;
-	PerlinNoiseGenerator perlin;
-	for(int y=0; y<sy; y++) {
-		for(int x=0; x<sx; x++) {
-			al::Vec2f pos(x, y);
-			float vh = height*perlin(pos*0.01, 8);
-			al::Vertex vtx({pos.x, pos.y, vh}, pos*15.0, al::Gray(vh/height));
-			result.vertices.push_back(vtx);
-			if(x < sx-1 && y < sy-1) {
-				for(auto offset: {0, 1, sx, 1, sx+1, sx}) {
-					result.indices.push_back(y*sx+x+offset);
-				}
-			}
-		}
-	}
+	// the normals around edited samples change too
+	region = region.grown(1, grid.getWidth(), grid.getDepth());
+	grid.forEachVertex(region, [&](int x, int y, al::Vec3f pos, al::Vec3f) {
+		mesh.vertices[y*grid.getWidth()+x] = al::Vertex(pos, al::Vec2f(x, y)*15.0, al::Gray(pos.z/grid.getMaxHeight()));
+	});
+}
 
+Mesh CreateTerrain(const lpg::HeightGrid& grid)
+{
+	Mesh result;
+	result.vertices.resize(grid.getWidth()*grid.getDepth());
+	UpdateTerrainMesh(result, grid, grid.getBounds());
+	result.indices = grid.buildTriangleIndices();
 	return result;
 }
 
@@ -206,7 +152,9 @@ int main()
 	});
 	display.setTitle("LPG Engine Demo");
 
-	Mesh terrain = CreateTerrain(128, 128, 96);
+	lpg::PerlinNoiseTerrain terrainParams {.seed = 0x12345678};
+	auto terrainGrid = lpg::CreateHeightGrid(terrainParams);
+	Mesh terrain = CreateTerrain(*terrainGrid);
 	al::VertexBuffer terrainVB(terrain.vertices);
 	al::IndexBuffer terrainIB(terrain.indices);
 
@@ -0,0 +1,245 @@
+//
+// Created by volt on 2026-10-19.
+//
+
+
+
+
+#include "Behaviour.hpp"
+
+#include "../util/PoolAllocator.hpp"
+
+#include <algorithm>
+
+namespace lpg {
+
+    namespace detail {
+        struct BehaviourFramePool {
+            std::mutex mutex;
+            PoolAllocator allocator;
+        };
+
+        /*
+         * Never destroyed: global::TheWorld is constructed before the first behaviour frame is allocated,
+         * so a function-local static would be destroyed first, and ~BehaviourScheduler would free into it.
+         */
+        static BehaviourFramePool& GetBehaviourFramePool() {
+            static auto* pool = new BehaviourFramePool;
+            return *pool;
+        }
+
+        void* AllocateBehaviourFrame(size_t size) {
+            auto& pool = GetBehaviourFramePool();
+            std::lock_guard lock(pool.mutex);
+            return pool.allocator.allocate(size);
+        }
+
+        void DeallocateBehaviourFrame(void* ptr, size_t size) {
+            auto& pool = GetBehaviourFramePool();
+            std::lock_guard lock(pool.mutex);
+            pool.allocator.deallocate(ptr, size);
+        }
+    }
+
+    BehaviourScheduler::~BehaviourScheduler() {
+        for (auto& [owner, handles]: behavioursByOwner_) {
+            for (auto handle: handles) {
+                handle.destroy();
+            }
+        }
+        for (auto& pending: pendingStarts_) {
+            pending.handle.destroy();
+        }
+    }
+
+    void BehaviourScheduler::start(EntityDescriptor owner, Behaviour behaviour) {
+        auto handle = behaviour.release();
+        if (not handle) {
+            return;
+        }
+        handle.promise().scheduler = this;
+        handle.promise().owner = owner;
+
+        std::lock_guard lock(mutex_);
+        pendingStarts_.push_back({.owner = owner, .handle = handle});
+    }
+
+    void BehaviourScheduler::tick(uint64_t tick) {
+        currentTick_ = tick;
+
+        // collected first, so that behaviours started or woken below do not run twice on this tick
+        std::vector<Behaviour::Handle> dueNow;
+        dueNow.swap(nextTickQueue_);
+        while (not timers_.empty() && timers_.top().wakeTick <= tick) {
+            dueNow.push_back(timers_.top().handle);
+            timers_.pop();
+        }
+
+        runPending();
+        for (auto handle: dueNow) {
+            resume(handle);
+        }
+    }
+
+    /*
+     * Runs the queued starts and message wakeups, including those queued by the behaviours it runs.
+     */
+    void BehaviourScheduler::runPending() {
+        while (true) {
+            std::vector<PendingStart> starts;
+            std::vector<PendingResume> resumes;
+            {
+                std::lock_guard lock(mutex_);
+                starts.swap(pendingStarts_);
+                resumes.swap(pendingResumes_);
+            }
+            if (starts.empty() && resumes.empty()) {
+                return;
+            }
+
+            // owned before any of them runs, so that none leaks if one throws
+            for (const auto& pending: starts) {
+                behavioursByOwner_[pending.owner].push_back(pending.handle);
+            }
+            for (const auto& pending: starts) {
+                resume(pending.handle);
+            }
+            for (auto& pending: resumes) {
+                pending.handle.promise().receivedMessage = std::move(pending.message);
+                resume(pending.handle);
+            }
+        }
+    }
+
+    void BehaviourScheduler::cancelAll(EntityDescriptor owner) {
+        std::vector<Behaviour::Handle> notStarted;
+        std::vector<Behaviour::Handle> waiting;
+        {
+            std::lock_guard lock(mutex_);
+            std::erase_if(pendingStarts_, [&](const PendingStart& pending) {
+                if (pending.owner == owner) {
+                    notStarted.push_back(pending.handle);
+                    return true;
+                }
+                return false;
+            });
+
+            auto it = behavioursByOwner_.find(owner);
+            if (it != behavioursByOwner_.end()) {
+                for (auto handle: it->second) {
+                    handle.promise().cancelled = true;
+                }
+                for (auto& [messageTypeId, waiters]: messageWaiters_) {
+                    std::erase_if(waiters, [&](Behaviour::Handle handle) {
+                        if (handle.promise().cancelled) {
+                            waiting.push_back(handle);
+                            return true;
+                        }
+                        return false;
+                    });
+                }
+            }
+        }
+
+        for (auto handle: notStarted) {
+            handle.destroy();
+        }
+        for (auto handle: waiting) {
+            finish(handle);
+        }
+    }
+
+    void BehaviourScheduler::deliverMessage(int messageTypeId, const void* message, detail::CopyMessageFn copyMessage, EntityDescriptor target) {
+        deliverMessageToMany(messageTypeId, message, copyMessage, [target](EntityDescriptor owner) {
+            return owner == target;
+        });
+    }
+
+    void BehaviourScheduler::deliverMessageToMany(int messageTypeId, const void* message, detail::CopyMessageFn copyMessage, const std::function<bool(EntityDescriptor)>& filter) {
+        std::lock_guard lock(mutex_);
+        auto it = messageWaiters_.find(messageTypeId);
+        if (it == messageWaiters_.end()) {
+            return;
+        }
+
+        std::shared_ptr<const void> messageCopy;
+        std::erase_if(it->second, [&](Behaviour::Handle handle) {
+            if (filter(handle.promise().owner)) {
+                if (not messageCopy) {
+                    messageCopy = copyMessage(message);
+                }
+                pendingResumes_.push_back({.handle = handle, .message = messageCopy});
+                return true;
+            }
+            return false;
+        });
+    }
+
+    uint64_t BehaviourScheduler::getCurrentTick() const {
+        return currentTick_;
+    }
+
+    size_t BehaviourScheduler::getNumBehaviours() const {
+        size_t result = 0;
+        for (const auto& [owner, handles]: behavioursByOwner_) {
+            result += handles.size();
+        }
+        std::lock_guard lock(mutex_);
+        return result + pendingStarts_.size();
+    }
+
+    void BehaviourScheduler::scheduleNextTick(Behaviour::Handle handle) {
+        nextTickQueue_.push_back(handle);
+    }
+
+    void BehaviourScheduler::scheduleAt(uint64_t tick, Behaviour::Handle handle) {
+        timers_.push(Timer {
+            .wakeTick = tick,
+            .sequence = timerSequence_++,
+            .handle = handle
+        });
+    }
+
+    void BehaviourScheduler::scheduleOnMessage(int messageTypeId, Behaviour::Handle handle) {
+        if (handle.promise().cancelled) {
+            // cancelled while running (e.g. it despawned its own entity); reclaimed on the next tick
+            nextTickQueue_.push_back(handle);
+            return;
+        }
+        std::lock_guard lock(mutex_);
+        messageWaiters_[messageTypeId].push_back(handle);
+    }
+
+    void BehaviourScheduler::resume(Behaviour::Handle handle) {
+        if (handle.promise().cancelled) {
+            finish(handle);
+            return;
+        }
+        handle.resume();
+        if (handle.done()) {
+            finish(handle);
+        }
+    }
+
+    /*
+     * Destroys the frame and rethrows whatever escaped the coroutine body, unless it was cancelled.
+     */
+    void BehaviourScheduler::finish(Behaviour::Handle handle) {
+        auto& promise = handle.promise();
+        auto exception = promise.cancelled ? nullptr : promise.exception;
+
+        auto it = behavioursByOwner_.find(promise.owner);
+        if (it != behavioursByOwner_.end()) {
+            std::erase(it->second, handle);
+            if (it->second.empty()) {
+                behavioursByOwner_.erase(it);
+            }
+        }
+        handle.destroy();
+
+        if (exception) {
+            std::rethrow_exception(exception);
+        }
+    }
+
+} // lpg
@@ -0,0 +1,282 @@
+//
+// Created by volt on 2026-10-19.
+//
+
+
+
+
+#ifndef LPG_ENGINE_SRC_LPG_CORE_BEHAVIOUR_HPP_
+#define LPG_ENGINE_SRC_LPG_CORE_BEHAVIOUR_HPP_
+
+#include <algorithm>
+#include <cmath>
+#include <coroutine>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "SysCounter.hpp"
+#include "entity.hpp"
+
+namespace lpg {
+
+    class BehaviourScheduler;
+
+    namespace detail {
+        /*
+         * Frames come from one PoolAllocator behind a mutex: coroutines may be created on any thread.
+         */
+        void* AllocateBehaviourFrame(size_t size);
+        void DeallocateBehaviourFrame(void* ptr, size_t size);
+
+        using CopyMessageFn = std::shared_ptr<const void> (*)(const void* message);
+
+        template<typename TMessage>
+        std::shared_ptr<const void> CopyMessage(const void* message) {
+            return std::make_shared<TMessage>(*static_cast<const TMessage*>(message));
+        }
+    }
+
+    /*
+     * A coroutine attached to an entity and resumed on the engine tick:
+     *
+     * Behaviour Patrol(World& world, EntityDescriptor self) {
+     *     while (true) {
+     *         co_await co::wait(2.0);
+     *         auto hit = co_await co::waitMessage<DamageMessage>();
+     *         ...
+     *     }
+     * }
+     *
+     * world.startBehaviour(npc, Patrol(world, npc));
+     *
+     * A suspended behaviour costs nothing per tick. Frames are allocated from a pool.
+     * Behaviours are started, resumed and destroyed on the thread that ticks the World, at the tick barrier,
+     * even when started or sent a message from a system running on a worker thread.
+     */
+    class Behaviour {
+    public:
+        struct promise_type {
+            BehaviourScheduler* scheduler = nullptr;
+            EntityDescriptor owner = 0;
+            bool cancelled = false;
+            std::shared_ptr<const void> receivedMessage;
+            std::exception_ptr exception;
+
+            Behaviour get_return_object() {
+                return Behaviour {std::coroutine_handle<promise_type>::from_promise(*this)};
+            }
+            std::suspend_always initial_suspend() noexcept {return {};}
+            std::suspend_always final_suspend() noexcept {return {};}
+            void return_void() noexcept {}
+            void unhandled_exception() {
+                exception = std::current_exception();
+            }
+
+            static void* operator new(size_t size) {
+                return detail::AllocateBehaviourFrame(size);
+            }
+            static void operator delete(void* ptr, size_t size) {
+                detail::DeallocateBehaviourFrame(ptr, size);
+            }
+        };
+
+        using Handle = std::coroutine_handle<promise_type>;
+
+        Behaviour() = default;
+        explicit Behaviour(Handle handle) : handle_(handle) {}
+
+        Behaviour(Behaviour&& other) noexcept : handle_(std::exchange(other.handle_, {})) {}
+        Behaviour& operator=(Behaviour&& other) noexcept {
+            if (this != &other) {
+                if (handle_) {
+                    handle_.destroy();
+                }
+                handle_ = std::exchange(other.handle_, {});
+            }
+            return *this;
+        }
+
+        ~Behaviour() {
+            if (handle_) {
+                handle_.destroy();
+            }
+        }
+
+        Handle release() {
+            return std::exchange(handle_, {});
+        }
+
+    private:
+        Handle handle_;
+    };
+
+    /*
+     * Owns all running behaviours. tick() resumes only the behaviours whose wait has elapsed.
+     * start() and message deliveries may be called from any thread: they are queued, with a copy of the message,
+     * and run by the next tick().
+     */
+    class BehaviourScheduler {
+    public:
+        BehaviourScheduler() = default;
+        BehaviourScheduler(const BehaviourScheduler&) = delete;
+        BehaviourScheduler& operator=(const BehaviourScheduler&) = delete;
+        ~BehaviourScheduler();
+
+        /*
+         * The behaviour runs until its first suspension point on the next tick.
+         */
+        void start(EntityDescriptor owner, Behaviour behaviour);
+
+        void tick(uint64_t tick);
+
+        /*
+         * Destroys all behaviours of the entity. Behaviours that are currently suspended are
+         * destroyed no later than when they would otherwise have been resumed.
+         */
+        void cancelAll(EntityDescriptor owner);
+
+        /*
+         * Wakes the behaviours waiting for the message type, if filter accepts their owner.
+         * copyMessage is called once, and only if there is a receiver.
+         */
+        void deliverMessage(int messageTypeId, const void* message, detail::CopyMessageFn copyMessage, EntityDescriptor target);
+        void deliverMessageToMany(int messageTypeId, const void* message, detail::CopyMessageFn copyMessage, const std::function<bool(EntityDescriptor)>& filter);
+
+        [[nodiscard]] uint64_t getCurrentTick() const;
+        [[nodiscard]] size_t getNumBehaviours() const;
+
+        void scheduleNextTick(Behaviour::Handle handle);
+        void scheduleAt(uint64_t tick, Behaviour::Handle handle);
+        void scheduleOnMessage(int messageTypeId, Behaviour::Handle handle);
+
+    private:
+        struct Timer {
+            uint64_t wakeTick;
+            uint64_t sequence;
+            Behaviour::Handle handle;
+
+            bool operator>(const Timer& other) const {
+                return std::pair{wakeTick, sequence} > std::pair{other.wakeTick, other.sequence};
+            }
+        };
+
+        struct PendingStart {
+            EntityDescriptor owner;
+            Behaviour::Handle handle;
+        };
+
+        struct PendingResume {
+            Behaviour::Handle handle;
+            std::shared_ptr<const void> message;
+        };
+
+        void runPending();
+        void resume(Behaviour::Handle handle);
+        void finish(Behaviour::Handle handle);
+
+        uint64_t currentTick_ = 0;
+        uint64_t timerSequence_ = 0;
+
+        std::vector<Behaviour::Handle> nextTickQueue_;
+        std::priority_queue<Timer, std::vector<Timer>, std::greater<>> timers_;
+        std::unordered_map<EntityDescriptor, std::vector<Behaviour::Handle>> behavioursByOwner_;
+
+        // guards the members below, which are touched by threads other than the one that ticks
+        mutable std::mutex mutex_;
+        std::unordered_map<int, std::vector<Behaviour::Handle>> messageWaiters_;
+        std::vector<PendingStart> pendingStarts_;
+        std::vector<PendingResume> pendingResumes_;
+    };
+
+    namespace co {
+
+        struct NextTickAwaiter {
+            bool await_ready() const noexcept {return false;}
+            void await_suspend(Behaviour::Handle handle) const {
+                handle.promise().scheduler->scheduleNextTick(handle);
+            }
+            void await_resume() const noexcept {}
+        };
+
+        struct WaitTicksAwaiter {
+            uint64_t numTicks;
+
+            bool await_ready() const noexcept {return false;}
+            void await_suspend(Behaviour::Handle handle) const {
+                auto* scheduler = handle.promise().scheduler;
+                scheduler->scheduleAt(scheduler->getCurrentTick() + numTicks, handle);
+            }
+            void await_resume() const noexcept {}
+        };
+
+        struct WaitForAwaiter {
+            SysFreq freq;
+
+            bool await_ready() const noexcept {return false;}
+            void await_suspend(Behaviour::Handle handle) const {
+                auto* scheduler = handle.promise().scheduler;
+                uint64_t division = GetSysFreqDivision(freq);
+                uint64_t wakeTick = (scheduler->getCurrentTick() / division + 1) * division;
+                scheduler->scheduleAt(wakeTick, handle);
+            }
+            void await_resume() const noexcept {}
+        };
+
+        template<typename TMessage>
+        struct WaitMessageAwaiter {
+            Behaviour::Handle handle {};
+
+            bool await_ready() const noexcept {return false;}
+            void await_suspend(Behaviour::Handle suspended) {
+                handle = suspended;
+                handle.promise().scheduler->scheduleOnMessage(detail::GetMessageTypeId<TMessage>(), handle);
+            }
+            TMessage await_resume() const {
+                auto message = std::move(handle.promise().receivedMessage);
+                return *static_cast<const TMessage*>(message.get());
+            }
+        };
+
+        /*
+         * Resumes on the next master tick.
+         */
+        inline NextTickAwaiter nextTick() {
+            return {};
+        }
+
+        /*
+         * Resumes after the given time has passed on the master clock (at least one tick).
+         */
+        inline WaitTicksAwaiter wait(double seconds) {
+            auto numTicks = static_cast<uint64_t>(std::ceil(seconds * MasterSystemFrequency));
+            return {.numTicks = std::max<uint64_t>(1, numTicks)};
+        }
+
+        /*
+         * Resumes on the next tick on which the counter of freq wraps around.
+         */
+        inline WaitForAwaiter waitFor(SysFreq freq) {
+            return {.freq = freq};
+        }
+
+        /*
+         * Resumes on the tick barrier after a message of the given type is sent to the behaviour's entity,
+         * and returns a copy of it.
+         */
+        template<typename TMessage>
+        WaitMessageAwaiter<TMessage> waitMessage() {
+            return {};
+        }
+
+    }
+
+} // lpg
+
+#endif //LPG_ENGINE_SRC_LPG_CORE_BEHAVIOUR_HPP_
@@ -0,0 +1,281 @@
+//
+// Created by volt on 2026-10-19.
+//
+
+
+
+
+#include "ConfigLoader.hpp"
+
+#include "Registry.hpp"
+#include "json.hpp"
+
+#include <algorithm>
+#include <format>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+
+#ifdef _WIN32
+#include <fstream>
+#include <iterator>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace lpg {
+
+    namespace detail {
+
+        struct ConfigParseState {
+            const RegistrySnapshot& snapshot;
+            std::vector<std::pair<RegistryKeyId, DataUnit>> values;
+            std::vector<std::string> errors;
+            std::string prefix; // of the current section or object, with a trailing dot
+            RegistryKeyId previousId = -1;
+        };
+
+        static std::string_view TrimWhitespace(std::string_view str) {
+            auto isSpace = [](char c) {
+                return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+            };
+            while (not str.empty() && isSpace(str.front())) {
+                str.remove_prefix(1);
+            }
+            while (not str.empty() && isSpace(str.back())) {
+                str.remove_suffix(1);
+            }
+            return str;
+        }
+
+        /*
+         * Config files usually list keys in the order they were registered, e.g. as written by Registry::dump
+         * or as declared in a struct registered by reference, so the key after the previous one is tried first.
+         */
+        static RegistryKeyId FindKey(ConfigParseState& state, const RegistryKeyPrefix& prefix, std::string_view key) {
+            RegistryKeyId id = state.previousId + 1;
+            if (id < state.snapshot.numValues) {
+                std::string_view name = state.snapshot.keys->names[id];
+                if (name.size() == state.prefix.size() + key.size() && name.starts_with(state.prefix) && name.ends_with(key)) {
+                    state.previousId = id;
+                    return id;
+                }
+            }
+            id = state.snapshot.getKeyId(prefix, key);
+            if (id >= 0) {
+                state.previousId = id;
+            }
+            return id;
+        }
+
+        /*
+         * Parses the value into the back of state.values, where it stays if it is valid and in range.
+         * location is only called to describe an error.
+         */
+        static bool StageValue(ConfigParseState& state, RegistryKeyId id, const auto& parse, const auto& location) {
+            // a default-constructed value of the key's type, without copying e.g. a string only to overwrite it
+            auto& value = std::visit([&]<typename T>(const T&) -> DataUnit& {
+                return state.values.emplace_back(std::piecewise_construct, std::tuple(id), std::tuple(std::in_place_type<T>)).second;
+            }, state.snapshot.value(id));
+            if (not parse(value)) {
+                state.values.pop_back();
+                return false;
+            }
+            if (not state.snapshot.keys->ranges[id].contains(value)) {
+                state.errors.push_back(std::format("{}: value out of range for {}: {}", location(), state.snapshot.keys->names[id], DataUnitToStr(value)));
+                state.values.pop_back();
+            }
+            return true;
+        }
+
+        static void ParseKeyValueConfig(ConfigParseState& state, std::string_view text) {
+            RegistryKeyPrefix section = state.snapshot.getKeyPrefix();
+            int lineNumber = 0;
+            while (not text.empty()) {
+                size_t lineEnd = text.find('\n');
+                std::string_view line = TrimWhitespace(text.substr(0, lineEnd));
+                text.remove_prefix(lineEnd == std::string_view::npos ? text.size() : lineEnd + 1);
+                lineNumber++;
+
+                if (line.empty() || line.front() == '#' || line.front() == ';') {
+                    continue;
+                }
+
+                auto location = [&] {
+                    return std::format("line {}", lineNumber);
+                };
+                if (line.front() == '[') {
+                    if (line.back() != ']') {
+                        state.errors.push_back(location() + ": unterminated section header");
+                        continue;
+                    }
+                    state.prefix = TrimWhitespace(line.substr(1, line.size() - 2));
+                    if (not state.prefix.empty()) {
+                        state.prefix += '.';
+                    }
+                    section = state.snapshot.getKeyPrefix(state.snapshot.getKeyPrefix(), state.prefix);
+                    continue;
+                }
+
+                size_t separator = line.find('=');
+                if (separator == std::string_view::npos) {
+                    state.errors.push_back(location() + ": expected key = value");
+                    continue;
+                }
+                std::string_view key = TrimWhitespace(line.substr(0, separator));
+                std::string_view valueStr = TrimWhitespace(line.substr(separator + 1));
+                if (valueStr.size() >= 2 && valueStr.front() == '"' && valueStr.back() == '"') {
+                    valueStr = valueStr.substr(1, valueStr.size() - 2);
+                }
+
+                RegistryKeyId id = FindKey(state, section, key);
+                if (id < 0) {
+                    state.errors.push_back(std::format("{}: unknown key {}{}", location(), state.prefix, key));
+                    continue;
+                }
+                auto parse = [&](DataUnit& value) {
+                    return StrToDataUnit(valueStr, value);
+                };
+                if (not StageValue(state, id, parse, location)) {
+                    state.errors.push_back(std::format("{}: invalid value for {}{}: {}", location(), state.prefix, key, valueStr));
+                }
+            }
+        }
+
+        static bool ReadJsonValue(JsonReader& reader, DataUnit& value) {
+            return std::visit([&]<typename T>(T& v) {
+                if constexpr(al::VectorType<T>) {
+                    if (not reader.beginArray()) {
+                        return false;
+                    }
+                    int numElements = 0;
+                    while (reader.nextElement()) {
+                        if (numElements == T::NumElements || not reader.read(v[numElements])) {
+                            return false;
+                        }
+                        numElements++;
+                    }
+                    return not reader.failed() && numElements == T::NumElements;
+                } else {
+                    return reader.read(v);
+                }
+            }, value);
+        }
+
+        /*
+         * prefix holds the keys under the object being parsed, whose dotted key is in state.prefix; empty for the root.
+         */
+        static bool ParseJsonObject(ConfigParseState& state, JsonReader& reader, const RegistryKeyPrefix& prefix) {
+            if (not reader.beginObject()) {
+                return false;
+            }
+            size_t prefixSize = state.prefix.size();
+            std::string_view key;
+            while (reader.nextKey(key)) {
+                RegistryKeyId id = FindKey(state, prefix, key);
+                if (id < 0) {
+                    if (reader.peek() == '{') {
+                        state.prefix += key;
+                        state.prefix += '.';
+                        auto objectPrefix = state.snapshot.getKeyPrefix(prefix, std::string_view(state.prefix).substr(prefixSize));
+                        if (not ParseJsonObject(state, reader, objectPrefix)) {
+                            return false;
+                        }
+                        state.prefix.resize(prefixSize);
+                        continue;
+                    }
+                    state.errors.push_back(std::format("unknown key {}{}", state.prefix, key));
+                    if (not reader.skipValue()) {
+                        return false;
+                    }
+                    continue;
+                }
+
+                auto parse = [&](DataUnit& value) {
+                    return ReadJsonValue(reader, value);
+                };
+                auto location = [] {
+                    return std::string("json");
+                };
+                if (not StageValue(state, id, parse, location)) {
+                    state.errors.push_back(std::format("invalid value for {}{}", state.prefix, key));
+                    return false;
+                }
+            }
+            return not reader.failed();
+        }
+    }
+
+    ConfigLoadResult LoadConfig(Registry& registry, std::string_view text) {
+        detail::ConfigParseState state {.snapshot = *registry.current()};
+
+        if (text.starts_with("\xEF\xBB\xBF")) {
+            text.remove_prefix(3);
+        }
+        bool isJson = detail::TrimWhitespace(text).starts_with('{');
+        // a value per key at most, barring repeated keys, and a value takes at least four bytes, as in "k=1\n"
+        state.values.reserve(std::min(state.snapshot.numValues, text.size() / 4));
+        if (isJson) {
+            JsonReader reader(text);
+            if (not detail::ParseJsonObject(state, reader, state.snapshot.getKeyPrefix()) || not reader.atEnd()) {
+                state.errors.emplace_back("malformed JSON config, no values were set");
+                state.values.clear();
+            }
+        } else {
+            detail::ParseKeyValueConfig(state, text);
+        }
+
+        ConfigLoadResult result {};
+        registry.setStaged(state.values);
+        result.numLoaded = static_cast<int>(state.values.size());
+        result.numChanged = registry.publish();
+        result.errors = std::move(state.errors);
+        return result;
+    }
+
+    ConfigLoadResult LoadConfigFile(Registry& registry, const std::string& path) {
+#ifdef _WIN32
+        std::ifstream file(path, std::ios::binary);
+        if (not file) {
+            throw std::runtime_error("Cannot open config file: " + path);
+        }
+        std::string text((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        return LoadConfig(registry, text);
+#else
+        int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            throw std::runtime_error("Cannot open config file: " + path);
+        }
+        struct stat fileStat {};
+        if (fstat(fd, &fileStat) != 0) {
+            close(fd);
+            throw std::runtime_error("Cannot stat config file: " + path);
+        }
+        auto size = static_cast<size_t>(fileStat.st_size);
+        if (size == 0) {
+            close(fd);
+            return LoadConfig(registry, {});
+        }
+
+        void* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (data == MAP_FAILED) {
+            throw std::runtime_error("Cannot map config file: " + path);
+        }
+        madvise(data, size, MADV_SEQUENTIAL);
+
+        struct Unmap {
+            void* data;
+            size_t size;
+            ~Unmap() {
+                munmap(data, size);
+            }
+        } unmap {data, size};
+        return LoadConfig(registry, std::string_view(static_cast<const char*>(data), size));
+#endif
+    }
+
+} // lpg
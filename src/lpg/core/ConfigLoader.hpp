@@ -0,0 +1,51 @@
+//
+// Created by volt on 2026-10-19.
+//
+
+
+
+
+#ifndef LPG_ENGINE_SRC_LPG_CORE_CONFIGLOADER_HPP_
+#define LPG_ENGINE_SRC_LPG_CORE_CONFIGLOADER_HPP_
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace lpg {
+
+    class Registry;
+
+    struct ConfigLoadResult {
+        int numLoaded = 0; // values that were parsed and set
+        int numChanged = 0; // of those, values that differed from the registry
+        std::vector<std::string> errors;
+    };
+
+    /*
+     * Sets registry values from a config file in one pass over the text, then publishes them together.
+     * Keys must already be registered; each value is parsed as the type of its key and checked against its range.
+     * Unknown keys, malformed values and out-of-range values are reported in errors and skipped.
+     *
+     * Two formats are accepted:
+     *  - key = value lines, with # or ; comments and [section] headers that prefix the following keys:
+     *        [root.videomode]
+     *        depth = 32
+     *        size = 1920,1080
+     *    A value may be wrapped in double quotes; there are no escape sequences and no trailing comments.
+     *  - a JSON object, whose nested objects form dotted keys and whose arrays are vectors:
+     *        {"root": {"videomode": {"depth": 32, "size": [1920, 1080]}}}
+     *    A JSON value of the wrong type or malformed JSON stops parsing, and then no values are set.
+     *
+     * Like every reader of the registry, this must not run concurrently with Registry::reclaim().
+     */
+    ConfigLoadResult LoadConfig(Registry& registry, std::string_view text);
+
+    /*
+     * Maps the file into memory and loads it with LoadConfig. Throws if the file cannot be read.
+     */
+    ConfigLoadResult LoadConfigFile(Registry& registry, const std::string& path);
+
+} // lpg
+
+#endif //LPG_ENGINE_SRC_LPG_CORE_CONFIGLOADER_HPP_
@@ -0,0 +1,221 @@
+//
+// Created by volt on 2026-10-19.
+//
+
+
+
+
+#ifndef LPG_ENGINE_SRC_LPG_CORE_ENTITYPAGE_HPP_
+#define LPG_ENGINE_SRC_LPG_CORE_ENTITYPAGE_HPP_
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "entity.hpp"
+
+namespace lpg {
+    namespace detail {
+        static constexpr inline unsigned EntityPageSize = 256;
+        static constexpr inline unsigned LogEntityPageSize = 8;
+        static_assert(EntityPageSize == (1 << LogEntityPageSize));
+
+        struct EntityPage {
+            int32_t entityTypeId;
+            int32_t pageId;
+            int32_t parentPage;
+
+            /*
+             * Managed components live in their own pages, one per managed component of the owner type.
+             * Slot N of a linked page holds the component of the entity in slot N of the owner page.
+             * Linked pages have parentPage set to the owner page; top-level pages have -1.
+             */
+            std::vector<int32_t> managedComponentPages;
+            int32_t stride;
+            int32_t currentSize;
+
+            int32_t numOccupied = 0;
+
+            /*
+             * Incremented whenever a slot is reserved or released, so that systems mirroring a page
+             * (e.g. physics bodies) only rescan it after it changed.
+             */
+            uint32_t structureVersion = 0;
+
+            std::array<uint64_t, (EntityPageSize + 63) / 64> occupancy;
+
+            std::vector<std::byte> storage;
+
+            [[nodiscard]] std::optional<int> findFreeOffset() const {
+                for (int i = 0; i < occupancy.size(); i++) {
+                    if (int bits = std::countr_one(occupancy[i]); bits < 64) {
+                        int result = bits + i * 64;
+                        if (result >= EntityPageSize) {
+                            return std::nullopt;
+                        }
+                        return result;
+                    }
+                }
+                return std::nullopt;
+            }
+
+            struct PageReserveEntityResult {
+                void* entity;
+                int32_t offset;
+            };
+
+            /*
+             * Reserves the leftmost free spot, if one exists, for storing an entity.
+             * It is the caller's responsibility to construct the entity object at the returned address.
+             */
+            std::optional<PageReserveEntityResult> reserveEntity() {
+                auto offOpt = findFreeOffset();
+                if (not offOpt) {
+                    return std::nullopt;
+                }
+                return reserveEntityAt(*offOpt);
+            }
+
+            /*
+             * Reserves a specific spot, which must be free. Used to keep linked pages in step with their owner page.
+             */
+            PageReserveEntityResult reserveEntityAt(int off) {
+                int targetSize = (off + 1) * stride;
+
+                if (storage.size() < targetSize) {
+                    storage.resize(targetSize);
+                }
+
+                occupancy[off / 64] |= (uint64_t{1} << (off % 64));
+                structureVersion++;
+                return PageReserveEntityResult{
+                    .entity = entityPtr(off),
+                    .offset = off
+                };
+            }
+
+            bool isEmpty() const {
+                for (int i = 0; i < occupancy.size(); i++) {
+                    if (occupancy[i] != 0) {
+                        return false;
+                    }
+                }
+                return true;
+            }
+
+            bool isFull() const {
+                for (int i = 0; i < occupancy.size(); i++) {
+                    if (~occupancy[i] != 0) {
+                        return false;
+                    }
+                }
+                return true;
+            }
+
+            /*
+             * Marks the storage at the specified offset as ready to be reused for another entity.
+             * It is the caller's responsibility to destroy the entity object before calling this function.
+             */
+            void releaseEntity(int offset) {
+                occupancy[offset / 64] &= ~(uint64_t{1} << (offset % 64));
+                structureVersion++;
+            }
+
+            bool isEntityPresent(int offset) {
+                if (offset >= EntityPageSize) {
+                    return false;
+                }
+                return occupancy[offset / 64] & (uint64_t{1} << (offset % 64));
+            }
+
+            void* entityPtr(int offset) {
+                return storage.data() + offset * stride;
+            }
+            void* componentPtr(int offset, int componentOfffset) {
+                return storage.data() + componentOfffset + offset * stride;
+            }
+
+            [[nodiscard]] int numActiveEntities() const {
+                int result = 0;
+                for (int i = 0; i < occupancy.size(); i++) {
+                    result += std::popcount(occupancy[i]);
+                }
+                return result;
+            }
+
+            [[nodiscard]] std::vector<std::pair<int, int> > getActiveRanges() const {
+                return OccupiedRanges(occupancy);
+            }
+
+            /*
+             * Maximal runs [begin, end) of set bits, in ascending order.
+             */
+            static constexpr std::vector<std::pair<int, int> > OccupiedRanges(const std::array<uint64_t, (EntityPageSize + 63) / 64>& occupancy) {
+                std::vector<std::pair<int, int> > result;
+                result.reserve(8);
+                int curBegin = 0, curEnd = 0;
+                for (int i = 0; i < occupancy.size(); i++) {
+                    uint64_t tmp = occupancy[i];
+                    int pos = 0;
+                    while (tmp != 0) {
+                        int t0 = std::countr_zero(tmp);
+                        tmp >>= t0 & 63;
+                        int t1 = std::countr_one(tmp);
+                        tmp >>= t1 & 63;
+                        if (t1 == 64) {
+                            tmp = 0;
+                        }
+
+                        int begin = pos + t0;
+                        int end = begin + t1;
+                        pos += t0 + t1;
+
+                        begin += 64 * i;
+                        end += 64 * i;
+
+                        if (curBegin == curEnd) {
+                            curBegin = begin;
+                            curEnd = end;
+                        } else if (curEnd == begin) {
+                            curEnd = end;
+                        } else {
+                            result.emplace_back(curBegin, curEnd);
+                            curBegin = begin;
+                            curEnd = end;
+                        }
+                    }
+                }
+                if (curBegin != curEnd) {
+                    result.emplace_back(curBegin, curEnd);
+                }
+
+                return result;
+            }
+        };
+
+        // runs that do not start at slot 0, and runs crossing or touching a word boundary
+        static_assert(EntityPage::OccupiedRanges({0b1110}) == std::vector<std::pair<int, int> > {{1, 4}});
+        static_assert(EntityPage::OccupiedRanges({uint64_t{1} << 63, 1}) == std::vector<std::pair<int, int> > {{63, 65}});
+        static_assert(EntityPage::OccupiedRanges({0b1011, 0, 0, uint64_t{1} << 63}) == std::vector<std::pair<int, int> > {{0, 2}, {3, 4}, {255, 256}});
+        static_assert(EntityPage::OccupiedRanges({~uint64_t{0}, ~uint64_t{0}, 0, 0b110}) == std::vector<std::pair<int, int> > {{0, 128}, {193, 195}});
+        static_assert(EntityPage::OccupiedRanges({}).empty());
+    } // namespace detail
+
+    inline auto DecomposeEntityDescriptor(EntityDescriptor ed) {
+        struct Result {
+            uint32_t page;
+            uint32_t offset;
+        };
+        return Result {
+            .page = ed / detail::EntityPageSize,
+            .offset = ed % detail::EntityPageSize,
+        };
+    }
+
+} // lpg
+
+#endif //LPG_ENGINE_SRC_LPG_CORE_ENTITYPAGE_HPP_
@@ -0,0 +1,283 @@
+//
+// Created by volt on 2026-10-19.
+//
+
+
+
+
+#include "FieldAccessProfiler.hpp"
+
+#include "entity.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <format>
+#include <functional>
+#include <iterator>
+#include <map>
+#include <mutex>
+#include <tuple>
+
+namespace lpg::profiler {
+
+    namespace detail {
+
+        struct FieldAccessData {
+            std::mutex mutex;
+            std::map<std::tuple<int32_t, int32_t, int>, std::pair<uint64_t, uint64_t>> counts; // (type, field, system) -> (reads, writes)
+            std::map<std::pair<int32_t, int>, uint64_t> queriedEntities; // (type, system) -> entities
+            uint64_t numTicks = 0;
+            std::atomic<int> writeSampleInterval = 16;
+        };
+
+        static FieldAccessData& GetFieldAccessData() {
+            static FieldAccessData data;
+            return data;
+        }
+
+        thread_local int CurrentSystemId = NoSystem;
+
+        static std::string GetSystemName(const std::vector<std::string>& systemNames, int systemId) {
+            if (systemId >= 0 && systemId < systemNames.size()) {
+                return systemNames[systemId];
+            }
+            return systemId == NoSystem ? "(no system)" : std::format("system {}", systemId);
+        }
+    }
+
+    ScopedSystemAttribution::ScopedSystemAttribution(int systemId)
+        : previousSystemId_(detail::CurrentSystemId) {
+        detail::CurrentSystemId = systemId;
+    }
+
+    ScopedSystemAttribution::~ScopedSystemAttribution() {
+        detail::CurrentSystemId = previousSystemId_;
+    }
+
+    int GetCurrentSystem() {
+        return detail::CurrentSystemId;
+    }
+
+    void RecordFieldAccess(int32_t entityTypeId, int32_t fieldIndex, uint64_t reads, uint64_t writes) {
+        auto& data = detail::GetFieldAccessData();
+        std::lock_guard lock(data.mutex);
+        auto& [numReads, numWrites] = data.counts[{entityTypeId, fieldIndex, detail::CurrentSystemId}];
+        numReads += reads;
+        numWrites += writes;
+    }
+
+    void RecordEntityTypeQuery(int32_t entityTypeId, uint64_t numEntities) {
+        auto& data = detail::GetFieldAccessData();
+        std::lock_guard lock(data.mutex);
+        data.queriedEntities[{entityTypeId, detail::CurrentSystemId}] += numEntities;
+    }
+
+    void SetWriteSampleInterval(int interval) {
+        detail::GetFieldAccessData().writeSampleInterval = std::max(interval, 1);
+    }
+
+    int GetWriteSampleInterval() {
+        return detail::GetFieldAccessData().writeSampleInterval;
+    }
+
+    void RecordFieldAccessTick() {
+        auto& data = detail::GetFieldAccessData();
+        std::lock_guard lock(data.mutex);
+        data.numTicks++;
+    }
+
+    std::vector<FieldAccessCounts> CollectFieldAccesses() {
+        auto& data = detail::GetFieldAccessData();
+        std::lock_guard lock(data.mutex);
+        std::vector<FieldAccessCounts> result;
+        result.reserve(data.counts.size());
+        for (const auto& [key, value]: data.counts) {
+            auto [entityTypeId, fieldIndex, systemId] = key;
+            result.push_back(FieldAccessCounts {
+                .entityTypeId = entityTypeId,
+                .fieldIndex = fieldIndex,
+                .systemId = systemId,
+                .reads = value.first,
+                .writes = value.second
+            });
+        }
+        return result;
+    }
+
+    std::vector<EntityTypeQueryCounts> CollectEntityTypeQueries() {
+        auto& data = detail::GetFieldAccessData();
+        std::lock_guard lock(data.mutex);
+        std::vector<EntityTypeQueryCounts> result;
+        result.reserve(data.queriedEntities.size());
+        for (const auto& [key, numEntities]: data.queriedEntities) {
+            result.push_back(EntityTypeQueryCounts {
+                .entityTypeId = key.first,
+                .systemId = key.second,
+                .numEntities = numEntities
+            });
+        }
+        return result;
+    }
+
+    uint64_t GetNumFieldAccessTicks() {
+        auto& data = detail::GetFieldAccessData();
+        std::lock_guard lock(data.mutex);
+        return data.numTicks;
+    }
+
+    void ClearFieldAccesses() {
+        auto& data = detail::GetFieldAccessData();
+        std::lock_guard lock(data.mutex);
+        data.counts.clear();
+        data.queriedEntities.clear();
+        data.numTicks = 0;
+    }
+
+    FieldAccessReport BuildFieldAccessReport(const std::vector<EntityInterface>& entityInterfaces, const std::vector<std::string>& systemNames) {
+        FieldAccessReport report {};
+        report.numTicks = GetNumFieldAccessTicks();
+        double numTicks = static_cast<double>(std::max<uint64_t>(report.numTicks, 1));
+
+        struct FieldTotals {
+            uint64_t reads = 0;
+            uint64_t writes = 0;
+            std::vector<int> systemIds; // sorted, as the counts are ordered by system within a field
+            std::vector<int> writerSystemIds;
+        };
+        std::map<std::pair<int32_t, int32_t>, FieldTotals> totals;
+        for (const auto& counts: CollectFieldAccesses()) {
+            if (counts.entityTypeId < 0 || counts.entityTypeId >= entityInterfaces.size()) {
+                continue;
+            }
+            if (counts.fieldIndex < 0 || counts.fieldIndex >= entityInterfaces[counts.entityTypeId].properties.size()) {
+                continue;
+            }
+            auto& fieldTotals = totals[{counts.entityTypeId, counts.fieldIndex}];
+            fieldTotals.reads += counts.reads;
+            fieldTotals.writes += counts.writes;
+            fieldTotals.systemIds.push_back(counts.systemId);
+            if (counts.writes > 0) {
+                fieldTotals.writerSystemIds.push_back(counts.systemId);
+            }
+        }
+
+        auto toSystemNames = [&](const std::vector<int>& systemIds) {
+            std::vector<std::string> result;
+            for (int systemId: systemIds) {
+                result.push_back(detail::GetSystemName(systemNames, systemId));
+            }
+            return result;
+        };
+
+        for (const auto& [key, fieldTotals]: totals) {
+            auto [entityTypeId, fieldIndex] = key;
+            const auto& interface = entityInterfaces[entityTypeId];
+            const auto& property = interface.properties[fieldIndex];
+            report.fields.push_back(FieldAccessReportEntry {
+                .entityTypeName = std::string(interface.name),
+                .fieldName = std::string(property.name),
+                .entityTypeId = entityTypeId,
+                .fieldIndex = fieldIndex,
+                .reads = fieldTotals.reads,
+                .writes = fieldTotals.writes,
+                .bytesPerTick = static_cast<double>((fieldTotals.reads + fieldTotals.writes) * property.size) / numTicks,
+                .systems = toSystemNames(fieldTotals.systemIds)
+            });
+        }
+        std::ranges::stable_sort(report.fields, std::greater{}, &FieldAccessReportEntry::bytesPerTick);
+
+        for (int32_t entityTypeId = 0; entityTypeId < entityInterfaces.size(); entityTypeId++) {
+            const auto& interface = entityInterfaces[entityTypeId];
+            if (interface.properties.empty()) {
+                continue;
+            }
+
+            // fields read by the same systems and written by the same systems belong together
+            std::map<std::pair<std::vector<int>, std::vector<int>>, ColumnGroupSuggestion> groups;
+            for (int32_t fieldIndex = 0; fieldIndex < interface.properties.size(); fieldIndex++) {
+                const auto& property = interface.properties[fieldIndex];
+                std::vector<int> systemIds;
+                std::vector<int> writerSystemIds;
+                double bytesPerTick = 0.0;
+                if (auto it = totals.find({entityTypeId, fieldIndex}); it != totals.end()) {
+                    systemIds = it->second.systemIds;
+                    writerSystemIds = it->second.writerSystemIds;
+                    bytesPerTick = static_cast<double>((it->second.reads + it->second.writes) * property.size) / numTicks;
+                }
+
+                auto [it, inserted] = groups.try_emplace({systemIds, writerSystemIds});
+                auto& group = it->second;
+                if (inserted) {
+                    group.entityTypeName = std::string(interface.name);
+                    group.systems = toSystemNames(systemIds);
+                    group.writerSystems = toSystemNames(writerSystemIds);
+                }
+                group.fieldNames.emplace_back(property.name);
+                group.bytesPerTick += bytesPerTick;
+            }
+
+            std::vector<ColumnGroupSuggestion> typeGroups;
+            for (auto& [key, group]: groups) {
+                typeGroups.push_back(std::move(group));
+            }
+            std::ranges::stable_sort(typeGroups, std::greater{}, &ColumnGroupSuggestion::bytesPerTick);
+            std::ranges::move(typeGroups, std::back_inserter(report.columnGroups));
+        }
+
+        for (const auto& counts: CollectEntityTypeQueries()) {
+            if (counts.entityTypeId < 0 || counts.entityTypeId >= entityInterfaces.size()) {
+                continue;
+            }
+            report.queriedTypes.push_back(QueriedEntityTypeEntry {
+                .entityTypeName = std::string(entityInterfaces[counts.entityTypeId].name),
+                .system = detail::GetSystemName(systemNames, counts.systemId),
+                .entityTypeId = counts.entityTypeId,
+                .entitiesPerTick = static_cast<double>(counts.numEntities) / numTicks
+            });
+        }
+        std::ranges::stable_sort(report.queriedTypes, std::greater{}, &QueriedEntityTypeEntry::entitiesPerTick);
+
+        return report;
+    }
+
+    static std::string JoinNames(const std::vector<std::string>& names) {
+        std::string result;
+        for (const auto& name: names) {
+            if (not result.empty()) {
+                result += ", ";
+            }
+            result += name;
+        }
+        return result;
+    }
+
+    std::string FieldAccessReport::toString() const {
+        std::string result = std::format("Field accesses over {} ticks, by bytes touched per tick:\n", numTicks);
+        for (const auto& entry: fields) {
+            result += std::format(
+                "  {}::{}: {:.1f} B/tick, {} reads, {} writes [{}]\n",
+                entry.entityTypeName, entry.fieldName, entry.bytesPerTick, entry.reads, entry.writes, JoinNames(entry.systems)
+            );
+        }
+
+        result += "Suggested column groups:\n";
+        for (const auto& group: columnGroups) {
+            if (group.systems.empty()) {
+                result += std::format("  {} {{{}}}: no recorded access\n", group.entityTypeName, JoinNames(group.fieldNames));
+                continue;
+            }
+            result += std::format(
+                "  {} {{{}}}: {:.1f} B/tick, used by {}, written by {}\n",
+                group.entityTypeName, JoinNames(group.fieldNames), group.bytesPerTick,
+                JoinNames(group.systems), group.writerSystems.empty() ? std::string("none") : JoinNames(group.writerSystems)
+            );
+        }
+
+        result += "Entities in declared queries (type level; reads through pages are not seen per field):\n";
+        for (const auto& entry: queriedTypes) {
+            result += std::format("  {} by {}: {:.1f} entities/tick\n", entry.entityTypeName, entry.system, entry.entitiesPerTick);
+        }
+        return result;
+    }
+
+} // lpg::profiler
@@ -0,0 +1,149 @@
+//
+// Created by volt on 2026-10-19.
+//
+
+
+
+
+#ifndef LPG_ENGINE_SRC_LPG_CORE_FIELDACCESSPROFILER_HPP_
+#define LPG_ENGINE_SRC_LPG_CORE_FIELDACCESSPROFILER_HPP_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/*
+ * Field access profiling, an instrumentation build mode (CMake option LPG_ENGINE_ENABLE_FIELD_ACCESS_PROFILER)
+ * that records which fields of which entity types each system touches:
+ *
+ *  - property accessors (GetPropertyPtr, SetProperty) record exact per-field reads and writes;
+ *  - the generated field projections (getPosition, gatherPositions, accumulateTransforms, ...) record
+ *    a read of each field they project, per entity;
+ *  - writes made directly to entities in pages are observed by diffing the pages a system may write before
+ *    and after it runs (a write of an unchanged value is not seen). Copying those pages is the expensive part
+ *    of this mode, so it is only done on one run in GetWriteSampleInterval() of each system, and the counts
+ *    are scaled up accordingly.
+ *
+ * Reads made directly through pages are invisible, e.g. PhysicsSimulationSystem reading RigidBody components
+ * straight out of World::getPage. For those only the number of entities of each type a system declares in its
+ * Queries is recorded (on the sampled runs, scaled like the writes), as type-level counts that do not feed the
+ * column group suggestions: fields that only such systems read are missing from them.
+ *
+ * The macros compile to nothing unless LPG_ENABLE_FIELD_ACCESS_PROFILER is defined.
+ */
+#ifdef LPG_ENABLE_FIELD_ACCESS_PROFILER
+#define LPG_RECORD_FIELD_READ(EntityTypeId, FieldIndex) ::lpg::profiler::RecordFieldAccess((EntityTypeId), (FieldIndex), 1, 0)
+#define LPG_RECORD_FIELD_WRITE(EntityTypeId, FieldIndex) ::lpg::profiler::RecordFieldAccess((EntityTypeId), (FieldIndex), 0, 1)
+#else
+#define LPG_RECORD_FIELD_READ(EntityTypeId, FieldIndex) ((void)0)
+#define LPG_RECORD_FIELD_WRITE(EntityTypeId, FieldIndex) ((void)0)
+#endif
+
+namespace lpg {
+    struct EntityInterface;
+}
+
+namespace lpg::profiler {
+
+    static constexpr int NoSystem = -1;
+
+    struct FieldAccessCounts {
+        int32_t entityTypeId;
+        int32_t fieldIndex;
+        int systemId; // NoSystem for accesses made outside of any system
+        uint64_t reads;
+        uint64_t writes;
+    };
+
+    /*
+     * Accesses recorded on this thread are attributed to the given system while the object is alive.
+     */
+    class ScopedSystemAttribution {
+    public:
+        explicit ScopedSystemAttribution(int systemId);
+        ~ScopedSystemAttribution();
+
+        ScopedSystemAttribution(const ScopedSystemAttribution&) = delete;
+        ScopedSystemAttribution& operator=(const ScopedSystemAttribution&) = delete;
+
+    private:
+        int previousSystemId_;
+    };
+
+    int GetCurrentSystem();
+
+    /*
+     * Entities of a type present when a system that declares it in its Queries ran.
+     */
+    struct EntityTypeQueryCounts {
+        int32_t entityTypeId;
+        int systemId;
+        uint64_t numEntities;
+    };
+
+    void RecordFieldAccess(int32_t entityTypeId, int32_t fieldIndex, uint64_t reads, uint64_t writes);
+    void RecordEntityTypeQuery(int32_t entityTypeId, uint64_t numEntities);
+    void RecordFieldAccessTick();
+
+    /*
+     * Pages are diffed on one run in interval of each system, 1 to diff on every run. Defaults to 16.
+     */
+    void SetWriteSampleInterval(int interval);
+    [[nodiscard]] int GetWriteSampleInterval();
+
+    [[nodiscard]] std::vector<FieldAccessCounts> CollectFieldAccesses();
+    [[nodiscard]] std::vector<EntityTypeQueryCounts> CollectEntityTypeQueries();
+    [[nodiscard]] uint64_t GetNumFieldAccessTicks();
+    void ClearFieldAccesses();
+
+    struct FieldAccessReportEntry {
+        std::string entityTypeName;
+        std::string fieldName;
+        int32_t entityTypeId;
+        int32_t fieldIndex;
+        uint64_t reads;
+        uint64_t writes;
+        double bytesPerTick;
+        std::vector<std::string> systems;
+    };
+
+    /*
+     * Fields of one entity type that are touched by exactly the same systems, and written by exactly the same systems.
+     * Fields with no recorded access end up in a group with an empty system list: cold data,
+     * or data only read directly through pages (compare with FieldAccessReport::queriedTypes).
+     */
+    struct ColumnGroupSuggestion {
+        std::string entityTypeName;
+        std::vector<std::string> fieldNames;
+        std::vector<std::string> systems;
+        std::vector<std::string> writerSystems;
+        double bytesPerTick;
+    };
+
+    struct QueriedEntityTypeEntry {
+        std::string entityTypeName;
+        std::string system;
+        int32_t entityTypeId;
+        double entitiesPerTick;
+    };
+
+    struct FieldAccessReport {
+        uint64_t numTicks;
+        std::vector<FieldAccessReportEntry> fields; // most bytes touched per tick first
+        std::vector<ColumnGroupSuggestion> columnGroups; // per entity type, hottest group first
+        std::vector<QueriedEntityTypeEntry> queriedTypes; // most entities per tick first
+
+        [[nodiscard]] std::string toString() const;
+    };
+
+    /*
+     * entityInterfaces is indexed by entity type id and systemNames by system id.
+     */
+    [[nodiscard]] FieldAccessReport BuildFieldAccessReport(
+        const std::vector<EntityInterface>& entityInterfaces,
+        const std::vector<std::string>& systemNames
+    );
+
+} // lpg::profiler
+
+#endif //LPG_ENGINE_SRC_LPG_CORE_FIELDACCESSPROFILER_HPP_
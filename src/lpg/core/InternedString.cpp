@@ -0,0 +1,172 @@
+//
+// Created by volt on 2026-10-19.
+//
+
+
+
+
+#include "InternedString.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+namespace lpg {
+
+    namespace detail {
+
+        struct InternedEntry {
+            const char* data;
+            uint32_t size;
+            size_t hash;
+        };
+
+        // segment s holds FirstSegmentSize << s entries
+        static constexpr int NumEntrySegments = 22;
+        static constexpr uint32_t FirstSegmentSize = 1024;
+        static constexpr uint32_t MaxNumEntries = FirstSegmentSize * ((uint32_t{1} << NumEntrySegments) - 1);
+        static constexpr size_t StringBlockSize = 64 * 1024;
+
+        /*
+         * Open addressing over entry ids, 0 marking an empty slot. It is replaced by a larger copy when half full;
+         * old generations stay alive so that lock-free readers never see freed memory.
+         */
+        struct InternIndex {
+            size_t mask;
+            std::unique_ptr<std::atomic<uint32_t>[]> slots;
+
+            explicit InternIndex(size_t capacity)
+                : mask(capacity - 1), slots(std::make_unique<std::atomic<uint32_t>[]>(capacity)) {}
+        };
+
+        struct InternTable {
+            std::atomic<InternedEntry*> segments[NumEntrySegments] {};
+            std::atomic<InternIndex*> index {nullptr};
+
+            std::mutex insertMutex;
+            uint32_t numEntries = 1;
+            std::vector<std::unique_ptr<InternedEntry[]>> segmentStorage;
+            std::vector<std::unique_ptr<InternIndex>> indexGenerations;
+            std::vector<std::unique_ptr<char[]>> stringBlocks;
+            char* blockCursor = nullptr;
+            size_t blockRemaining = 0;
+
+            InternTable() {
+                indexGenerations.push_back(std::make_unique<InternIndex>(FirstSegmentSize));
+                index.store(indexGenerations.back().get(), std::memory_order_release);
+            }
+        };
+
+        static InternTable& GetInternTable() {
+            static InternTable table;
+            return table;
+        }
+
+        static std::pair<int, uint32_t> LocateEntry(uint32_t id) {
+            int segment = std::bit_width(id / FirstSegmentSize + 1) - 1;
+            uint32_t firstIdInSegment = FirstSegmentSize * ((uint32_t{1} << segment) - 1);
+            return {segment, id - firstIdInSegment};
+        }
+
+        static const InternedEntry& GetEntry(const InternTable& table, uint32_t id) {
+            auto [segment, offset] = LocateEntry(id);
+            return table.segments[segment].load(std::memory_order_acquire)[offset];
+        }
+
+        static uint32_t FindInIndex(const InternTable& table, const InternIndex& index, std::string_view str, size_t hash) {
+            for (size_t i = hash & index.mask;; i = (i + 1) & index.mask) {
+                uint32_t id = index.slots[i].load(std::memory_order_acquire);
+                if (id == 0) {
+                    return 0;
+                }
+                const auto& entry = GetEntry(table, id);
+                if (entry.hash == hash && std::string_view(entry.data, entry.size) == str) {
+                    return id;
+                }
+            }
+        }
+
+        static void AddToIndex(const InternIndex& index, uint32_t id, size_t hash) {
+            size_t i = hash & index.mask;
+            while (index.slots[i].load(std::memory_order_relaxed) != 0) {
+                i = (i + 1) & index.mask;
+            }
+            index.slots[i].store(id, std::memory_order_release);
+        }
+
+        static const char* StoreString(InternTable& table, std::string_view str) {
+            size_t size = str.size() + 1;
+            if (size > table.blockRemaining) {
+                size_t blockSize = std::max(size, StringBlockSize);
+                table.stringBlocks.push_back(std::make_unique<char[]>(blockSize));
+                table.blockCursor = table.stringBlocks.back().get();
+                table.blockRemaining = blockSize;
+            }
+            char* result = table.blockCursor;
+            std::memcpy(result, str.data(), str.size());
+            result[str.size()] = '\0';
+            table.blockCursor += size;
+            table.blockRemaining -= size;
+            return result;
+        }
+
+        uint32_t InternString(std::string_view str) {
+            if (str.empty()) {
+                return 0;
+            }
+            auto& table = GetInternTable();
+            size_t hash = std::hash<std::string_view>{}(str);
+
+            if (uint32_t id = FindInIndex(table, *table.index.load(std::memory_order_acquire), str, hash)) {
+                return id;
+            }
+
+            std::lock_guard lock(table.insertMutex);
+            // another thread may have inserted it, possibly into a newer index
+            auto* index = table.index.load(std::memory_order_relaxed);
+            if (uint32_t id = FindInIndex(table, *index, str, hash)) {
+                return id;
+            }
+            if (table.numEntries == MaxNumEntries) {
+                throw std::runtime_error("Intern table is full");
+            }
+
+            uint32_t id = table.numEntries++;
+            auto [segment, offset] = LocateEntry(id);
+            if (not table.segments[segment].load(std::memory_order_relaxed)) {
+                table.segmentStorage.push_back(std::make_unique<InternedEntry[]>(size_t{FirstSegmentSize} << segment));
+                table.segments[segment].store(table.segmentStorage.back().get(), std::memory_order_release);
+            }
+            table.segments[segment].load(std::memory_order_relaxed)[offset] = InternedEntry {
+                .data = StoreString(table, str),
+                .size = static_cast<uint32_t>(str.size()),
+                .hash = hash
+            };
+
+            if (2 * (table.numEntries - 1) > index->mask + 1) {
+                auto& grown = table.indexGenerations.emplace_back(std::make_unique<InternIndex>(2 * (index->mask + 1)));
+                for (uint32_t existingId = 1; existingId < id; existingId++) {
+                    AddToIndex(*grown, existingId, GetEntry(table, existingId).hash);
+                }
+                index = grown.get();
+                table.index.store(index, std::memory_order_release);
+            }
+            AddToIndex(*index, id, hash);
+            return id;
+        }
+
+        std::string_view GetInternedString(uint32_t id) {
+            if (id == 0) {
+                return "";
+            }
+            const auto& entry = GetEntry(GetInternTable(), id);
+            return {entry.data, entry.size};
+        }
+    }
+
+} // lpg
@@ -0,0 +1,78 @@
+//
+// Created by volt on 2026-10-19.
+//
+
+
+
+
+#ifndef LPG_ENGINE_SRC_LPG_CORE_INTERNEDSTRING_HPP_
+#define LPG_ENGINE_SRC_LPG_CORE_INTERNEDSTRING_HPP_
+
+#include <cstdint>
+#include <functional>
+#include <string_view>
+
+namespace lpg {
+
+    namespace detail {
+        uint32_t InternString(std::string_view str);
+        std::string_view GetInternedString(uint32_t id);
+    }
+
+    /*
+     * A 32-bit handle to a string in the process-wide intern table. Equal strings get equal ids, so comparing
+     * and hashing are integer operations, and unlike std::string the handle is trivially copyable, which keeps
+     * entities that use it on the memcpy paths. Interned strings are never freed.
+     *
+     * Resolving an id and interning a string that is already in the table are lock-free;
+     * interning a new string briefly takes a mutex.
+     */
+    class InternedString {
+    public:
+        constexpr InternedString() = default;
+
+        explicit InternedString(std::string_view str)
+            : id_(detail::InternString(str)) {}
+
+        InternedString(const char* str)
+            : InternedString(std::string_view(str)) {}
+
+        [[nodiscard]] std::string_view view() const {
+            return detail::GetInternedString(id_);
+        }
+
+        /*
+         * Interned strings are null-terminated.
+         */
+        [[nodiscard]] const char* c_str() const {
+            return view().data();
+        }
+
+        operator std::string_view() const {
+            return view();
+        }
+
+        [[nodiscard]] uint32_t id() const {
+            return id_;
+        }
+
+        [[nodiscard]] bool empty() const {
+            return id_ == 0;
+        }
+
+        friend bool operator==(InternedString, InternedString) = default;
+
+    private:
+        uint32_t id_ = 0; // 0 is the empty string
+    };
+
+} // lpg
+
+template<>
+struct std::hash<lpg::InternedString> {
+    size_t operator()(lpg::InternedString str) const noexcept {
+        return std::hash<uint32_t>{}(str.id());
+    }
+};
+
+#endif //LPG_ENGINE_SRC_LPG_CORE_INTERNEDSTRING_HPP_
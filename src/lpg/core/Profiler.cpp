@@ -0,0 +1,206 @@
+//
+// Created by volt on 2026-10-19.
+//
+
+
+
+
+#include "Profiler.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <format>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace lpg::profiler {
+
+    namespace detail {
+
+        /*
+         * Written only by its owning thread. The mutex is uncontended except while exporting.
+         */
+        struct ThreadBuffer {
+            std::mutex mutex;
+            uint32_t threadIndex = 0;
+            std::string threadName;
+            uint32_t depth = 0;
+
+            std::unique_ptr<std::array<ZoneEvent, ThreadBufferCapacity>> events = std::make_unique<std::array<ZoneEvent, ThreadBufferCapacity>>();
+            uint64_t numWritten = 0;
+
+            template<typename Fn>
+            void forEachEvent(Fn&& fn) {
+                uint64_t numStored = std::min<uint64_t>(numWritten, ThreadBufferCapacity);
+                for (uint64_t i = numWritten - numStored; i < numWritten; i++) {
+                    fn((*events)[i % ThreadBufferCapacity]);
+                }
+            }
+        };
+
+        struct ProfilerData {
+            std::mutex mutex;
+            std::vector<std::shared_ptr<ThreadBuffer>> threadBuffers;
+            std::unordered_set<std::string> internedNames;
+            std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+        };
+
+        static ProfilerData& GetProfilerData() {
+            static ProfilerData data;
+            return data;
+        }
+
+        static ThreadBuffer& GetThreadBuffer() {
+            thread_local std::shared_ptr<ThreadBuffer> buffer = []() {
+                auto& data = GetProfilerData();
+                auto result = std::make_shared<ThreadBuffer>();
+                std::lock_guard lock(data.mutex);
+                result->threadIndex = static_cast<uint32_t>(data.threadBuffers.size());
+                result->threadName = std::format("thread {}", result->threadIndex);
+                data.threadBuffers.push_back(result);
+                return result;
+            }();
+            return *buffer;
+        }
+
+        uint64_t NowNs() {
+            auto elapsed = std::chrono::steady_clock::now() - GetProfilerData().epoch;
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+        }
+
+        uint32_t PushZone() {
+            return GetThreadBuffer().depth++;
+        }
+
+        void PopZone(const char* name, uint64_t beginNs, uint32_t depth) {
+            uint64_t endNs = NowNs();
+            auto& buffer = GetThreadBuffer();
+            buffer.depth = depth;
+
+            std::lock_guard lock(buffer.mutex);
+            (*buffer.events)[buffer.numWritten % ThreadBufferCapacity] = ZoneEvent {
+                .name = name,
+                .beginNs = beginNs,
+                .endNs = endNs,
+                .depth = depth
+            };
+            ++buffer.numWritten;
+        }
+
+        static std::vector<std::shared_ptr<ThreadBuffer>> GetAllThreadBuffers() {
+            auto& data = GetProfilerData();
+            std::lock_guard lock(data.mutex);
+            return data.threadBuffers;
+        }
+
+        static void WriteJsonString(std::ostream& os, std::string_view str) {
+            os << '"';
+            for (char c: str) {
+                if (c == '"' || c == '\\') {
+                    os << '\\' << c;
+                } else if (static_cast<unsigned char>(c) < 0x20) {
+                    os << std::format("\\u{:04x}", static_cast<int>(c));
+                } else {
+                    os << c;
+                }
+            }
+            os << '"';
+        }
+    }
+
+    void SetEnabled(bool enabled) {
+        detail::Enabled.store(enabled, std::memory_order_relaxed);
+    }
+
+    const char* InternZoneName(std::string_view name) {
+        auto& data = detail::GetProfilerData();
+        std::lock_guard lock(data.mutex);
+        return data.internedNames.emplace(name).first->c_str();
+    }
+
+    void SetThreadName(std::string_view name) {
+        auto& buffer = detail::GetThreadBuffer();
+        std::lock_guard lock(buffer.mutex);
+        buffer.threadName = name;
+    }
+
+    void ExportChromeTrace(std::ostream& os) {
+        os << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+        bool first = true;
+        auto separator = [&]() {
+            if (not first) {
+                os << ",\n";
+            }
+            first = false;
+        };
+
+        for (const auto& buffer: detail::GetAllThreadBuffers()) {
+            std::lock_guard lock(buffer->mutex);
+
+            separator();
+            os << std::format(R"({{"ph":"M","pid":0,"tid":{},"name":"thread_name","args":{{"name":)", buffer->threadIndex);
+            detail::WriteJsonString(os, buffer->threadName);
+            os << "}}";
+
+            buffer->forEachEvent([&](const ZoneEvent& event) {
+                separator();
+                os << R"({"ph":"X","pid":0,"tid":)" << buffer->threadIndex << R"(,"name":)";
+                detail::WriteJsonString(os, event.name);
+                os << std::format(R"(,"ts":{:.3f},"dur":{:.3f},"args":{{"depth":{}}}}})",
+                    event.beginNs / 1000.0, (event.endNs - event.beginNs) / 1000.0, event.depth);
+            });
+        }
+        os << "]}\n";
+    }
+
+    std::vector<ZoneSummary> Summarize() {
+        std::unordered_map<std::string_view, std::vector<uint64_t>> durationsByZone;
+        for (const auto& buffer: detail::GetAllThreadBuffers()) {
+            std::lock_guard lock(buffer->mutex);
+            buffer->forEachEvent([&](const ZoneEvent& event) {
+                durationsByZone[event.name].push_back(event.endNs - event.beginNs);
+            });
+        }
+
+        std::vector<std::pair<double, ZoneSummary>> summariesByTotal;
+        for (auto& [name, durations]: durationsByZone) {
+            std::sort(durations.begin(), durations.end());
+            double total = 0.0;
+            for (auto duration: durations) {
+                total += duration;
+            }
+            size_t p99Index = std::min(durations.size() - 1, static_cast<size_t>(std::ceil(durations.size() * 0.99)) - 1);
+            summariesByTotal.emplace_back(total, ZoneSummary {
+                .name = std::string(name),
+                .numSamples = durations.size(),
+                .minMs = durations.front() * 1e-6,
+                .avgMs = total / durations.size() * 1e-6,
+                .p99Ms = durations[p99Index] * 1e-6,
+                .maxMs = durations.back() * 1e-6
+            });
+        }
+        std::sort(summariesByTotal.begin(), summariesByTotal.end(), [](const auto& a, const auto& b) {
+            return a.first > b.first;
+        });
+
+        std::vector<ZoneSummary> result;
+        result.reserve(summariesByTotal.size());
+        for (auto& [total, summary]: summariesByTotal) {
+            result.push_back(std::move(summary));
+        }
+        return result;
+    }
+
+    void Clear() {
+        for (const auto& buffer: detail::GetAllThreadBuffers()) {
+            std::lock_guard lock(buffer->mutex);
+            buffer->numWritten = 0;
+        }
+    }
+
+} // lpg::profiler
@@ -0,0 +1,118 @@
+//
+// Created by volt on 2026-10-19.
+//
+
+
+
+
+#ifndef LPG_ENGINE_SRC_LPG_CORE_PROFILER_HPP_
+#define LPG_ENGINE_SRC_LPG_CORE_PROFILER_HPP_
+
+#include <atomic>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "data.hpp"
+
+/*
+ * Scoped profiler zones. They compile to nothing unless LPG_ENABLE_PROFILER is defined
+ * (CMake option LPG_ENGINE_ENABLE_PROFILER), and can additionally be toggled at runtime with
+ * lpg::profiler::SetEnabled().
+ *
+ * LPG_PROFILE_ZONE takes a string literal. LPG_PROFILE_ZONE_NAMED takes a name obtained from
+ * lpg::profiler::InternZoneName(), for names that are only known at runtime.
+ */
+#ifdef LPG_ENABLE_PROFILER
+#define LPG_PROFILE_ZONE(Name) ::lpg::profiler::ScopedZone LPG_CONCAT(lpg___profile_zone_, __LINE__) {Name}
+#define LPG_PROFILE_ZONE_NAMED(InternedName) ::lpg::profiler::ScopedZone LPG_CONCAT(lpg___profile_zone_, __LINE__) {InternedName}
+#else
+#define LPG_PROFILE_ZONE(Name) ((void)0)
+#define LPG_PROFILE_ZONE_NAMED(InternedName) ((void)0)
+#endif
+
+namespace lpg::profiler {
+
+    static constexpr int ThreadBufferCapacity = 16384;
+
+    struct ZoneEvent {
+        const char* name;
+        uint64_t beginNs;
+        uint64_t endNs;
+        uint32_t depth;
+    };
+
+    struct ZoneSummary {
+        std::string name;
+        uint64_t numSamples;
+        double minMs;
+        double avgMs;
+        double p99Ms;
+        double maxMs;
+    };
+
+    namespace detail {
+        inline std::atomic<bool> Enabled {true};
+
+        uint64_t NowNs();
+        uint32_t PushZone();
+        void PopZone(const char* name, uint64_t beginNs, uint32_t depth);
+    }
+
+    inline bool IsEnabled() {
+        return detail::Enabled.load(std::memory_order_relaxed);
+    }
+
+    void SetEnabled(bool enabled);
+
+    /*
+     * Returns a pointer to a copy of the name that stays valid until the program exits.
+     * Interning the same name twice returns the same pointer.
+     */
+    const char* InternZoneName(std::string_view name);
+
+    void SetThreadName(std::string_view name);
+
+    /*
+     * Writes every recorded zone in the Chrome trace event format (chrome://tracing, Perfetto).
+     */
+    void ExportChromeTrace(std::ostream& os);
+
+    /*
+     * Per-zone statistics over the events currently held in the ring buffers,
+     * i.e. roughly the last ThreadBufferCapacity zones of each thread. Sorted by total time, descending.
+     */
+    std::vector<ZoneSummary> Summarize();
+
+    void Clear();
+
+    class ScopedZone {
+    public:
+        explicit ScopedZone(const char* name) {
+            if (IsEnabled()) {
+                name_ = name;
+                depth_ = detail::PushZone();
+                beginNs_ = detail::NowNs();
+            }
+        }
+
+        ~ScopedZone() {
+            if (name_) {
+                detail::PopZone(name_, beginNs_, depth_);
+            }
+        }
+
+        ScopedZone(const ScopedZone&) = delete;
+        ScopedZone& operator=(const ScopedZone&) = delete;
+
+    private:
+        const char* name_ = nullptr;
+        uint64_t beginNs_ = 0;
+        uint32_t depth_ = 0;
+    };
+
+} // lpg::profiler
+
+#endif //LPG_ENGINE_SRC_LPG_CORE_PROFILER_HPP_
@@ -4,9 +4,293 @@
 
 #include "Registry.hpp"
 
-void lpg::Registry::dump(std::ostream &os) {
-    os << "Registry::dump(" << this << "):" << std::endl;
-    for (const auto& [key, value]: this->storage_) {
-        os << std::format("{} = {}\n", key, DataUnitToStr(value));
+#include <algorithm>
+#include <iterator>
+#include <stdexcept>
+
+namespace lpg {
+
+    static bool DataUnitsEqual(const DataUnit& a, const DataUnit& b) {
+        if (a.index() != b.index()) {
+            return false;
+        }
+        return std::visit([&]<typename T>(const T& valueA) {
+            const auto& valueB = std::get<T>(b);
+            if constexpr(al::VectorType<T>) {
+                for (int i = 0; i < T::NumElements; i++) {
+                    if (valueA[i] != valueB[i]) {
+                        return false;
+                    }
+                }
+                return true;
+            } else {
+                return valueA == valueB;
+            }
+        }, a);
+    }
+
+    bool RegistryValueRange::contains(const DataUnit& value) const {
+        return std::visit([&]<typename T>(const T& v) {
+            if constexpr(al::VectorType<T>) {
+                for (int i = 0; i < T::NumElements; i++) {
+                    if (not (v[i] >= min && v[i] <= max)) {
+                        return false;
+                    }
+                }
+                return true;
+            } else if constexpr(std::is_arithmetic_v<T> && not std::same_as<T, bool>) {
+                return v >= min && v <= max;
+            } else {
+                return true;
+            }
+        }, value);
+    }
+
+    RegistryKeyId RegistrySnapshot::getKeyId(std::string_view key) const {
+        auto it = keys->ids.find(key);
+        return it != keys->ids.end() ? it->second : -1;
+    }
+
+    RegistryKeyId RegistrySnapshot::getKeyId(const RegistryKeyPrefix& prefix, std::string_view suffix) const {
+        auto nameSuffix = [&](RegistryKeyId id) {
+            return std::string_view(keys->names[id]).substr(prefix.prefixSize);
+        };
+        auto first = keys->sortedIds.begin() + prefix.first, last = keys->sortedIds.begin() + prefix.last;
+        auto it = std::partition_point(first, last, [&](RegistryKeyId id) {
+            return nameSuffix(id) < suffix;
+        });
+        return it != last && nameSuffix(*it) == suffix ? *it : -1;
+    }
+
+    RegistryKeyPrefix RegistrySnapshot::getKeyPrefix(const RegistryKeyPrefix& prefix, std::string_view suffix) const {
+        auto nameSuffix = [&](RegistryKeyId id) {
+            return std::string_view(keys->names[id]).substr(prefix.prefixSize);
+        };
+        auto first = keys->sortedIds.begin() + prefix.first, last = keys->sortedIds.begin() + prefix.last;
+        first = std::partition_point(first, last, [&](RegistryKeyId id) {
+            return nameSuffix(id) < suffix;
+        });
+        last = std::partition_point(first, last, [&](RegistryKeyId id) {
+            return nameSuffix(id).starts_with(suffix);
+        });
+        return {
+            .prefixSize = prefix.prefixSize + suffix.size(),
+            .first = static_cast<int>(first - keys->sortedIds.begin()),
+            .last = static_cast<int>(last - keys->sortedIds.begin())
+        };
+    }
+
+    Registry::Registry() {
+        auto initial = std::make_unique<RegistrySnapshot>();
+        initial->version = 0;
+        initial->keys = std::make_shared<detail::RegistryKeys>();
+        current_.store(initial.get(), std::memory_order_release);
+        owned_ = std::move(initial);
+    }
+
+    Registry::~Registry() = default;
+
+    RegistryKeyId Registry::registerValue(const std::string& key, DataUnit defaultValue, RegistryValueRange range) {
+        RegistryValueDeclaration declaration {.key = key, .defaultValue = std::move(defaultValue), .range = range};
+        return registerValues({&declaration, 1}).front();
+    }
+
+    std::vector<RegistryKeyId> Registry::registerValues(std::span<const RegistryValueDeclaration> declarations) {
+        std::lock_guard lock(writerMutex_);
+        const auto& old = *owned_;
+
+        auto keys = std::make_shared<detail::RegistryKeys>(*old.keys);
+        auto snapshot = std::make_unique<RegistrySnapshot>(old);
+        snapshot->version++;
+        keys->names.reserve(keys->names.size() + declarations.size());
+        keys->ranges.reserve(keys->ranges.size() + declarations.size());
+        keys->ids.reserve(keys->ids.size() + declarations.size());
+        snapshot->valueChunks.reserve((snapshot->numValues + declarations.size()) / detail::RegistryValueChunkSize + 1);
+
+        std::vector<RegistryKeyId> ids;
+        ids.reserve(declarations.size());
+        for (const auto& declaration: declarations) {
+            auto id = static_cast<RegistryKeyId>(keys->names.size());
+            if (not keys->ids.emplace(declaration.key, id).second) {
+                throw std::runtime_error("Registry key already registered: " + declaration.key);
+            }
+            keys->names.push_back(declaration.key);
+            keys->ranges.push_back(declaration.range);
+            ids.push_back(id);
+        }
+
+        // the new keys are sorted and merged in, rather than sorting all of them again
+        auto byName = [&](RegistryKeyId a, RegistryKeyId b) {
+            return keys->names[a] < keys->names[b];
+        };
+        std::vector<RegistryKeyId> newSortedIds = ids;
+        std::ranges::sort(newSortedIds, byName);
+        std::vector<RegistryKeyId> sortedIds;
+        sortedIds.reserve(keys->sortedIds.size() + newSortedIds.size());
+        std::ranges::merge(keys->sortedIds, newSortedIds, std::back_inserter(sortedIds), byName);
+        keys->sortedIds = std::move(sortedIds);
+
+        // the last chunk may be shared with the old snapshot
+        detail::RegistryValueChunk* chunk = nullptr;
+        if (snapshot->numValues % detail::RegistryValueChunkSize != 0) {
+            auto copy = std::make_shared<detail::RegistryValueChunk>(*snapshot->valueChunks.back());
+            chunk = copy.get();
+            snapshot->valueChunks.back() = std::move(copy);
+        }
+        for (const auto& declaration: declarations) {
+            if (snapshot->numValues % detail::RegistryValueChunkSize == 0) {
+                auto newChunk = std::make_shared<detail::RegistryValueChunk>();
+                chunk = newChunk.get();
+                snapshot->valueChunks.push_back(std::move(newChunk));
+            }
+            (*chunk)[snapshot->numValues % detail::RegistryValueChunkSize] = declaration.defaultValue;
+            snapshot->numValues++;
+        }
+
+        snapshot->keys = std::move(keys);
+        publishSnapshot(std::move(snapshot));
+        return ids;
+    }
+
+    void Registry::set(RegistryKeyId id, DataUnit value) {
+        std::lock_guard lock(writerMutex_);
+        if (id < 0 || id >= owned_->numValues) {
+            throw std::runtime_error("Registry key id out of range");
+        }
+        if (owned_->value(id).index() != value.index()) {
+            throw std::runtime_error("Registry value type mismatch for " + owned_->keys->names[id]);
+        }
+        if (not owned_->keys->ranges[id].contains(value)) {
+            throw std::runtime_error("Registry value out of range for " + owned_->keys->names[id] + ": " + DataUnitToStr(value));
+        }
+        staged_.emplace_back(id, std::move(value));
+    }
+
+    void Registry::setStaged(std::span<std::pair<RegistryKeyId, DataUnit>> values) {
+        std::lock_guard lock(writerMutex_);
+        staged_.reserve(staged_.size() + values.size());
+        std::ranges::move(values, std::back_inserter(staged_));
+    }
+
+    int Registry::publish() {
+        int numChanged;
+        {
+            std::lock_guard lock(writerMutex_);
+            if (staged_.empty()) {
+                return 0;
+            }
+
+            // shares the chunks of the old snapshot, and copies a chunk when the first value in it changes
+            auto snapshot = std::make_unique<RegistrySnapshot>(*owned_);
+            snapshot->version++;
+            std::vector<detail::RegistryValueChunk*> copiedChunks(snapshot->valueChunks.size());
+            std::vector<RegistryKeyId> changedIds;
+            for (auto& [id, value]: staged_) {
+                if (DataUnitsEqual(snapshot->value(id), value)) {
+                    continue;
+                }
+                size_t chunkIndex = id / detail::RegistryValueChunkSize;
+                auto*& chunk = copiedChunks[chunkIndex];
+                if (not chunk) {
+                    auto copy = std::make_shared<detail::RegistryValueChunk>(*snapshot->valueChunks[chunkIndex]);
+                    chunk = copy.get();
+                    snapshot->valueChunks[chunkIndex] = std::move(copy);
+                }
+                (*chunk)[id % detail::RegistryValueChunkSize] = std::move(value);
+                changedIds.push_back(id);
+            }
+            staged_.clear();
+            if (not std::ranges::is_sorted(changedIds)) {
+                std::ranges::sort(changedIds);
+            }
+            auto [first, last] = std::ranges::unique(changedIds);
+            changedIds.erase(first, last);
+            if (changedIds.empty()) {
+                return 0;
+            }
+
+            // queued under the lock, so that the queue is in version order
+            for (const auto& subscription: subscriptions_) {
+                if (std::ranges::binary_search(changedIds, subscription.keyId)) {
+                    notifications_.push_back(Notification {
+                        .callback = subscription.callback,
+                        .id = subscription.keyId,
+                        .value = snapshot->value(subscription.keyId)
+                    });
+                }
+            }
+            publishSnapshot(std::move(snapshot));
+
+            numChanged = static_cast<int>(changedIds.size());
+            if (delivering_) {
+                return numChanged;
+            }
+            delivering_ = true;
+        }
+
+        deliverNotifications();
+        return numChanged;
+    }
+
+    void Registry::deliverNotifications() {
+        // one thread at a time, outside the lock, so that callbacks may set and publish themselves
+        while (true) {
+            Notification notification;
+            {
+                std::lock_guard lock(writerMutex_);
+                if (notifications_.empty()) {
+                    delivering_ = false;
+                    return;
+                }
+                notification = std::move(notifications_.front());
+                notifications_.pop_front();
+            }
+
+            try {
+                notification.callback(notification.id, notification.value);
+            } catch (...) {
+                std::lock_guard lock(writerMutex_);
+                delivering_ = false;
+                throw;
+            }
+        }
     }
-}
+
+    void Registry::publishSnapshot(std::unique_ptr<RegistrySnapshot> snapshot) {
+        current_.store(snapshot.get(), std::memory_order_release);
+        retired_.push_back(std::move(owned_));
+        owned_ = std::move(snapshot);
+    }
+
+    void Registry::reclaim() {
+        std::lock_guard lock(writerMutex_);
+        retired_.clear();
+    }
+
+    int Registry::subscribe(RegistryKeyId id, Callback callback) {
+        std::lock_guard lock(writerMutex_);
+        int subscriptionId = nextSubscriptionId_++;
+        subscriptions_.push_back(Subscription {
+            .subscriptionId = subscriptionId,
+            .keyId = id,
+            .callback = std::move(callback)
+        });
+        return subscriptionId;
+    }
+
+    void Registry::unsubscribe(int subscriptionId) {
+        std::lock_guard lock(writerMutex_);
+        std::erase_if(subscriptions_, [&](const Subscription& subscription) {
+            return subscription.subscriptionId == subscriptionId;
+        });
+    }
+
+    void Registry::dump(std::ostream &os) {
+        const auto* snapshot = current();
+        os << "Registry::dump(" << this << "):" << std::endl;
+        for (RegistryKeyId id = 0; id < snapshot->numValues; id++) {
+            os << std::format("{} = {}\n", snapshot->keys->names[id], DataUnitToStr(snapshot->value(id)));
+        }
+    }
+
+} // lpg
@@ -5,22 +5,176 @@
 #ifndef LPG_ENGINE_REGISTRY_HPP
 #define LPG_ENGINE_REGISTRY_HPP
 
+#include <array>
+#include <atomic>
 #include <concepts>
+#include <deque>
+#include <format>
+#include <functional>
 #include <iostream>
-
-#include <map>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <span>
 #include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
 #include "../core/data.hpp"
 
 namespace lpg {
 
+    using RegistryKeyId = int32_t;
+
+    /*
+     * Inclusive bounds on numeric values, checked per element for vectors. Bools and strings are always in range.
+     */
+    struct RegistryValueRange {
+        double min = -std::numeric_limits<double>::infinity();
+        double max = std::numeric_limits<double>::infinity();
+
+        [[nodiscard]] bool contains(const DataUnit& value) const;
+    };
+
+    struct RegistryValueDeclaration {
+        std::string key;
+        DataUnit defaultValue;
+        RegistryValueRange range = {};
+    };
+
+    namespace detail {
+        struct RegistryKeyHash {
+            using is_transparent = void;
+            size_t operator()(std::string_view key) const {
+                return std::hash<std::string_view>{}(key);
+            }
+        };
+
+        struct RegistryKeys {
+            std::vector<std::string> names; // indexed by key id
+            std::vector<RegistryValueRange> ranges; // indexed by key id
+            std::unordered_map<std::string, RegistryKeyId, RegistryKeyHash, std::equal_to<>> ids;
+            std::vector<RegistryKeyId> sortedIds; // ordered by name, so that the keys with a prefix are adjacent
+        };
+
+        /*
+         * Snapshots share the chunks of values that did not change, so that publishing a few values
+         * does not copy all of them.
+         */
+        inline constexpr int RegistryValueChunkSize = 256;
+        using RegistryValueChunk = std::array<DataUnit, RegistryValueChunkSize>;
+    }
+
+    /*
+     * The keys that start with a prefix ending in a dot, e.g. "root.videomode." for the keys of a config file section,
+     * as a range of RegistryKeys::sortedIds. Keys under the prefix are then found by comparing only what follows it.
+     */
+    struct RegistryKeyPrefix {
+        size_t prefixSize = 0;
+        int first = 0;
+        int last = 0;
+    };
+
+    /*
+     * An immutable set of registry values. Key ids index values directly.
+     */
+    struct RegistrySnapshot {
+        uint64_t version;
+        std::shared_ptr<const detail::RegistryKeys> keys;
+        std::vector<std::shared_ptr<const detail::RegistryValueChunk>> valueChunks;
+        size_t numValues = 0;
+
+        /*
+         * -1 if there is no such key. Resolve ids once and keep them; they never change.
+         */
+        [[nodiscard]] RegistryKeyId getKeyId(std::string_view key) const;
+
+        /*
+         * The key prefix + suffix, or -1 if there is no such key.
+         */
+        [[nodiscard]] RegistryKeyId getKeyId(const RegistryKeyPrefix& prefix, std::string_view suffix) const;
+
+        /*
+         * All keys, i.e. the empty prefix.
+         */
+        [[nodiscard]] RegistryKeyPrefix getKeyPrefix() const {
+            return {.prefixSize = 0, .first = 0, .last = static_cast<int>(keys->sortedIds.size())};
+        }
+
+        /*
+         * The keys that start with prefix + suffix, where suffix ends in a dot; an empty range if there are none.
+         */
+        [[nodiscard]] RegistryKeyPrefix getKeyPrefix(const RegistryKeyPrefix& prefix, std::string_view suffix) const;
+
+        /*
+         * The id must be in range.
+         */
+        [[nodiscard]] const DataUnit& value(RegistryKeyId id) const {
+            return (*valueChunks[id / detail::RegistryValueChunkSize])[id % detail::RegistryValueChunkSize];
+        }
+
+        /*
+         * nullptr if the id is out of range or the value is not of type T.
+         */
+        template<typename T>
+        [[nodiscard]] const T* get(RegistryKeyId id) const {
+            if (id < 0 || id >= numValues) {
+                return nullptr;
+            }
+            return std::get_if<T>(&value(id));
+        }
+    };
+
+    /*
+     * Configuration values keyed by dotted names, e.g. "root.videomode.depth".
+     *
+     * Readers call current() on any thread and get a consistent snapshot without taking a lock.
+     * Writers stage values with set() and make them visible together with publish(), which swaps in a new
+     * snapshot (read-copy-update). Replaced snapshots are freed by reclaim(), which must only be called
+     * at a quiescent point, when no thread still holds a snapshot pointer - for the engine, after the tick barrier.
+     *
+     * Subscribers are called after the new snapshot is visible, for every key that changed, strictly in version order.
+     * They are called on the publishing thread, unless another thread is already delivering notifications; then that
+     * thread delivers them as well, and publish() may return before they ran. A publish() from within a callback
+     * is delivered after the callback returns. Values registered by reference are kept up to date the same way.
+     */
     class Registry {
     public:
+        using Callback = std::function<void(RegistryKeyId, const DataUnit&)>;
+
+        Registry();
+        ~Registry();
+        Registry(const Registry&) = delete;
+        Registry& operator=(const Registry&) = delete;
+
+        /*
+         * Registers a key with its default value and publishes it. Throws if the key exists.
+         * The default value is not checked against the range.
+         */
+        RegistryKeyId registerValue(const std::string& key, DataUnit defaultValue, RegistryValueRange range = {});
+
+        /*
+         * Registers the keys like registerValue, but copies the current snapshot and publishes only once,
+         * e.g. for the thousands of keys of a mod. Throws and registers none of them if a key exists
+         * or is declared twice. Returns the ids in the order of the declarations.
+         */
+        std::vector<RegistryKeyId> registerValues(std::span<const RegistryValueDeclaration> declarations);
 
+        /*
+         * Registers a key whose default is the current value of the variable. The variable is updated
+         * on every publish() that changes the key, on the publishing thread, and must outlive the Registry.
+         */
         template<std::convertible_to<DataUnit> T>
             requires (not std::is_aggregate_v<T>)
-        void registerValue(const std::string& key, T& value) {
-            storage_[key] = PtrToDataUnit(&value);
+        void registerValue(const std::string& key, T& value, RegistryValueRange range = {}) {
+            RegistryKeyId id = registerValue(key, DataUnit(value), range);
+            subscribe(id, [&value](RegistryKeyId, const DataUnit& newValue) {
+                std::visit([&]<typename V>(const V& v) {
+                    if constexpr(std::is_convertible_v<const V&, T>) {
+                        value = static_cast<T>(v);
+                    }
+                }, newValue);
+            });
         }
 
         template<typename T>
@@ -29,14 +183,86 @@ namespace lpg {
             refl::for_each_decl<T>([&](auto I) {
                 std::string subkey = std::format("{}.{}", key, refl::member_name<I, T>());
                 auto& subvalue = refl::get<I, T&>(value);
-                registerValue(subkey, subvalue);
+                if constexpr(std::is_aggregate_v<std::remove_cvref_t<decltype(subvalue)>>) {
+                    registerValue(subkey, subvalue);
+                } else {
+                    RegistryValueRange range;
+                    if constexpr(refl::has_member_attr<MinValue, I, T>()) {
+                        range.min = refl::member_attr<MinValue, I, T>().val;
+                    }
+                    if constexpr(refl::has_member_attr<MaxValue, I, T>()) {
+                        range.max = refl::member_attr<MaxValue, I, T>().val;
+                    }
+                    registerValue(subkey, subvalue, range);
+                }
             });
         }
 
+        /*
+         * Never null. Valid until the next reclaim().
+         */
+        [[nodiscard]] const RegistrySnapshot* current() const {
+            return current_.load(std::memory_order_acquire);
+        }
+
+        [[nodiscard]] RegistryKeyId getKeyId(std::string_view key) const {
+            return current()->getKeyId(key);
+        }
+
+        /*
+         * Stages a new value; throws if the key does not exist, the value has a different type or is out of range.
+         * Staged values become visible at the next publish().
+         */
+        void set(RegistryKeyId id, DataUnit value);
+
+        /*
+         * Stages values like set(), under one lock and without checking them, for values whose type and range
+         * the caller already checked against current(), e.g. LoadConfig. Moves from the values.
+         */
+        void setStaged(std::span<std::pair<RegistryKeyId, DataUnit>> values);
+
+        /*
+         * Returns the number of keys whose value changed.
+         */
+        int publish();
+
+        /*
+         * Frees replaced snapshots. Only call it when no thread holds a pointer obtained from current().
+         * A World the registry is attached to (World::setRegistry) calls it at every tick barrier.
+         */
+        void reclaim();
+
+        int subscribe(RegistryKeyId id, Callback callback);
+        void unsubscribe(int subscriptionId);
+
         void dump(std::ostream& os);
 
     private:
-        std::map<std::string, PtrToDataUnit> storage_;
+        struct Subscription {
+            int subscriptionId;
+            RegistryKeyId keyId;
+            Callback callback;
+        };
+
+        struct Notification {
+            Callback callback;
+            RegistryKeyId id;
+            DataUnit value;
+        };
+
+        void publishSnapshot(std::unique_ptr<RegistrySnapshot> snapshot);
+        void deliverNotifications();
+
+        std::atomic<const RegistrySnapshot*> current_;
+
+        std::mutex writerMutex_;
+        std::unique_ptr<const RegistrySnapshot> owned_; // the snapshot current_ points to
+        std::vector<std::unique_ptr<const RegistrySnapshot>> retired_;
+        std::vector<std::pair<RegistryKeyId, DataUnit>> staged_;
+        std::vector<Subscription> subscriptions_;
+        int nextSubscriptionId_ = 0;
+        std::deque<Notification> notifications_; // in version order
+        bool delivering_ = false; // a thread is draining notifications_
     };
 
 
@@ -0,0 +1,235 @@
+//
+// Created by volt on 2026-10-19.
+//
+
+
+
+
+#ifndef LPG_ENGINE_SRC_LPG_CORE_STATICWORLD_HPP_
+#define LPG_ENGINE_SRC_LPG_CORE_STATICWORLD_HPP_
+
+#include <cstdint>
+#include <memory>
+#include <set>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "EntityPage.hpp"
+#include "entity.hpp"
+#include "message.hpp"
+
+namespace lpg {
+
+    namespace detail {
+        template<typename T, typename... Ts>
+        inline constexpr int IndexOfType() {
+            constexpr bool matches[] = {std::is_same_v<T, Ts>..., false};
+            for (int i = 0; i < sizeof...(Ts); i++) {
+                if (matches[i]) {
+                    return i;
+                }
+            }
+            return -1;
+        }
+    }
+
+    /*
+     * A World whose set of entity types is closed and known at compile time, e.g. for shipping builds:
+     *
+     * using GameWorld = lpg::StaticWorld<Player, Enemy, Projectile>;
+     *
+     * It uses the same pages and entity descriptors as World, but entity type ids are constexpr indices
+     * into the type list, each type's page lists are a tuple member and entity operations are direct calls
+     * that the compiler can inline, including message handlers. No EntityInterface is needed.
+     *
+     * Embedded components are not indexed separately; query the owner type instead.
+     */
+    template<typename... TEntities>
+    class StaticWorld {
+    public:
+        static_assert(sizeof...(TEntities) > 0, "StaticWorld needs at least one entity type");
+
+        template<typename TEntity>
+        static constexpr int EntityTypeId = detail::IndexOfType<TEntity, TEntities...>();
+
+        StaticWorld() = default;
+        StaticWorld(const StaticWorld&) = delete;
+        StaticWorld& operator=(const StaticWorld&) = delete;
+
+        ~StaticWorld() {
+            for (auto& page: pages_) {
+                visitEntityType(page.entityTypeId, [&]<typename TEntity>() {
+                    if constexpr(not std::is_trivially_destructible_v<TEntity>) {
+                        for (auto [beg, end]: page.getActiveRanges()) {
+                            auto* first = static_cast<TEntity*>(page.entityPtr(beg));
+                            std::destroy(first, first + (end - beg));
+                        }
+                    }
+                });
+            }
+        }
+
+        template<typename TEntity>
+        EntityDescriptor spawnEntity(auto&&... args) {
+            static_assert(EntityTypeId<TEntity> >= 0, "entity type is not part of this StaticWorld");
+            auto& storage = std::get<EntityTypeId<TEntity>>(storage_);
+
+            int32_t pageId = storage.freePages.empty() ? createNewPage<TEntity>() : *storage.freePages.begin();
+            auto& page = pages_[pageId];
+            auto reserveResult = page.reserveEntity().value();
+            if (page.isFull()) {
+                storage.freePages.erase(pageId);
+            }
+
+            if constexpr(requires{TEntity{std::forward<decltype(args)>(args)...};}) {
+                new (reserveResult.entity) TEntity{std::forward<decltype(args)>(args)...};
+            } else {
+                new (reserveResult.entity) TEntity(std::forward<decltype(args)>(args)...);
+            }
+            return static_cast<EntityDescriptor>(pageId * detail::EntityPageSize + reserveResult.offset);
+        }
+
+        bool despawnEntity(EntityDescriptor entityDescriptor) {
+            auto [pageNum, offset] = DecomposeEntityDescriptor(entityDescriptor);
+            if (pageNum >= pages_.size()) {
+                return false;
+            }
+            auto& page = pages_[pageNum];
+            if (not page.isEntityPresent(offset)) {
+                return false;
+            }
+
+            visitEntityType(page.entityTypeId, [&]<typename TEntity>() {
+                auto* entity = static_cast<TEntity*>(page.entityPtr(offset));
+                PreKillMessage preKillMessage {.descriptor = entityDescriptor};
+                if constexpr(requires{entity->msg(&preKillMessage);}) {
+                    entity->msg(&preKillMessage);
+                }
+                std::destroy_at(entity);
+                std::get<EntityTypeId<TEntity>>(storage_).freePages.insert(page.pageId);
+            });
+            page.releaseEntity(offset);
+            return true;
+        }
+
+        /*
+         * Returns nullptr if the descriptor does not refer to a live entity of type TEntity.
+         */
+        template<typename TEntity>
+        TEntity* get(EntityDescriptor entityDescriptor) {
+            auto [pageNum, offset] = DecomposeEntityDescriptor(entityDescriptor);
+            if (pageNum >= pages_.size()) {
+                return nullptr;
+            }
+            auto& page = pages_[pageNum];
+            if (page.entityTypeId != EntityTypeId<TEntity> || not page.isEntityPresent(offset)) {
+                return nullptr;
+            }
+            return static_cast<TEntity*>(page.entityPtr(offset));
+        }
+
+        template<typename TEntity, typename TFunc>
+        void forEachEntity(TFunc&& func) {
+            for (auto pageId: std::get<EntityTypeId<TEntity>>(storage_).pages) {
+                auto& page = pages_[pageId];
+                for (auto [beg, end]: page.getActiveRanges()) {
+                    auto* first = static_cast<TEntity*>(page.entityPtr(beg));
+                    for (auto* entity = first; entity != first + (end - beg); ++entity) {
+                        func(*entity);
+                    }
+                }
+            }
+        }
+
+        template<typename TEntity, typename TMessage>
+        void sendMessageToAll(TMessage& message) {
+            if constexpr(requires(TEntity& entity){entity.msg(&message);}) {
+                forEachEntity<TEntity>([&](TEntity& entity) {
+                    entity.msg(&message);
+                });
+            }
+        }
+
+        /*
+         * Sends the message to every entity of every type that handles it.
+         */
+        template<typename TMessage>
+        void sendMessageToAll(TMessage& message) {
+            (sendMessageToAll<TEntities>(message), ...);
+        }
+
+        template<typename TMessage>
+        bool sendMessage(EntityDescriptor entityDescriptor, TMessage& message) {
+            auto [pageNum, offset] = DecomposeEntityDescriptor(entityDescriptor);
+            if (pageNum >= pages_.size() || not pages_[pageNum].isEntityPresent(offset)) {
+                return false;
+            }
+            auto& page = pages_[pageNum];
+            bool handled = false;
+            visitEntityType(page.entityTypeId, [&]<typename TEntity>() {
+                if constexpr(requires(TEntity& entity){entity.msg(&message);}) {
+                    static_cast<TEntity*>(page.entityPtr(offset))->msg(&message);
+                    handled = true;
+                }
+            });
+            return handled;
+        }
+
+        template<typename TEntity>
+        [[nodiscard]] size_t numEntities() const {
+            size_t result = 0;
+            for (auto pageId: std::get<EntityTypeId<TEntity>>(storage_).pages) {
+                result += pages_[pageId].numActiveEntities();
+            }
+            return result;
+        }
+
+    private:
+        template<typename TEntity>
+        struct TypeStorage {
+            std::vector<int32_t> pages;
+            std::set<int32_t> freePages;
+        };
+
+        /*
+         * Calls func.template operator()<TEntity>() for the entity type with the given id.
+         * The fold compiles to a jump table or a short compare chain.
+         */
+        template<typename TFunc>
+        static void visitEntityType(int32_t entityTypeId, TFunc&& func) {
+            [&]<size_t... Is>(std::index_sequence<Is...>) {
+                ((entityTypeId == static_cast<int32_t>(Is)
+                    ? (func.template operator()<TEntities>(), true)
+                    : false) || ...);
+            }(std::index_sequence_for<TEntities...>{});
+        }
+
+        template<typename TEntity>
+        int32_t createNewPage() {
+            auto newPageId = static_cast<int32_t>(pages_.size());
+            auto& storage = std::get<EntityTypeId<TEntity>>(storage_);
+            storage.pages.push_back(newPageId);
+            storage.freePages.insert(newPageId);
+
+            auto& page = pages_.emplace_back();
+            page.entityTypeId = EntityTypeId<TEntity>;
+            page.pageId = newPageId;
+            page.parentPage = -1;
+            page.stride = sizeof(TEntity);
+            page.currentSize = 0;
+            page.occupancy = {};
+            // reserving up front keeps entity addresses stable while the page fills up
+            page.storage.reserve(detail::EntityPageSize * sizeof(TEntity));
+            return newPageId;
+        }
+
+        std::vector<detail::EntityPage> pages_;
+        std::tuple<TypeStorage<TEntities>...> storage_;
+    };
+
+} // lpg
+
+#endif //LPG_ENGINE_SRC_LPG_CORE_STATICWORLD_HPP_
@@ -6,6 +6,9 @@
 #define LPG_ENGINE_SYSTEMCOUNTER_HPP
 
 #include <reflect>
+#include <array>
+#include <cstdint>
+#include <utility>
 
 namespace lpg {
 
@@ -41,18 +44,61 @@ namespace lpg {
     static_assert(SysFreqToDivision(SysFreq::Div0029_12Hz41) == 29);
     static_assert(SysFreqToDivision(SysFreq::Div8201_22sec78) == 8201);
 
+    inline constexpr auto SysFreqDivisions = []() {
+        std::array<int, std::to_underlying(SysFreq::MAX)> result {};
+        for (int i=0; i<result.size(); ++i) {
+            result[i] = SysFreqToDivision(static_cast<SysFreq>(i));
+        }
+        return result;
+    }();
+
+    inline constexpr int GetSysFreqDivision(SysFreq freq) {
+        return SysFreqDivisions[std::to_underlying(freq)];
+    }
+
+    inline constexpr double GetSysFreqPeriod(SysFreq freq) {
+        return GetSysFreqDivision(freq) / MasterSystemFrequency;
+    }
+
+    /*
+     * Keeps one wrapping counter per SysFreq, all driven by the master clock.
+     * A system with frequency F and phase P is due on every master tick on which the counter of F equals P.
+     */
     class SystemCounters {
     public:
 
+        void advance() {
+            advanceCounters();
+            ++tick_;
+        }
+
+        void reset() {
+            counters = {};
+            tick_ = 0;
+        }
 
+        [[nodiscard]] int getCounter(SysFreq freq) const {
+            return counters[std::to_underlying(freq)];
+        }
 
+        [[nodiscard]] bool isDue(SysFreq freq, int phase = 0) const {
+            return getCounter(freq) == phase;
+        }
+
+        [[nodiscard]] uint64_t getTick() const {
+            return tick_;
+        }
 
     private:
 
         std::array<int, std::to_underlying(SysFreq::MAX)> counters {};
+        uint64_t tick_ = 0;
+
         void advanceCounters() {
             for (int i=0; i<counters.size(); ++i) {
-                counters[i] = (counters[i] + 1) % SysFreqToDivision(static_cast<SysFreq>(i));
+                if (++counters[i] == SysFreqDivisions[i]) {
+                    counters[i] = 0;
+                }
             }
         }
     };
@@ -0,0 +1,451 @@
+//
+// Created by volt on 2026-10-19.
+//
+
+
+
+
+#include "SystemScheduler.hpp"
+#include "Profiler.hpp"
+#include "util.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <exception>
+#include <latch>
+#include <limits>
+#include <mutex>
+#include <numeric>
+#include <stdexcept>
+
+namespace lpg {
+
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr double CostSmoothingFactor = 0.05;
+
+    static double SecondsBetween(Clock::time_point begin, Clock::time_point end) {
+        return std::chrono::duration<double>(end - begin).count();
+    }
+
+    static bool IntersectsSorted(const std::vector<int32_t>& a, const std::vector<int32_t>& b) {
+        auto itA = a.begin();
+        auto itB = b.begin();
+        while (itA != a.end() && itB != b.end()) {
+            if (*itA == *itB) {
+                return true;
+            }
+            (*itA < *itB) ? ++itA : ++itB;
+        }
+        return false;
+    }
+
+    static void SortUnique(std::vector<int32_t>& vec) {
+        std::sort(vec.begin(), vec.end());
+        vec.erase(std::unique(vec.begin(), vec.end()), vec.end());
+    }
+
+    bool SystemAccess::conflictsWith(const SystemAccess& other) const {
+        if (exclusive || other.exclusive) {
+            return true;
+        }
+        return IntersectsSorted(writes, other.writes)
+            || IntersectsSorted(writes, other.reads)
+            || IntersectsSorted(reads, other.writes);
+    }
+
+    int SystemScheduler::addSystem(const std::string& name, SysFreq freq, SystemFn fn, SystemAccess access, std::optional<SysFreq> minFreq) {
+        if (minFreq && *minFreq < freq) {
+            throw std::runtime_error("Minimum frequency of system " + name + " is higher than its nominal frequency");
+        }
+
+        for (const auto& system: systems_) {
+            if (system.info.name == name) {
+                throw std::runtime_error("System already registered: " + name);
+            }
+        }
+
+        std::vector<int> placedIds(systems_.size());
+        std::iota(placedIds.begin(), placedIds.end(), 0);
+
+        int systemId = static_cast<int>(systems_.size());
+        systems_.push_back(SystemEntry {
+            .info = SystemInfo {
+                .name = name,
+                .freq = freq,
+                .nominalFreq = freq,
+                .minFreq = minFreq.value_or(freq),
+                .phase = choosePhase(freq, placedIds),
+                .stats = {}
+            },
+            .fn = std::move(fn),
+            .declaredAccess = access,
+            .access = widenAccess(access),
+            .profileZoneName = profiler::InternZoneName(name),
+            .lastRunTick = std::nullopt
+        });
+        return systemId;
+    }
+
+    void SystemScheduler::setFrameBudget(double frameBudget) {
+        frameBudget_ = frameBudget;
+        numOverloadedFrames_ = 0;
+        numHeadroomFrames_ = 0;
+    }
+
+    void SystemScheduler::setThreadPool(std::shared_ptr<ThreadPool> threadPool) {
+        threadPool_ = std::move(threadPool);
+    }
+
+    ThreadPool* SystemScheduler::getThreadPool() const {
+        return threadPool_.get();
+    }
+
+    void SystemScheduler::setBarrierCallback(std::function<void()> callback) {
+        barrierCallback_ = std::move(callback);
+    }
+
+    void SystemScheduler::setContainingEntityTypes(std::vector<std::vector<int32_t>> containingTypes) {
+        containingTypes_ = std::move(containingTypes);
+        for (auto& system: systems_) {
+            system.access = widenAccess(system.declaredAccess);
+        }
+    }
+
+    int SystemScheduler::advance(double realDeltaTime) {
+        static constexpr double MasterPeriod = 1.0 / MasterSystemFrequency;
+
+        auto frameBegin = Clock::now();
+
+        timeAccumulator_ += realDeltaTime;
+        int numTicks = 0;
+        while (timeAccumulator_ >= MasterPeriod) {
+            if (numTicks == MaxTicksPerAdvance) {
+                timeAccumulator_ = 0.0;
+                break;
+            }
+            runTick();
+            timeAccumulator_ -= MasterPeriod;
+            ++numTicks;
+        }
+
+        if (frameBudget_ > 0.0) {
+            adaptFrequencies(SecondsBetween(frameBegin, Clock::now()));
+        }
+        return numTicks;
+    }
+
+    void SystemScheduler::runTick() {
+        LPG_PROFILE_ZONE("SystemScheduler::runTick");
+        auto tickBegin = Clock::now();
+
+        std::vector<int> dueSystemIds;
+        for (int i = 0; i < systems_.size(); i++) {
+            if (counters_.isDue(systems_[i].info.freq, systems_[i].info.phase)) {
+                dueSystemIds.push_back(i);
+            }
+        }
+
+        if (threadPool_ && dueSystemIds.size() > 1) {
+            runSystemsParallel(dueSystemIds);
+        } else {
+            for (int id: dueSystemIds) {
+                runSystem(systems_[id]);
+            }
+        }
+
+        if (barrierCallback_) {
+            LPG_PROFILE_ZONE("SystemScheduler::barrier");
+            barrierCallback_();
+        }
+
+        recordTickCost(SecondsBetween(tickBegin, Clock::now()));
+        counters_.advance();
+    }
+
+    void SystemScheduler::runSystem(SystemEntry& system) {
+        LPG_PROFILE_ZONE_NAMED(system.profileZoneName);
+
+        uint64_t tick = counters_.getTick();
+        double deltaTime = GetSysFreqPeriod(system.info.freq);
+        if (system.lastRunTick) {
+            deltaTime = (tick - *system.lastRunTick) / MasterSystemFrequency;
+        }
+        system.lastRunTick = tick;
+
+        FixedUpdateMessage message {.deltaTime = deltaTime};
+
+        auto begin = Clock::now();
+        system.fn(message);
+        recordSystemCost(system, SecondsBetween(begin, Clock::now()));
+    }
+
+    void SystemScheduler::runSystemsParallel(std::span<const int> dueSystemIds) {
+        int numSystems = static_cast<int>(dueSystemIds.size());
+
+        std::vector<std::vector<int>> dependents(numSystems);
+        std::vector<std::atomic<int>> numPendingDependencies(numSystems);
+        for (int j = 0; j < numSystems; j++) {
+            const auto& accessJ = systems_[dueSystemIds[j]].access;
+            for (int i = 0; i < j; i++) {
+                if (systems_[dueSystemIds[i]].access.conflictsWith(accessJ)) {
+                    dependents[i].push_back(j);
+                    numPendingDependencies[j].fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+        }
+
+        std::latch allDone(numSystems);
+        std::mutex errorMutex;
+        std::exception_ptr firstError;
+
+        std::function<void(int)> launch = [&](int node) {
+            threadPool_->submit([&, node]() {
+                try {
+                    runSystem(systems_[dueSystemIds[node]]);
+                } catch (...) {
+                    std::lock_guard lock(errorMutex);
+                    if (not firstError) {
+                        firstError = std::current_exception();
+                    }
+                }
+                for (int dependent: dependents[node]) {
+                    if (numPendingDependencies[dependent].fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                        launch(dependent);
+                    }
+                }
+                allDone.count_down();
+            });
+        };
+
+        std::vector<int> initiallyReady;
+        for (int node = 0; node < numSystems; node++) {
+            if (numPendingDependencies[node].load(std::memory_order_relaxed) == 0) {
+                initiallyReady.push_back(node);
+            }
+        }
+        for (int node: initiallyReady) {
+            launch(node);
+        }
+        allDone.wait();
+
+        if (firstError) {
+            std::rethrow_exception(firstError);
+        }
+    }
+
+    void SystemScheduler::adaptFrequencies(double frameCost) {
+        if (frameCost > frameBudget_) {
+            numHeadroomFrames_ = 0;
+            if (++numOverloadedFrames_ >= OverloadFramesToDemote) {
+                demoteOneSystem();
+                numOverloadedFrames_ = 0;
+            }
+        } else if (frameCost < frameBudget_ * HeadroomFraction) {
+            numOverloadedFrames_ = 0;
+            if (++numHeadroomFrames_ >= HeadroomFramesToPromote) {
+                promoteOneSystem();
+                numHeadroomFrames_ = 0;
+            }
+        } else {
+            numOverloadedFrames_ = 0;
+            numHeadroomFrames_ = 0;
+        }
+    }
+
+    static SysFreq NextSlowerFreq(SysFreq freq) {
+        return static_cast<SysFreq>(std::to_underlying(freq) + 1);
+    }
+
+    static SysFreq NextFasterFreq(SysFreq freq) {
+        return static_cast<SysFreq>(std::to_underlying(freq) - 1);
+    }
+
+    bool SystemScheduler::demoteOneSystem() {
+        int bestId = -1;
+        double bestCostRate = 0.0;
+        for (int i = 0; i < systems_.size(); i++) {
+            const auto& info = systems_[i].info;
+            if (info.freq >= info.minFreq) {
+                continue;
+            }
+            double costRate = getSystemWeight(systems_[i]) / GetSysFreqPeriod(info.freq);
+            if (bestId == -1 || costRate > bestCostRate) {
+                bestId = i;
+                bestCostRate = costRate;
+            }
+        }
+        if (bestId == -1) {
+            return false;
+        }
+        changeSystemFrequency(bestId, NextSlowerFreq(systems_[bestId].info.freq));
+        return true;
+    }
+
+    bool SystemScheduler::promoteOneSystem() {
+        int bestId = -1;
+        double bestAddedCostRate = 0.0;
+        for (int i = 0; i < systems_.size(); i++) {
+            const auto& info = systems_[i].info;
+            if (info.freq <= info.nominalFreq) {
+                continue;
+            }
+            double weight = getSystemWeight(systems_[i]);
+            double addedCostRate = weight / GetSysFreqPeriod(NextFasterFreq(info.freq)) - weight / GetSysFreqPeriod(info.freq);
+            if (bestId == -1 || addedCostRate < bestAddedCostRate) {
+                bestId = i;
+                bestAddedCostRate = addedCostRate;
+            }
+        }
+        if (bestId == -1) {
+            return false;
+        }
+        changeSystemFrequency(bestId, NextFasterFreq(systems_[bestId].info.freq));
+        return true;
+    }
+
+    void SystemScheduler::changeSystemFrequency(int systemId, SysFreq newFreq) {
+        std::vector<int> otherIds;
+        for (int i = 0; i < systems_.size(); i++) {
+            if (i != systemId) {
+                otherIds.push_back(i);
+            }
+        }
+        auto& info = systems_[systemId].info;
+        info.freq = newFreq;
+        info.phase = choosePhase(newFreq, otherIds);
+    }
+
+    SystemAccess SystemScheduler::widenAccess(const SystemAccess& access) const {
+        SystemAccess result = access;
+        auto widen = [this](std::vector<int32_t>& typeIds) {
+            int numDeclared = static_cast<int>(typeIds.size());
+            for (int i = 0; i < numDeclared; i++) {
+                if (auto* containing = vec::TryGet(containingTypes_, typeIds[i])) {
+                    typeIds.insert(typeIds.end(), containing->begin(), containing->end());
+                }
+            }
+            SortUnique(typeIds);
+        };
+        widen(result.reads);
+        widen(result.writes);
+        return result;
+    }
+
+    void SystemScheduler::rebalancePhases() {
+        std::vector<int> order(systems_.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [this](int a, int b) {
+            return getSystemWeight(systems_[a]) > getSystemWeight(systems_[b]);
+        });
+
+        for (int i = 0; i < order.size(); i++) {
+            auto& info = systems_[order[i]].info;
+            info.phase = choosePhase(info.freq, std::span{order}.first(i));
+        }
+    }
+
+    const SystemInfo& SystemScheduler::getSystemInfo(int systemId) const {
+        return systems_.at(systemId).info;
+    }
+
+    int SystemScheduler::getNumSystems() const {
+        return static_cast<int>(systems_.size());
+    }
+
+    uint64_t SystemScheduler::getTick() const {
+        return counters_.getTick();
+    }
+
+    std::vector<double> SystemScheduler::getTickCostHistory() const {
+        std::vector<double> result;
+        result.reserve(numTicksRecorded_);
+        int firstPos = (tickCostHistoryPos_ - numTicksRecorded_ + TickHistorySize) % TickHistorySize;
+        for (int i = 0; i < numTicksRecorded_; i++) {
+            result.push_back(tickCostHistory_[(firstPos + i) % TickHistorySize]);
+        }
+        return result;
+    }
+
+    TickLoadSummary SystemScheduler::getTickLoadSummary() const {
+        TickLoadSummary result {};
+        if (numTicksRecorded_ == 0) {
+            return result;
+        }
+        double sum = 0.0;
+        for (double cost: getTickCostHistory()) {
+            sum += cost;
+            result.maxCost = std::max(result.maxCost, cost);
+        }
+        result.numTicks = numTicksRecorded_;
+        result.meanCost = sum / numTicksRecorded_;
+        result.peakToMean = (result.meanCost > 0.0) ? result.maxCost / result.meanCost : 0.0;
+        return result;
+    }
+
+    double SystemScheduler::getSystemWeight(const SystemEntry& system) const {
+        if (system.info.stats.numRuns == 0) {
+            return DefaultSystemCostEstimate;
+        }
+        return system.info.stats.avgCost;
+    }
+
+    /*
+     * Picks the phase with the least total weight of same-frequency systems.
+     * Ties are broken by the weight of all systems due on the tick equal to the candidate phase,
+     * which keeps the first occurrences of low-rate systems from piling up on tick 0.
+     */
+    int SystemScheduler::choosePhase(SysFreq freq, std::span<const int> placedSystemIds) const {
+        int division = GetSysFreqDivision(freq);
+        if (division == 1) {
+            return 0;
+        }
+
+        std::vector<double> sameFreqLoad(division, 0.0);
+        for (int id: placedSystemIds) {
+            const auto& system = systems_[id];
+            if (system.info.freq == freq) {
+                sameFreqLoad[system.info.phase] += getSystemWeight(system);
+            }
+        }
+
+        int bestPhase = 0;
+        double bestLoad = std::numeric_limits<double>::infinity();
+        double bestTickLoad = std::numeric_limits<double>::infinity();
+        for (int phase = 0; phase < division; phase++) {
+            if (sameFreqLoad[phase] > bestLoad) {
+                continue;
+            }
+            double tickLoad = 0.0;
+            for (int id: placedSystemIds) {
+                const auto& system = systems_[id];
+                if (phase % GetSysFreqDivision(system.info.freq) == system.info.phase) {
+                    tickLoad += getSystemWeight(system);
+                }
+            }
+            if (sameFreqLoad[phase] < bestLoad || tickLoad < bestTickLoad) {
+                bestPhase = phase;
+                bestLoad = sameFreqLoad[phase];
+                bestTickLoad = tickLoad;
+            }
+        }
+        return bestPhase;
+    }
+
+    void SystemScheduler::recordSystemCost(SystemEntry& system, double cost) {
+        auto& stats = system.info.stats;
+        stats.lastCost = cost;
+        stats.maxCost = std::max(stats.maxCost, cost);
+        stats.avgCost = (stats.numRuns == 0) ? cost : std::lerp(stats.avgCost, cost, CostSmoothingFactor);
+        ++stats.numRuns;
+    }
+
+    void SystemScheduler::recordTickCost(double cost) {
+        tickCostHistory_[tickCostHistoryPos_] = cost;
+        tickCostHistoryPos_ = (tickCostHistoryPos_ + 1) % TickHistorySize;
+        numTicksRecorded_ = std::min(numTicksRecorded_ + 1, TickHistorySize);
+    }
+
+} // lpg
@@ -0,0 +1,244 @@
+//
+// Created by volt on 2026-10-19.
+//
+
+
+
+
+#ifndef LPG_ENGINE_SRC_LPG_CORE_SYSTEMSCHEDULER_HPP_
+#define LPG_ENGINE_SRC_LPG_CORE_SYSTEMSCHEDULER_HPP_
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "SysCounter.hpp"
+#include "entity.hpp"
+#include "message.hpp"
+#include "../util/ThreadPool.hpp"
+
+namespace lpg {
+
+    struct SystemCostStats {
+        double lastCost = 0.0;
+        double avgCost = 0.0; // exponential moving average, in seconds
+        double maxCost = 0.0;
+        uint64_t numRuns = 0;
+    };
+
+    /*
+     * Declares the entity types a system iterates over. Types qualified with const are only read:
+     *
+     * struct AISystem {
+     *     using Queries = lpg::Query<const Character, PointLightEntity>;
+     *     void exec(double deltaTime);
+     * };
+     *
+     * Several queries may be combined with std::tuple<Query<...>, Query<...>>.
+     */
+    template<typename... TEntities>
+    struct Query {
+        using LPGSystemQueryTag = void;
+    };
+
+    /*
+     * Entity type ids read and written by a system. Systems that declare nothing are exclusive
+     * and never run alongside any other system.
+     */
+    struct SystemAccess {
+        std::vector<int32_t> reads;
+        std::vector<int32_t> writes;
+        bool exclusive = true;
+
+        [[nodiscard]] bool conflictsWith(const SystemAccess& other) const;
+    };
+
+    struct SystemInfo {
+        std::string name;
+        SysFreq freq; // current frequency, possibly demoted under load
+        SysFreq nominalFreq;
+        SysFreq minFreq; // slowest frequency the system may be demoted to
+        int phase;
+        SystemCostStats stats;
+    };
+
+    struct TickLoadSummary {
+        double meanCost = 0.0;
+        double maxCost = 0.0;
+        double peakToMean = 0.0;
+        int numTicks = 0;
+    };
+
+    namespace detail {
+
+        template<typename TEntity>
+        void AppendQueryAccess(SystemAccess& access) {
+            int32_t entityTypeId = GetEntityTypeId<std::remove_const_t<TEntity>>();
+            if constexpr(std::is_const_v<TEntity>) {
+                access.reads.push_back(entityTypeId);
+            } else {
+                access.writes.push_back(entityTypeId);
+            }
+        }
+
+        template<typename... TEntities>
+        void AppendQueryAccess(SystemAccess& access, Query<TEntities...>*) {
+            (AppendQueryAccess<TEntities>(access), ...);
+        }
+
+        template<typename... TQueries>
+        void AppendQueryAccess(SystemAccess& access, std::tuple<TQueries...>*) {
+            (AppendQueryAccess(access, static_cast<TQueries*>(nullptr)), ...);
+        }
+
+        template<typename TSystem>
+        SystemAccess DeriveSystemAccess() {
+            SystemAccess result {};
+            if constexpr(requires{typename TSystem::Queries;}) {
+                result.exclusive = false;
+                AppendQueryAccess(result, static_cast<typename TSystem::Queries*>(nullptr));
+            }
+            return result;
+        }
+
+        template<typename TSystem>
+        void InvokeSystem(TSystem& system, FixedUpdateMessage& message) {
+            if constexpr(requires{system.msg(&message);}) {
+                system.msg(&message);
+            } else if constexpr(requires{system.exec(message.deltaTime);}) {
+                system.exec(message.deltaTime);
+            } else if constexpr(std::invocable<TSystem&, double>) {
+                system(message.deltaTime);
+            } else {
+                static_assert(sizeof(TSystem) == 0, "A system must provide msg(FixedUpdateMessage*), exec(double) or operator()(double)");
+            }
+        }
+
+    }
+
+    /*
+     * Runs registered systems on the 360 Hz master clock. Each system runs once every
+     * SysFreqToDivision(freq) master ticks, on the tick on which its counter equals its phase.
+     *
+     * Since all divisions are coprime, two systems of different frequencies coincide at the same rate
+     * no matter how they are phased. Phases therefore only matter among systems that share a frequency,
+     * and that is where the scheduler spreads them out, weighted by their cost.
+     *
+     * When a thread pool is attached, the systems due on a tick are ordered into a dependency graph:
+     * a system depends on every earlier-registered due system whose SystemAccess conflicts with its own.
+     * Systems with no unfinished dependencies run concurrently on the pool.
+     * The barrier callback runs on the calling thread after every tick, once all systems have finished.
+     *
+     * With a frame budget set, advance() is treated as one frame. After OverloadFramesToDemote consecutive
+     * frames over budget, the system with the highest cost per second that is still above its minFreq is moved
+     * one step down the SysFreq ladder. After HeadroomFramesToPromote consecutive frames below
+     * HeadroomFraction of the budget, the demoted system that is cheapest to promote moves one step back up.
+     * FixedUpdateMessage::deltaTime is always the simulated time elapsed since the system's previous run.
+     */
+    class SystemScheduler {
+    public:
+        using SystemFn = std::function<void(FixedUpdateMessage&)>;
+
+        static constexpr int TickHistorySize = 4096;
+        static constexpr int MaxTicksPerAdvance = 36;
+        static constexpr double DefaultSystemCostEstimate = 1e-4;
+        static constexpr int OverloadFramesToDemote = 8;
+        static constexpr int HeadroomFramesToPromote = 120;
+        static constexpr double HeadroomFraction = 0.6;
+
+        /*
+         * minFreq defaults to freq, which opts the system out of load-adaptive demotion.
+         */
+        int addSystem(const std::string& name, SysFreq freq, SystemFn fn, SystemAccess access = {}, std::optional<SysFreq> minFreq = std::nullopt);
+
+        /*
+         * Maximum time in seconds one call to advance() should take. 0 disables frequency adaptation.
+         */
+        void setFrameBudget(double frameBudget);
+
+        void setThreadPool(std::shared_ptr<ThreadPool> threadPool);
+
+        /*
+         * nullptr when systems run on the calling thread.
+         */
+        [[nodiscard]] ThreadPool* getThreadPool() const;
+        void setBarrierCallback(std::function<void()> callback);
+
+        /*
+         * containingTypes[T] lists the entity types whose pages embed T as a component.
+         * Accesses to T are widened to those types when computing conflicts.
+         */
+        void setContainingEntityTypes(std::vector<std::vector<int32_t>> containingTypes);
+
+        /*
+         * Advances simulation time by realDeltaTime and runs every master tick that fits in it.
+         * At most MaxTicksPerAdvance ticks are run per call; excess time is dropped.
+         * Returns the number of master ticks that were run.
+         */
+        int advance(double realDeltaTime);
+
+        void runTick();
+
+        /*
+         * Reassigns the phases of all systems using their measured average cost,
+         * most expensive systems first.
+         */
+        void rebalancePhases();
+
+        [[nodiscard]] const SystemInfo& getSystemInfo(int systemId) const;
+        [[nodiscard]] int getNumSystems() const;
+        [[nodiscard]] uint64_t getTick() const;
+
+        /*
+         * Total cost in seconds of each of the last TickHistorySize master ticks, oldest first.
+         */
+        [[nodiscard]] std::vector<double> getTickCostHistory() const;
+        [[nodiscard]] TickLoadSummary getTickLoadSummary() const;
+
+    private:
+        struct SystemEntry {
+            SystemInfo info;
+            SystemFn fn;
+            SystemAccess declaredAccess;
+            SystemAccess access;
+            const char* profileZoneName;
+            std::optional<uint64_t> lastRunTick;
+        };
+
+        void runSystem(SystemEntry& system);
+        void adaptFrequencies(double frameCost);
+        bool demoteOneSystem();
+        bool promoteOneSystem();
+        void changeSystemFrequency(int systemId, SysFreq newFreq);
+        void runSystemsParallel(std::span<const int> dueSystemIds);
+        [[nodiscard]] SystemAccess widenAccess(const SystemAccess& access) const;
+
+        [[nodiscard]] double getSystemWeight(const SystemEntry& system) const;
+        [[nodiscard]] int choosePhase(SysFreq freq, std::span<const int> placedSystemIds) const;
+        void recordSystemCost(SystemEntry& system, double cost);
+        void recordTickCost(double cost);
+
+        std::vector<SystemEntry> systems_;
+        SystemCounters counters_;
+        std::shared_ptr<ThreadPool> threadPool_;
+        std::function<void()> barrierCallback_;
+        std::vector<std::vector<int32_t>> containingTypes_;
+        double timeAccumulator_ = 0.0;
+
+        double frameBudget_ = 0.0;
+        int numOverloadedFrames_ = 0;
+        int numHeadroomFrames_ = 0;
+
+        std::vector<double> tickCostHistory_ = std::vector<double>(TickHistorySize, 0.0);
+        int tickCostHistoryPos_ = 0;
+        int numTicksRecorded_ = 0;
+    };
+
+} // lpg
+
+#endif //LPG_ENGINE_SRC_LPG_CORE_SYSTEMSCHEDULER_HPP_
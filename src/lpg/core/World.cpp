@@ -3,13 +3,22 @@
 //
 
 #include "World.hpp"
+#include "EntityPage.hpp"
+#include "FieldAccessProfiler.hpp"
 #include "SysCounter.hpp"
+#include "SystemScheduler.hpp"
+#include "Profiler.hpp"
+#include "Registry.hpp"
 #include "entity.hpp"
+#include "json.hpp"
 #include "message.hpp"
 #include "util.hpp"
+#include "../util/ThreadPool.hpp"
 
 #include <bit>
+#include <cstring>
 #include <list>
+#include <mutex>
 #include <optional>
 #include <set>
 #include <unordered_map>
@@ -19,156 +28,11 @@
 
 namespace lpg {
     namespace detail {
-        static constexpr inline unsigned EntityPageSize = 256;
-        static constexpr inline unsigned LogEntityPageSize = 8;
-        static_assert(EntityPageSize == (1 << LogEntityPageSize));
-
-        struct EntityPage {
-            int32_t entityTypeId;
-            int32_t pageId;
-            int32_t parentPage;
-
-            std::vector<int32_t> managedComponentPageOffsets;
-            int32_t stride;
-            int32_t currentSize;
-
-            int32_t numOccupied = 0;
-
-            std::array<uint64_t, (EntityPageSize + 63) / 64> occupancy;
-
-            std::vector<std::byte> storage;
-
-            [[nodiscard]] std::optional<int> findFreeOffset() const {
-                for (int i = 0; i < occupancy.size(); i++) {
-                    if (int bits = std::countr_zero(occupancy[i]); bits < 64) {
-                        int result = bits + i * 64;
-                        if (result >= EntityPageSize) {
-                            return std::nullopt;
-                        }
-                        return result;
-                    }
-                }
-                return std::nullopt;
-            }
-
-            struct PageReserveEntityResult {
-                void* entity;
-                int32_t offset;
-            };
-
-            /*
-             * Reserves the leftmost free spot, if one exists, for storing an entity.
-             * It is the caller's responsibility to construct the entity object at the returned address.
-             */
-            std::optional<PageReserveEntityResult> reserveEntity() {
-                auto offOpt = findFreeOffset();
-                if (not offOpt) {
-                    return std::nullopt;
-                }
-                int off = *offOpt;
-                int targetSize = (off + 1) * stride;
-
-                if (storage.size() < targetSize) {
-                    storage.resize(targetSize);
-                }
-
-                occupancy[off / 64] |= (1 << (off % 64));
-                return PageReserveEntityResult{
-                    .entity = entityPtr(off),
-                    .offset = off
-                };
-            }
-
-            bool isEmpty() const {
-                for (int i = 0; i < occupancy.size(); i++) {
-                    if (occupancy[i] != 0) {
-                        return false;
-                    }
-                }
-                return true;
-            }
-
-            bool isFull() const {
-                for (int i = 0; i < occupancy.size(); i++) {
-                    if (~occupancy[i] != 0) {
-                        return false;
-                    }
-                }
-                return true;
-            }
-
-            /*
-             * Marks the storage at the specified offset as ready to be reused for another entity.
-             * It is the caller's responsibility to destroy the entity object before calling this function.
-             */
-            void releaseEntity(int offset) {
-                occupancy[offset / 64] &= ~(1 << (offset % 64));
-            }
-
-            bool isEntityPresent(int offset) {
-                if (offset >= EntityPageSize) {
-                    return false;
-                }
-                return occupancy[offset / 64] & (1 << (offset % 64));
-            }
-
-            void* entityPtr(int offset) {
-                return storage.data() + offset * stride;
-            }
-            void* componentPtr(int offset, int componentOfffset) {
-                return storage.data() + componentOfffset + offset * stride;
-            }
-
-            [[nodiscard]] int numActiveEntities() const {
-                int result = 0;
-                for (int i = 0; i < occupancy.size(); i++) {
-                    result += std::popcount(occupancy[i]);
-                }
-                return result;
-            }
-
-            [[nodiscard]] std::vector<std::pair<int, int> > getActiveRanges() const {
-                std::vector<std::pair<int, int> > result;
-                result.reserve(8);
-                int curBegin = 0, curEnd = 0;
-                for (int i = 0; i < occupancy.size(); i++) {
-                    uint64_t tmp = occupancy[i];
-                    int pos = 0;
-                    while (tmp != 0) {
-                        int t0 = std::countr_zero(tmp);
-                        tmp >>= t0 & 63;
-                        int t1 = std::countr_one(tmp);
-                        tmp >>= t1 & 63;
-                        if (t1 == 64) {
-                            tmp = 0;
-                        }
-
-                        int begin = pos + t0;
-                        int end = begin + t1;
-                        pos += t0 + t1;
-
-                        begin += 64 * i;
-                        end += 64 * i;
-
-                        if (curEnd == begin) {
-                            curEnd = end;
-                        } else if (curBegin != curEnd) {
-                            result.emplace_back(curBegin, curEnd);
-                            curBegin = begin;
-                            curEnd = end;
-                        }
-                    }
-                }
-                if (curBegin != curEnd) {
-                    result.emplace_back(curBegin, curEnd);
-                }
-
-                return result;
-            }
+        struct DeferredStructuralChanges {
+            std::mutex mutex;
+            std::vector<std::move_only_function<void(World&)>> changes;
         };
 
-
-
         struct WorldData {
             std::vector<EntityInterface> entityInterfaces_;
             std::unordered_map<std::string, int> entityTypeMap_;
@@ -190,25 +54,31 @@ namespace lpg {
 
             std::unordered_map<std::string, int32_t> hmEntNameToId_;
 
-            
+            SystemScheduler scheduler_;
+            std::shared_ptr<BehaviourScheduler> behaviours_ = std::make_shared<BehaviourScheduler>();
+            std::shared_ptr<DeferredStructuralChanges> deferredChanges_ = std::make_shared<DeferredStructuralChanges>();
+            int numWorkerThreads_ = ThreadPool::DefaultNumThreads();
+            Registry* registry_ = nullptr;
 
             bool initFinalized = false;
         };
     } // namespace detail
 
-    inline auto DecomposeEntityDescriptor(EntityDescriptor ed) {
-        struct Result {
-            uint32_t page;
-            uint32_t offset;
-        };
-        return Result {
-            .page = ed / detail::EntityPageSize,
-            .offset = ed % detail::EntityPageSize,
-        };
-    }
-
     World::World() {
         this->worldData_ = detail::WorldData{};
+
+        auto& data = std::any_cast<detail::WorldData&>(worldData_);
+        data.scheduler_.setBarrierCallback([this]() {
+            auto& data = std::any_cast<detail::WorldData&>(worldData_);
+            applyDeferredStructuralChanges();
+            data.behaviours_->tick(data.scheduler_.getTick());
+            if (data.registry_) {
+                data.registry_->reclaim();
+            }
+#ifdef LPG_ENABLE_FIELD_ACCESS_PROFILER
+            profiler::RecordFieldAccessTick();
+#endif
+        });
     }
 
     World::~World() {
@@ -218,23 +88,25 @@ namespace lpg {
         // Consider during refactor: in principle, EntityPage should be responsible for this
         for (auto& page: data.entityPages_) {
             auto& interface = data.entityInterfaces_.at(page.entityTypeId);
+            if (interface.isTriviallyDestructible) {
+                continue;
+            }
             for (auto [beg, end]: page.getActiveRanges()) {
-                for (int i = beg; i < end; i++) {
-                    interface.destroy(page.entityPtr(i));
-                }
+                interface.destroyRange(page.entityPtr(beg), end - beg);
             }
         }
     }
 
 
     int World::registerEntityTypeImpl(const std::string& name, const EntityInterface& entityInterface) {
-        auto& data = std::any_cast<detail::WorldData &>(data);
+        auto& data = std::any_cast<detail::WorldData &>(worldData_);
 
         if (data.entityTypeMap_.contains(name)) {
             throw std::runtime_error("Entity type already registered: " + name);
         }
         auto newEntTypeId = static_cast<int>(data.entityInterfaces_.size());
         data.entityInterfaces_.push_back(entityInterface);
+        data.entityInterfaces_.back().entityTypeId = newEntTypeId;
         data.entityTypeMap_[name] = newEntTypeId;
         return newEntTypeId;
     }
@@ -265,8 +137,7 @@ namespace lpg {
         void* dst = dstPage.entityPtr(dstOff);
         void* src = srcPage.entityPtr(srcOff);
 
-        interface.move(dst, src);
-        interface.destroy(src);
+        interface.relocate(dst, src);
     }
 
     void World::swapEntities(int32_t targetDescriptor, int32_t sourceDescriptor) {
@@ -292,42 +163,52 @@ namespace lpg {
         interface.swap(dst, src);
     }
 
-    int32_t World::createNewPage(int entityTypeId) {
+    int32_t World::createNewPage(int entityTypeId, int32_t parentPage) {
         auto& data = std::any_cast<detail::WorldData &>(worldData_);
 
         const auto& interface = data.entityInterfaces_.at(entityTypeId);
         int32_t newPageId = data.entityPages_.size();
 
-
-
         vec::ResizeFor(data.entityPagesByType_, entityTypeId);
         vec::ResizeFor(data.freePagesByType_, entityTypeId);
         vec::ResizeFor(data.entityPagesByComponentType_, entityTypeId);
 
         data.entityPagesByType_[entityTypeId].push_back(newPageId);
-        data.freePagesByType_[entityTypeId].insert(newPageId);
+        // linked pages are filled only through their owner page
+        if (parentPage == -1) {
+            data.freePagesByType_[entityTypeId].insert(newPageId);
+        }
         for (const auto& compInfo: interface.embeddedComponents) {
+            vec::ResizeFor(data.entityPagesByComponentType_, compInfo.entityTypeId);
             data.entityPagesByComponentType_[compInfo.entityTypeId].push_back({
                 .pageId = newPageId,
                 .componentOffset = compInfo.offset
             });
         }
-        // TODO register managed components
-        // TODO create pages for managed components
 
         data.entityPages_.push_back(
             detail::EntityPage{
-                .occupancy = {},
+                .entityTypeId = entityTypeId,
+                .pageId = newPageId,
+                .parentPage = parentPage,
+                .managedComponentPages = {},
                 .stride = interface.entitySize,
-                .storage = {},
                 .currentSize = 0,
                 .numOccupied = 0,
-                .pageId = newPageId,
-                .parentPage = -1,
-                .managedComponentPageOffsets = {},
-                .entityTypeId = entityTypeId
+                .occupancy = {},
+                .storage = {}
             }
         );
+        // growing the storage lazily is fine, but it must never reallocate under live entities
+        data.entityPages_.back().storage.reserve(detail::EntityPageSize * interface.entitySize);
+
+        // index by id: creating linked pages reallocates entityPages_
+        for (const auto& compInfo: interface.managedComponents) {
+            int32_t linkedPageId = createNewPage(compInfo.entityTypeId, newPageId);
+            data.entityPages_[newPageId].managedComponentPages.push_back(linkedPageId);
+        }
+
+        return newPageId;
     }
 
     int32_t World::getFreePage(int entityTypeId) {
@@ -335,16 +216,15 @@ namespace lpg {
 
         auto& pageSet = data.freePagesByType_.at(entityTypeId);
         if (not pageSet.empty()) {
-            auto it = pageSet.begin();
-            auto result = *it;
-            pageSet.erase(it);
-            return result;
+            // the page leaves the set in reserveEntity, once it is full
+            return *pageSet.begin();
         } else {
             return createNewPage(entityTypeId);
         }
     }
 
     detail::ReserveEntityResult World::reserveEntity(int entityTypeId) {
+        LPG_PROFILE_ZONE("World::reserveEntity");
         auto& data = std::any_cast<detail::WorldData &>(worldData_);
 
         auto& page = data.entityPages_.at(getFreePage(entityTypeId));
@@ -359,11 +239,15 @@ namespace lpg {
     }
 
     bool World::despawnEntity(EntityDescriptor entityDescriptor) {
+        LPG_PROFILE_ZONE("World::despawnEntity");
         auto& data = std::any_cast<detail::WorldData &>(worldData_);
 
         auto [pageNum, offset] = DecomposeEntityDescriptor(entityDescriptor);
         auto& page = data.entityPages_.at(pageNum);
-        auto& entInterface = data.entityInterfaces_.at(pageNum);
+        auto& entInterface = data.entityInterfaces_.at(page.entityTypeId);
+        if (page.parentPage != -1) {
+            throw std::runtime_error("managed components are despawned together with their owner");
+        }
         if (page.isEntityPresent(offset)) {
             void* p = page.entityPtr(offset);
 
@@ -373,7 +257,12 @@ namespace lpg {
                 entInterface.sendMessage[preKillMessageTypeId](&preKillMessage, p);
             }
 
-            entInterface.destroy(p);
+            data.behaviours_->cancelAll(entityDescriptor);
+
+            despawnManagedComponents(page.pageId, offset);
+            if (not entInterface.isTriviallyDestructible) {
+                entInterface.destroy(p);
+            }
             page.releaseEntity(offset);
             if (page.numActiveEntities() == detail::EntityPageSize - 1) {
                 data.freePagesByType_.at(page.entityTypeId).insert(page.pageId);
@@ -384,13 +273,120 @@ namespace lpg {
     }
 
 
+    void World::spawnManagedComponents(EntityDescriptor owner) {
+        auto& data = std::any_cast<detail::WorldData &>(worldData_);
+
+        auto [pageNum, offset] = DecomposeEntityDescriptor(owner);
+        for (auto linkedPageId: data.entityPages_.at(pageNum).managedComponentPages) {
+            auto& linkedPage = data.entityPages_.at(linkedPageId);
+            const auto& interface = data.entityInterfaces_.at(linkedPage.entityTypeId);
+            if (not interface.constructDefault) {
+                throw std::runtime_error("managed component " + std::string(interface.name) + " is not default-constructible");
+            }
+            auto reserveResult = linkedPage.reserveEntityAt(offset);
+            interface.constructDefault(reserveResult.entity);
+            spawnManagedComponents(linkedPageId * detail::EntityPageSize + offset);
+        }
+    }
+
+    void World::despawnManagedComponents(int32_t pageId, int offset) {
+        auto& data = std::any_cast<detail::WorldData &>(worldData_);
+
+        for (auto linkedPageId: data.entityPages_.at(pageId).managedComponentPages) {
+            auto& linkedPage = data.entityPages_.at(linkedPageId);
+            if (not linkedPage.isEntityPresent(offset)) {
+                continue;
+            }
+            despawnManagedComponents(linkedPageId, offset);
+            const auto& interface = data.entityInterfaces_.at(linkedPage.entityTypeId);
+            if (not interface.isTriviallyDestructible) {
+                interface.destroy(linkedPage.entityPtr(offset));
+            }
+            linkedPage.releaseEntity(offset);
+        }
+    }
+
+    void* World::getManagedImpl(EntityDescriptor owner, int componentTypeId) {
+        auto& data = std::any_cast<detail::WorldData &>(worldData_);
+
+        auto [pageNum, offset] = DecomposeEntityDescriptor(owner);
+        auto& page = data.entityPages_.at(pageNum);
+        if (not page.isEntityPresent(offset)) {
+            return nullptr;
+        }
+        for (auto linkedPageId: page.managedComponentPages) {
+            auto& linkedPage = data.entityPages_.at(linkedPageId);
+            if (linkedPage.entityTypeId == componentTypeId) {
+                return linkedPage.entityPtr(offset);
+            }
+        }
+        return nullptr;
+    }
+
     void World::finalizeInit() {
         auto& data = std::any_cast<detail::WorldData&>(worldData_);
 
+        for (auto getEntityInterface: detail::GetAutoRegisteredEntityTypes()) {
+            const auto& entityInterface = getEntityInterface();
+            auto* registered = vec::TryGet(data.entityInterfaces_, entityInterface.entityTypeId);
+            if (not registered || registered->name.empty()) {
+                saveEntityInterface(entityInterface, entityInterface.entityTypeId);
+            }
+        }
+
+        std::vector<std::vector<int32_t>> containingTypes;
+        for (int32_t entTypeId = 0; entTypeId < data.entityInterfaces_.size(); entTypeId++) {
+            for (const auto& compInfo: data.entityInterfaces_[entTypeId].embeddedComponents) {
+                vec::ResizeFor(containingTypes, compInfo.entityTypeId);
+                containingTypes[compInfo.entityTypeId].push_back(entTypeId);
+            }
+        }
+        data.scheduler_.setContainingEntityTypes(std::move(containingTypes));
+
+        if (data.numWorkerThreads_ > 0) {
+            data.scheduler_.setThreadPool(std::make_shared<ThreadPool>(data.numWorkerThreads_));
+        }
+
         data.initFinalized = true;
     }
 
+    void World::setNumWorkerThreads(int numWorkerThreads) {
+        auto& data = std::any_cast<detail::WorldData&>(worldData_);
+        data.numWorkerThreads_ = numWorkerThreads;
+    }
+
+    void World::setRegistry(Registry* registry) {
+        auto& data = std::any_cast<detail::WorldData&>(worldData_);
+        data.registry_ = registry;
+    }
+
+    void World::deferDespawnEntity(EntityDescriptor entityDescriptor) {
+        deferStructuralChange([entityDescriptor](World& world) {
+            world.despawnEntity(entityDescriptor);
+        });
+    }
+
+    void World::deferStructuralChange(std::move_only_function<void(World&)> change) {
+        auto& data = std::any_cast<detail::WorldData&>(worldData_);
+        std::lock_guard lock(data.deferredChanges_->mutex);
+        data.deferredChanges_->changes.push_back(std::move(change));
+    }
+
+    void World::applyDeferredStructuralChanges() {
+        auto& data = std::any_cast<detail::WorldData&>(worldData_);
+
+        std::vector<std::move_only_function<void(World&)>> changes;
+        {
+            std::lock_guard lock(data.deferredChanges_->mutex);
+            changes.swap(data.deferredChanges_->changes);
+        }
+        for (auto& change: changes) {
+            change(*this);
+        }
+    }
+
     void World::forEachEntityImpl(int entityTypeId, void* userdata, void (*onEntity)(void* userdata, void* entBegin, void* entEnd)) {
+        LPG_PROFILE_ZONE("World::forEachEntity");
         auto& data = std::any_cast<detail::WorldData&>(worldData_);
         int entitySize = data.entityInterfaces_.at(entityTypeId).entitySize;
 
@@ -415,6 +411,363 @@ namespace lpg {
 
     }
 
+    using GatherStridedFn = void (*)(TypeErasedStridedSpan, al::Vec3f*);
+    using GatherContiguousFn = void (*)(void*, size_t, al::Vec3f*);
+
+    static void GatherFromPages(
+        detail::WorldData& data,
+        int entityTypeId,
+        GatherStridedFn EntityInterface::* stridedFn,
+        GatherContiguousFn EntityInterface::* contiguousFn,
+        std::vector<al::Vec3f>& out
+    ) {
+        const auto& interface = data.entityInterfaces_.at(entityTypeId);
+        out.clear();
+
+        for (auto pageId: data.entityPagesByType_.at(entityTypeId)) {
+            auto& page = data.entityPages_.at(pageId);
+            for (auto [beg, end]: page.getActiveRanges()) {
+                size_t outOffset = out.size();
+                out.resize(outOffset + (end - beg));
+                (interface.*contiguousFn)(page.entityPtr(beg), end - beg, out.data() + outOffset);
+            }
+        }
+
+        for (const auto& cInfo: data.entityPagesByComponentType_.at(entityTypeId)) {
+            auto& page = data.entityPages_.at(cInfo.pageId);
+            for (auto [beg, end]: page.getActiveRanges()) {
+                size_t outOffset = out.size();
+                out.resize(outOffset + (end - beg));
+                TypeErasedStridedSpan components {
+                    static_cast<std::byte*>(page.componentPtr(beg, cInfo.componentOffset)),
+                    static_cast<size_t>(end - beg),
+                    static_cast<size_t>(page.stride)
+                };
+                (interface.*stridedFn)(components, out.data() + outOffset);
+            }
+        }
+    }
+
+    void World::gatherPositions(int entityTypeId, std::vector<al::Vec3f>& out) {
+        LPG_PROFILE_ZONE("World::gatherPositions");
+        auto& data = std::any_cast<detail::WorldData&>(worldData_);
+        GatherFromPages(data, entityTypeId, &EntityInterface::gatherPositions, &EntityInterface::gatherPositionsContiguous, out);
+    }
+
+    void World::gatherRotations(int entityTypeId, std::vector<al::Vec3f>& out) {
+        LPG_PROFILE_ZONE("World::gatherRotations");
+        auto& data = std::any_cast<detail::WorldData&>(worldData_);
+        GatherFromPages(data, entityTypeId, &EntityInterface::gatherRotations, &EntityInterface::gatherRotationsContiguous, out);
+    }
+
+    void World::gatherScales(int entityTypeId, std::vector<al::Vec3f>& out) {
+        LPG_PROFILE_ZONE("World::gatherScales");
+        auto& data = std::any_cast<detail::WorldData&>(worldData_);
+        GatherFromPages(data, entityTypeId, &EntityInterface::gatherScales, &EntityInterface::gatherScalesContiguous, out);
+    }
+
+    const EntityInterface& World::getEntityInterface(int entityTypeId) {
+        auto& data = std::any_cast<detail::WorldData&>(worldData_);
+        return data.entityInterfaces_.at(entityTypeId);
+    }
+
+    std::span<const int> World::getPagesOfType(int entityTypeId) {
+        auto& data = std::any_cast<detail::WorldData&>(worldData_);
+        auto* pages = vec::TryGet(data.entityPagesByType_, entityTypeId);
+        if (not pages) {
+            return {};
+        }
+        return *pages;
+    }
+
+    detail::EntityPage& World::getPage(int32_t pageId) {
+        auto& data = std::any_cast<detail::WorldData&>(worldData_);
+        return data.entityPages_.at(pageId);
+    }
+
+    void World::entitiesToJSONImpl(int entityTypeId, std::string& out) {
+        LPG_PROFILE_ZONE("World::entitiesToJSON");
+        auto& data = std::any_cast<detail::WorldData&>(worldData_);
+        const auto& interface = data.entityInterfaces_.at(entityTypeId);
+        if (not interface.toJSON) {
+            throw std::runtime_error("entity type " + std::string(interface.name) + " has no JSON codec");
+        }
+
+        bool first = true;
+        out.push_back('[');
+        for (auto pageId: data.entityPagesByType_.at(entityTypeId)) {
+            auto& page = data.entityPages_.at(pageId);
+            for (auto [beg, end]: page.getActiveRanges()) {
+                for (int i = beg; i != end; ++i) {
+                    if (not first) {
+                        out.push_back(',');
+                    }
+                    interface.toJSON(page.entityPtr(i), out);
+                    first = false;
+                }
+            }
+        }
+        out.push_back(']');
+    }
+
+    int World::entitiesFromJSONImpl(int entityTypeId, std::string_view json) {
+        LPG_PROFILE_ZONE("World::entitiesFromJSON");
+        auto& data = std::any_cast<detail::WorldData&>(worldData_);
+        const auto& interface = data.entityInterfaces_.at(entityTypeId);
+        if (not interface.readJSON || not interface.constructDefault) {
+            throw std::runtime_error("entity type " + std::string(interface.name) + " cannot be read from JSON");
+        }
+
+        int numSpawned = 0;
+        JsonReader reader(json);
+        if (reader.beginArray()) {
+            while (reader.nextElement()) {
+                auto result = reserveEntity(entityTypeId);
+                interface.constructDefault(result.entity);
+                spawnManagedComponents(result.descriptor);
+                if (not interface.readJSON(result.entity, reader)) {
+                    despawnEntity(result.descriptor);
+                    break;
+                }
+                numSpawned++;
+            }
+        }
+        if (reader.failed() || not reader.atEnd()) {
+            throw std::runtime_error("malformed JSON array of " + std::string(interface.name) + " entities");
+        }
+        return numSpawned;
+    }
+
+    void World::entitiesToPackedImpl(int entityTypeId, std::vector<std::byte>& out) {
+        LPG_PROFILE_ZONE("World::entitiesToPacked");
+        auto& data = std::any_cast<detail::WorldData&>(worldData_);
+        const auto& interface = data.entityInterfaces_.at(entityTypeId);
+        if (interface.packedSize == 0) {
+            throw std::runtime_error("entity type " + std::string(interface.name) + " has no packed layout");
+        }
+
+        for (auto pageId: data.entityPagesByType_.at(entityTypeId)) {
+            auto& page = data.entityPages_.at(pageId);
+            for (auto [beg, end]: page.getActiveRanges()) {
+                size_t offset = out.size();
+                out.resize(offset + static_cast<size_t>(end - beg) * interface.packedSize);
+                interface.packRange(page.entityPtr(beg), end - beg, out.data() + offset);
+            }
+        }
+    }
+
+    int World::entitiesFromPackedImpl(int entityTypeId, std::span<const std::byte> packed) {
+        LPG_PROFILE_ZONE("World::entitiesFromPacked");
+        auto& data = std::any_cast<detail::WorldData&>(worldData_);
+        const auto& interface = data.entityInterfaces_.at(entityTypeId);
+        if (interface.packedSize == 0 || not interface.constructDefault) {
+            throw std::runtime_error("entity type " + std::string(interface.name) + " cannot be unpacked");
+        }
+        if (packed.size() % interface.packedSize != 0) {
+            throw std::runtime_error("packed " + std::string(interface.name) + " entities of the wrong size");
+        }
+
+        int numEntities = static_cast<int>(packed.size() / interface.packedSize);
+        for (int i = 0; i < numEntities; i++) {
+            auto result = reserveEntity(entityTypeId);
+            interface.constructDefault(result.entity);
+            interface.unpackRange(packed.data() + static_cast<size_t>(i) * interface.packedSize, 1, result.entity);
+            spawnManagedComponents(result.descriptor);
+        }
+        return numEntities;
+    }
+
+#ifdef LPG_ENABLE_FIELD_ACCESS_PROFILER
+    struct FieldAccessPageSnapshot {
+        int32_t entityTypeId; // type whose properties are compared
+        int32_t pageId;
+        int componentOffset;
+        std::vector<std::byte> bytes;
+    };
+
+    /*
+     * Calls fn(page, componentOffset) for every page holding entities of the given type,
+     * whether as entities of their own or embedded in another type.
+     */
+    template<typename TFunc>
+    static void ForEachPageHolding(detail::WorldData& data, int32_t entityTypeId, TFunc&& fn) {
+        if (auto* pageIds = vec::TryGet(data.entityPagesByType_, entityTypeId)) {
+            for (auto pageId: *pageIds) {
+                fn(data.entityPages_.at(pageId), 0);
+            }
+        }
+        if (auto* componentPages = vec::TryGet(data.entityPagesByComponentType_, entityTypeId)) {
+            for (const auto& cInfo: *componentPages) {
+                fn(data.entityPages_.at(cInfo.pageId), cInfo.componentOffset);
+            }
+        }
+    }
+
+    /*
+     * Copies the pages a system may write: those of its declared write types, or all of them for exclusive systems.
+     */
+    static std::vector<FieldAccessPageSnapshot> SnapshotWritablePages(detail::WorldData& data, const SystemAccess& access) {
+        std::vector<int32_t> entityTypeIds = access.writes;
+        if (access.exclusive) {
+            entityTypeIds.clear();
+            for (int32_t entityTypeId = 0; entityTypeId < data.entityInterfaces_.size(); entityTypeId++) {
+                entityTypeIds.push_back(entityTypeId);
+            }
+        }
+
+        std::vector<FieldAccessPageSnapshot> result;
+        for (auto entityTypeId: entityTypeIds) {
+            ForEachPageHolding(data, entityTypeId, [&](const detail::EntityPage& page, int componentOffset) {
+                result.push_back(FieldAccessPageSnapshot {
+                    .entityTypeId = entityTypeId,
+                    .pageId = page.pageId,
+                    .componentOffset = componentOffset,
+                    .bytes = page.storage
+                });
+            });
+        }
+        return result;
+    }
+
+    /*
+     * Counts scale writes for every property whose bytes differ from the snapshot.
+     */
+    static void RecordChangedFields(detail::WorldData& data, const std::vector<FieldAccessPageSnapshot>& snapshots, uint64_t scale) {
+        for (const auto& snapshot: snapshots) {
+            const auto& interface = data.entityInterfaces_.at(snapshot.entityTypeId);
+            const auto& page = data.entityPages_.at(snapshot.pageId);
+            std::vector<uint64_t> numWrites(interface.properties.size(), 0);
+
+            for (auto [beg, end]: page.getActiveRanges()) {
+                for (int i = beg; i < end; i++) {
+                    size_t entityBegin = static_cast<size_t>(i) * page.stride + snapshot.componentOffset;
+                    if (entityBegin + interface.entitySize > snapshot.bytes.size()) {
+                        break;
+                    }
+                    for (int p = 0; p < interface.properties.size(); p++) {
+                        const auto& property = interface.properties[p];
+                        size_t fieldBegin = entityBegin + property.offset;
+                        if (std::memcmp(snapshot.bytes.data() + fieldBegin, page.storage.data() + fieldBegin, property.size) != 0) {
+                            numWrites[p]++;
+                        }
+                    }
+                }
+            }
+
+            for (int p = 0; p < numWrites.size(); p++) {
+                if (numWrites[p] > 0) {
+                    profiler::RecordFieldAccess(snapshot.entityTypeId, p, 0, numWrites[p] * scale);
+                }
+            }
+        }
+    }
+
+    /*
+     * Reads through pages are not seen per field, so only the number of entities of each queried type is recorded,
+     * scaled by the sample interval like the page diffs.
+     */
+    static void RecordQueriedTypes(detail::WorldData& data, const SystemAccess& access, int sampleInterval) {
+        std::set<int32_t> entityTypeIds(access.reads.begin(), access.reads.end());
+        entityTypeIds.insert(access.writes.begin(), access.writes.end());
+
+        for (auto entityTypeId: entityTypeIds) {
+            uint64_t numEntities = 0;
+            ForEachPageHolding(data, entityTypeId, [&](const detail::EntityPage& page, int) {
+                numEntities += page.numActiveEntities();
+            });
+            if (numEntities > 0) {
+                profiler::RecordEntityTypeQuery(entityTypeId, numEntities * sampleInterval);
+            }
+        }
+    }
+#endif
+
+    int World::registerSystemImpl(const std::string& name, SysFreq freq, std::optional<SysFreq> minFreq, SystemScheduler::SystemFn fn, SystemAccess access) {
+        auto& data = std::any_cast<detail::WorldData&>(worldData_);
+#ifdef LPG_ENABLE_FIELD_ACCESS_PROFILER
+        // a system never runs concurrently with itself, so numRuns needs no synchronization
+        fn = [this, systemId = data.scheduler_.getNumSystems(), access, fn = std::move(fn), numRuns = uint64_t{0}](FixedUpdateMessage& message) mutable {
+            auto& data = std::any_cast<detail::WorldData&>(worldData_);
+            profiler::ScopedSystemAttribution attribution(systemId);
+            int sampleInterval = profiler::GetWriteSampleInterval();
+            if (numRuns++ % sampleInterval != 0) {
+                fn(message);
+            } else {
+                auto snapshots = SnapshotWritablePages(data, access);
+                fn(message);
+                RecordChangedFields(data, snapshots, sampleInterval);
+                RecordQueriedTypes(data, access, sampleInterval);
+            }
+        };
+#endif
+        return data.scheduler_.addSystem(name, freq, std::move(fn), std::move(access), minFreq);
+    }
+
+    profiler::FieldAccessReport World::getFieldAccessReport() {
+        auto& data = std::any_cast<detail::WorldData&>(worldData_);
+        std::vector<std::string> systemNames;
+        for (int systemId = 0; systemId < data.scheduler_.getNumSystems(); systemId++) {
+            systemNames.push_back(data.scheduler_.getSystemInfo(systemId).name);
+        }
+        return profiler::BuildFieldAccessReport(data.entityInterfaces_, systemNames);
+    }
+
+    int World::tick(double realDeltaTime) {
+        auto& data = std::any_cast<detail::WorldData&>(worldData_);
+        return data.scheduler_.advance(realDeltaTime);
+    }
+
+    SystemScheduler& World::getScheduler() {
+        auto& data = std::any_cast<detail::WorldData&>(worldData_);
+        return data.scheduler_;
+    }
+
+    void World::sendMessageToAllImpl(int entityTypeId, int messageTypeId, void* message, detail::CopyMessageFn copyMessage) {
+        LPG_PROFILE_ZONE("World::sendMessageToAll");
+        auto& data = std::any_cast<detail::WorldData&>(worldData_);
+
+        const auto& interface = data.entityInterfaces_.at(entityTypeId);
+        auto* pfnSendMessage = vec::TryGet(interface.sendMessageToManyContiguous, messageTypeId);
+        if (not pfnSendMessage || not *pfnSendMessage) {
+            return;
+        }
+
+        for (auto pageId: data.entityPagesByType_.at(entityTypeId)) {
+            auto& page = data.entityPages_.at(pageId);
+            for (auto [beg, end]: page.getActiveRanges()) {
+                (*pfnSendMessage)(message, page.entityPtr(beg), end - beg);
+            }
+        }
+
+        data.behaviours_->deliverMessageToMany(messageTypeId, message, copyMessage, [&](EntityDescriptor owner) {
+            auto [pageNum, offset] = DecomposeEntityDescriptor(owner);
+            return data.entityPages_.at(pageNum).entityTypeId == entityTypeId;
+        });
+    }
+
+    void World::sendMessageImpl(EntityDescriptor entityDescriptor, int messageTypeId, void* message, detail::CopyMessageFn copyMessage) {
+        auto& data = std::any_cast<detail::WorldData&>(worldData_);
+
+        auto [pageNum, offset] = DecomposeEntityDescriptor(entityDescriptor);
+        auto& page = data.entityPages_.at(pageNum);
+        if (not page.isEntityPresent(offset)) {
+            return;
+        }
+
+        const auto& interface = data.entityInterfaces_.at(page.entityTypeId);
+        auto* pfnSendMessage = vec::TryGet(interface.sendMessage, messageTypeId);
+        if (pfnSendMessage && *pfnSendMessage) {
+            (*pfnSendMessage)(message, page.entityPtr(offset));
+        }
+
+        data.behaviours_->deliverMessage(messageTypeId, message, copyMessage, entityDescriptor);
+    }
+
+    void World::startBehaviour(EntityDescriptor entityDescriptor, Behaviour behaviour) {
+        auto& data = std::any_cast<detail::WorldData&>(worldData_);
+        data.behaviours_->start(entityDescriptor, std::move(behaviour));
+    }
+
     void World::registerMessageTypeImpl(const std::string& name, int messageTypeId) {
         auto& data = std::any_cast<detail::WorldData&>(worldData_);
 
@@ -441,5 +794,10 @@ namespace lpg {
         }
 
         data.entityInterfaces_[entTypeId] = entityInterface;
+
+        // page lists exist for every registered type, even before its first page is created
+        vec::ResizeFor(data.entityPagesByType_, entTypeId);
+        vec::ResizeFor(data.freePagesByType_, entTypeId);
+        vec::ResizeFor(data.entityPagesByComponentType_, entTypeId);
     }
 } // namespace lpg
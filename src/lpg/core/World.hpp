@@ -8,13 +8,25 @@
 #include <stdint.h>
 #include <string>
 #include <any>
+#include <cstddef>
+#include <functional>
+#include <optional>
+#include <span>
 #include <string_view>
+#include <vector>
 #include <reflect>
 #include "SysCounter.hpp"
+#include "SystemScheduler.hpp"
+#include "Behaviour.hpp"
+#include "EntityPage.hpp"
+#include "FieldAccessProfiler.hpp"
 #include "entity.hpp"
+#include "message.hpp"
 
 namespace lpg {
 
+    class Registry;
+
     namespace detail {
         struct ReserveEntityResult {
             void* entity;
@@ -29,6 +41,16 @@ namespace lpg {
         World();
         ~World();
 
+        // the scheduler's barrier callback and deferred changes refer back to this World
+        World(const World&) = delete;
+        World(World&&) = delete;
+        World& operator=(const World&) = delete;
+        World& operator=(World&&) = delete;
+
+        /*
+         * Registers an entity type explicitly, usually with lpg::GetEntityInterface<TEntity>() from the
+         * translation unit holding its generated code. See also LPG_REGISTER_ENTITY_TYPE.
+         */
         template<typename TEntity>
         void registerEntityType(const EntityInterface& entityInterface) {
 
@@ -39,11 +61,41 @@ namespace lpg {
 
         }
 
+        /*
+         * Registers a system to be run by the scheduler at the given frequency.
+         * Systems passed as lvalues are referenced and must outlive the World; rvalues are moved into the World.
+         * If minFreq is given, the scheduler may run the system as slowly as minFreq when frames go over budget.
+         */
         template<typename TSystem>
-        void registerSystem(const std::string& name, TSystem&& system) {
-            //TODO
+        int registerSystem(const std::string& name, TSystem&& system, SysFreq freq = SysFreq::Div0001_360Hz, std::optional<SysFreq> minFreq = std::nullopt) {
+            using SystemType = std::remove_cvref_t<TSystem>;
+
+            std::shared_ptr<SystemType> systemPtr;
+            if constexpr(std::is_lvalue_reference_v<TSystem>) {
+                systemPtr = std::shared_ptr<SystemType>(std::shared_ptr<void>{}, &system);
+            } else {
+                systemPtr = std::make_shared<SystemType>(std::move(system));
+            }
+
+            auto systemFn = [systemPtr](FixedUpdateMessage& message) {
+                detail::InvokeSystem(*systemPtr, message);
+            };
+            return registerSystemImpl(name, freq, minFreq, systemFn, detail::DeriveSystemAccess<SystemType>());
         }
 
+        /*
+         * Advances the master clock by realDeltaTime and runs all systems that become due.
+         */
+        int tick(double realDeltaTime);
+
+        [[nodiscard]] SystemScheduler& getScheduler();
+
+        /*
+         * Fields touched by each system, ranked by bytes per tick, with suggested column groups.
+         * Empty unless built with LPG_ENGINE_ENABLE_FIELD_ACCESS_PROFILER; see FieldAccessProfiler.hpp.
+         */
+        [[nodiscard]] profiler::FieldAccessReport getFieldAccessReport();
+
         template<typename TMessage>
         void registerMessageType() {
             int msgTypeID = detail::GetMessageTypeId<TMessage>();
@@ -58,16 +110,53 @@ namespace lpg {
             auto result = reserveEntity(entTypeId);
             TEntity* ent = static_cast<TEntity*>(result.entity);
             std::construct_at(ent, std::forward<decltype(args)>(args)...);
+            spawnManagedComponents(result.descriptor);
 
+            return result.descriptor;
+        }
 
-            //TODO create pages for managed components
-            //TODO recursively spawn managed components
-            //(later)
+        /*
+         * Despawns the entity together with its managed components.
+         * Managed components cannot be despawned on their own.
+         */
+        bool despawnEntity(EntityDescriptor entityDescriptor);
+
+        /*
+         * Returns the owner's managed component of the given type, or nullptr if it has none.
+         */
+        template<typename TComponent>
+        TComponent* getManaged(EntityDescriptor owner) {
+            return static_cast<TComponent*>(getManagedImpl(owner, detail::GetEntityTypeId<TComponent>()));
+        }
 
-            return result.descriptor;
+        /*
+         * Structural changes requested while systems may be running in parallel.
+         * They are queued and applied at the next barrier, in the order in which they were requested.
+         * Safe to call from any thread.
+         */
+        template<typename TEntity>
+        void deferSpawnEntity(auto&&... args) {
+            deferStructuralChange([...args = std::forward<decltype(args)>(args)](World& world) mutable {
+                world.spawnEntity<TEntity>(std::move(args)...);
+            });
         }
 
-        bool World::despawnEntity(EntityDescriptor entityDescriptor);
+        void deferDespawnEntity(EntityDescriptor entityDescriptor);
+        void deferStructuralChange(std::move_only_function<void(World&)> change);
+        void applyDeferredStructuralChanges();
+
+        /*
+         * Number of worker threads used to run non-conflicting systems in parallel.
+         * 0 runs every system on the calling thread. Takes effect at finalizeInit().
+         */
+        void setNumWorkerThreads(int numWorkerThreads);
+
+        /*
+         * Reclaims the registry's replaced snapshots at every tick barrier: systems may read snapshots
+         * from Registry::current() during a tick, but must not keep them across ticks.
+         * The registry must outlive the World, or be detached first with nullptr.
+         */
+        void setRegistry(Registry* registry);
 
         /* TODO performance:
          * replace result type with EntityQueryResult */
@@ -86,9 +175,89 @@ namespace lpg {
             return result;
         }
 
+        /*
+         * Delivers the message to the entity's handler (if it has one), and a copy of it to its behaviours
+         * waiting for it, which resume at the next tick barrier.
+         */
+        template<typename TMessage>
+        void sendMessage(EntityDescriptor entityDescriptor, TMessage& message) {
+            sendMessageImpl(entityDescriptor, detail::GetMessageTypeId<TMessage>(), &message, &detail::CopyMessage<TMessage>);
+        }
+
+        /*
+         * Attaches a coroutine to the entity. It is first run at the next tick barrier, resumed on the master tick
+         * and destroyed when the entity is despawned. Safe to call from systems running in parallel.
+         */
+        void startBehaviour(EntityDescriptor entityDescriptor, Behaviour behaviour);
+
         template<typename TEntity, typename TMessage>
-        void sendMessageToAll() {
+        void sendMessageToAll(TMessage& message) {
+            sendMessageToAllImpl(detail::GetEntityTypeId<TEntity>(), detail::GetMessageTypeId<TMessage>(), &message, &detail::CopyMessage<TMessage>);
+        }
 
+        /*
+         * Replaces the contents of out with the positions (rotations, scales) of every entity of the type,
+         * including those embedded as components of other entities. Uses the generated batch accessors,
+         * i.e. one indirect call per contiguous run of entities rather than one per entity.
+         */
+        template<typename TEntity>
+        void gatherPositions(std::vector<al::Vec3f>& out) {
+            gatherPositions(detail::GetEntityTypeId<TEntity>(), out);
+        }
+        template<typename TEntity>
+        void gatherRotations(std::vector<al::Vec3f>& out) {
+            gatherRotations(detail::GetEntityTypeId<TEntity>(), out);
+        }
+        template<typename TEntity>
+        void gatherScales(std::vector<al::Vec3f>& out) {
+            gatherScales(detail::GetEntityTypeId<TEntity>(), out);
+        }
+
+        void gatherPositions(int entityTypeId, std::vector<al::Vec3f>& out);
+        void gatherRotations(int entityTypeId, std::vector<al::Vec3f>& out);
+        void gatherScales(int entityTypeId, std::vector<al::Vec3f>& out);
+
+        /*
+         * Page-level access for systems that mirror entities in structures of their own, e.g. physics bodies.
+         * getPagesOfType includes the linked pages of managed components. Page references are invalidated
+         * when another page is created, so keep page ids across calls rather than references.
+         */
+        [[nodiscard]] const EntityInterface& getEntityInterface(int entityTypeId);
+        [[nodiscard]] std::span<const int> getPagesOfType(int entityTypeId);
+        [[nodiscard]] detail::EntityPage& getPage(int32_t pageId);
+
+        /*
+         * Appends a JSON array with every active entity of the type, page by page.
+         * Clear and reuse the buffer between calls to avoid reallocating it.
+         */
+        template<typename TEntity>
+        void entitiesToJSON(std::string& out) {
+            entitiesToJSONImpl(detail::GetEntityTypeId<TEntity>(), out);
+        }
+
+        /*
+         * Spawns an entity of the type for every object of a JSON array, such as one written by entitiesToJSON:
+         * default-constructed, then read from the object. Returns the number of entities spawned.
+         * Throws on malformed input, keeping the entities read before the malformed object.
+         */
+        template<typename TEntity>
+        int entitiesFromJSON(std::string_view json) {
+            return entitiesFromJSONImpl(detail::GetEntityTypeId<TEntity>(), json);
+        }
+
+        /*
+         * Binary counterparts of entitiesToJSON and entitiesFromJSON, in the packed layout of the type
+         * (EntityInterface::packRange): entities back to back, fields with a Quantize attribute encoded.
+         * Both throw if the type has no packed layout; reading also throws if the size is not a whole number of entities.
+         */
+        template<typename TEntity>
+        void entitiesToPacked(std::vector<std::byte>& out) {
+            entitiesToPackedImpl(detail::GetEntityTypeId<TEntity>(), out);
+        }
+
+        template<typename TEntity>
+        int entitiesFromPacked(std::span<const std::byte> packed) {
+            return entitiesFromPackedImpl(detail::GetEntityTypeId<TEntity>(), packed);
         }
 
         template<typename TEntity>
@@ -96,6 +265,10 @@ namespace lpg {
 
         }
 
+        /*
+         * Registers the entity types declared with LPG_REGISTER_ENTITY_TYPE that were not registered explicitly,
+         * then freezes the set of types. Their interfaces are built once per process and shared between Worlds.
+         */
         void finalizeInit();
 
 
@@ -105,13 +278,23 @@ namespace lpg {
         void forEachEntityImpl(int entityTypeId, void* userdata, void (*onEntity)(void* userdata, void* entBegin, void* entEnd));
 
         void registerMessageTypeImpl(const std::string& name, int messageTypeId);
+        void sendMessageImpl(EntityDescriptor entityDescriptor, int messageTypeId, void* message, detail::CopyMessageFn copyMessage);
+        void sendMessageToAllImpl(int entityTypeId, int messageTypeId, void* message, detail::CopyMessageFn copyMessage);
+        void entitiesToJSONImpl(int entityTypeId, std::string& out);
+        int entitiesFromJSONImpl(int entityTypeId, std::string_view json);
+        void entitiesToPackedImpl(int entityTypeId, std::vector<std::byte>& out);
+        int entitiesFromPackedImpl(int entityTypeId, std::span<const std::byte> packed);
+        void* getManagedImpl(EntityDescriptor owner, int componentTypeId);
+        void spawnManagedComponents(EntityDescriptor owner);
+        void despawnManagedComponents(int32_t pageId, int offset);
+        int registerSystemImpl(const std::string& name, SysFreq freq, std::optional<SysFreq> minFreq, SystemScheduler::SystemFn fn, SystemAccess access);
 
         EntityVersionNumber getCurVersionNumOf(EntityID entId);
         void saveEntityInterface(const EntityInterface& entityInterface, int32_t entTypeId);
         int registerEntityTypeImpl(const std::string& name, const EntityInterface& entityInterface);
         void relocateEntity(int32_t targetDescriptor, int32_t sourceDescriptor);
         void swapEntities(int32_t targetDescriptor, int32_t sourceDescriptor);
-        int32_t createNewPage(int entityTypeId);
+        int32_t createNewPage(int entityTypeId, int32_t parentPage = -1);
         int32_t getFreePage(int entityTypeId);
         detail::ReserveEntityResult reserveEntity(int32_t entityTypeId);
 
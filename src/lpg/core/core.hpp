@@ -6,10 +6,19 @@
 #define LPG_ENGINE_SRC_LPG_CORE_CORE_HPP_
 
 #include "data.hpp"
+#include "InternedString.hpp"
 #include "entity.hpp"
+#include "json.hpp"
+#include "quantize.hpp"
 #include "message.hpp"
 #include "Registry.hpp"
+#include "ConfigLoader.hpp"
 #include "AssetManager.hpp"
+#include "Behaviour.hpp"
+#include "Profiler.hpp"
+#include "FieldAccessProfiler.hpp"
+#include "SystemScheduler.hpp"
 #include "World.hpp"
+#include "StaticWorld.hpp"
 
 #endif //LPG_ENGINE_SRC_LPG_CORE_CORE_HPP_
@@ -4,6 +4,10 @@
 
 #include "data.hpp"
 
+#include <algorithm>
+#include <charconv>
+#include <format>
+
 
 
 namespace lpg {
@@ -42,6 +46,68 @@ namespace lpg {
         }, dataUnit);
     }
 
+    static std::string_view TrimWhitespace(std::string_view str) {
+        auto isSpace = [](char c) {
+            return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+        };
+        while (not str.empty() && isSpace(str.front())) {
+            str.remove_prefix(1);
+        }
+        while (not str.empty() && isSpace(str.back())) {
+            str.remove_suffix(1);
+        }
+        return str;
+    }
+
+    template<typename T>
+    static bool ParseNumber(std::string_view str, T& value) {
+        str = TrimWhitespace(str);
+        if (str.starts_with('+')) {
+            str.remove_prefix(1);
+        }
+        auto [ptr, ec] = std::from_chars(str.data(), str.data() + str.size(), value);
+        return ec == std::errc{} && ptr == str.data() + str.size() && not str.empty();
+    }
+
+    bool StrToDataUnit(std::string_view str, DataUnit& dataUnit) {
+        return std::visit(overloaded {
+            [&](std::integral auto& i) {
+                return ParseNumber(str, i);
+            },
+            [&](std::floating_point auto& f) {
+                return ParseNumber(str, f);
+            },
+            [&](bool& b) {
+                auto trimmed = TrimWhitespace(str);
+                if (trimmed == "true" || trimmed == "1") {
+                    b = true;
+                    return true;
+                }
+                if (trimmed == "false" || trimmed == "0") {
+                    b = false;
+                    return true;
+                }
+                return false;
+            },
+            [&](al::VectorType auto& vec) {
+                using VecType = std::remove_cvref_t<decltype(vec)>;
+                int size = VecType::NumElements;
+                for (int i=0; i<size; i++) {
+                    size_t end = (i<size-1) ? str.find(',') : str.size();
+                    if (end == std::string_view::npos || not ParseNumber(str.substr(0, end), vec[i])) {
+                        return false;
+                    }
+                    str.remove_prefix(std::min(end + 1, str.size()));
+                }
+                return true;
+            },
+            [&](std::string& s) {
+                s = str;
+                return true;
+            }
+        }, dataUnit);
+    }
+
     std::string DataUnitToStr(PtrToDataUnit dataUnit) {
         return std::visit(overloaded {
             [](const auto* p) {
@@ -7,12 +7,14 @@
 
 #include <reflect>
 #include <string>
+#include <string_view>
 #include <variant>
 #include <tuple>
 
 
 #include <axxegro/com/math/math.hpp>
 
+#include "InternedString.hpp"
 
 #ifdef _MSC_VER
 #define LPG_NO_UNIQUE_ADDRESS [[msvc::no_unique_address]]
@@ -39,12 +41,18 @@ namespace lpg {
         Blob
     };
 
-    template<AssetType TPAssetType>
+    /*
+     * TStorage may be InternedString (see InternedAssetPath), which keeps entities holding the path trivially copyable.
+     */
+    template<AssetType TPAssetType, typename TStorage = std::string>
     struct AssetPath {
         static constexpr AssetType Type = TPAssetType;
-        std::string path;
+        TStorage path;
     };
 
+    template<AssetType TPAssetType>
+    using InternedAssetPath = AssetPath<TPAssetType, InternedString>;
+
     namespace detail {
         template<typename... Args>
         struct DataUnitHelper {
@@ -75,7 +83,13 @@ namespace lpg {
 
     [[nodiscard]] std::string DataUnitToStr(const DataUnit& dataUnit);
     std::string DataUnitToStr(PtrToDataUnit dataUnit);
-     // DataUnit StrToDataUnit(const std::string_view data);
+
+    /*
+     * Parses str as the type dataUnit currently holds, in the format DataUnitToStr produces
+     * ("true"/"false" or "1"/"0" for bools, comma-separated elements for vectors).
+     * Returns false and leaves dataUnit unspecified on malformed input.
+     */
+    [[nodiscard]] bool StrToDataUnit(std::string_view str, DataUnit& dataUnit);
 
 
 
@@ -93,6 +107,26 @@ namespace lpg {
             bool replicate = false;
             bool archive = true;
         };
+
+        /*
+         * Encodings for Quantize. Half and SNorm16 take 2 bytes per element; SNorm16 covers [-1, 1].
+         * FixedPoint<T> maps [MinValue, MaxValue] (both required) onto the full range of T.
+         */
+        struct Half {};
+        struct SNorm16 {};
+        template<typename T>
+        struct FixedPoint {
+            using StorageType = T;
+        };
+
+        /*
+         * Marks a floating-point field (or a vector of floats) as storable in the packed layout
+         * with the given encoding, e.g. LPG_ATTR(Quantize<Half>{}).
+         */
+        template<typename TEncoding>
+        struct Quantize {
+            using Encoding = TEncoding;
+        };
     }
 
 
@@ -172,7 +206,7 @@ namespace lpg {
 
             template<typename T>
             inline constexpr auto num_non_attr_members() {
-                return reflect::size<T>() - num_metadata_members_until<reflect::size<T>() - 1, T>();
+                return reflect::size<T>() - num_metadata_members_until<static_cast<int>(reflect::size<T>()) - 1, T>();
             }
 
             template<int N, typename T>
@@ -183,7 +217,7 @@ namespace lpg {
             template<int N, typename T, int X>
                 requires (X >= 0)
             inline constexpr int idx_reduced_to_real_impl() {
-                if constexpr (idx_real_to_reduced<X, T>() == N) {
+                if constexpr (is_member_data<X, T>() && idx_real_to_reduced<X, T>() == N) {
                     return X;
                 } else {
                     return idx_reduced_to_real_impl<N, T, X-1>();
@@ -253,12 +287,18 @@ namespace lpg {
 
         template<int N, typename T>
         inline constexpr decltype(auto) get(T&& value) noexcept {
-            return base_refl::get<detail::idx_reduced_to_real<N, T>()>(value);
+            return base_refl::get<detail::idx_reduced_to_real<N, std::remove_cvref_t<T>>()>(value);
         }
 
         template<int N, typename T>
         using member_type = std::remove_cvref_t<decltype(get<N>(std::declval<T>()))>;
 
+        template<int N, typename T>
+        inline constexpr bool is_member_const() {
+            using RefType = decltype(base_refl::get<detail::idx_reduced_to_real<N, T>()>(std::declval<T&>()));
+            return std::is_const_v<std::remove_reference_t<RefType>>;
+        }
+
         template<int N, typename T>
         inline constexpr bool has_attributes() {
             static constexpr int real_idx = detail::idx_reduced_to_real<N, T>();
@@ -283,7 +323,14 @@ namespace lpg {
 
         template<typename A, int N, typename T>
         inline constexpr bool has_member_attr() {
-            return requires {std::get<A>(member_attr_list<N, T>());};
+            if constexpr (has_attributes<N, T>()) {
+                // std::get<A> is not SFINAE-friendly, so look for A in the tuple type instead
+                return []<typename... As>(std::type_identity<std::tuple<As...>>) {
+                    return (std::is_same_v<A, As> || ...);
+                }(std::type_identity<std::remove_cvref_t<decltype(member_attr_list<N, T>())>>{});
+            } else {
+                return false;
+            }
         }
 
 
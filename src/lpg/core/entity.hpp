@@ -8,15 +8,21 @@
 #include <string_view>
 #include <memory>
 #include <array>
+#include <span>
+#include <string>
+#include <vector>
 #include <axxegro/com/math/math.hpp> //TODO get rid of this dependency eventually
 #include <axxegro/core/Transform.hpp>
 
 #include "data.hpp"
+#include "FieldAccessProfiler.hpp"
 
 #include "../util/strided_span.hpp"
 
 namespace lpg {
 
+    class JsonReader;
+
     struct BaseEntity {};
 
     template<typename T>
@@ -57,32 +63,81 @@ namespace lpg {
 
     struct ComponentInfo {
         int entityTypeId;
-        std::string name;
+        std::string_view name;
         int position;
         int offset;
     };
 
+    namespace detail {
+        template<typename T>
+        inline constexpr char TypeKeyAnchor = 0;
+
+        /*
+         * A unique address per type, usable as a cheap runtime type tag.
+         */
+        template<typename T>
+        constexpr const void* GetTypeKey() {
+            return &TypeKeyAnchor<std::remove_cvref_t<T>>;
+        }
+    }
+
     struct PropertyInfo {
-        std::string name;
+        std::string_view name;
         int position;
         int offset;
+        int size;
+        const void* typeKey;
+        bool isConst;
     };
 
+    /*
+     * Type-erased operations and metadata of one entity type. The name and all tables point to static data
+     * owned by the generated code (see entity_codegen.hpp), so interfaces are cheap to copy and outlive every World.
+     */
     struct EntityInterface {
 
-        std::string name;
+        std::string_view name;
+        int32_t entityTypeId;
         int32_t entitySize;
         int32_t entityAlign;
 
-        std::vector<ComponentInfo> embeddedComponents;
-        std::vector<ComponentInfo> managedComponents;
-        std::vector<PropertyInfo> properties;
-
+        std::span<const ComponentInfo> embeddedComponents;
+        std::span<const ComponentInfo> managedComponents;
+        std::span<const PropertyInfo> properties;
+
+        /*
+         * Trivially relocatable types can be moved to a new address with memcpy, leaving nothing to destroy
+         * at the old one. Trivially copyable types are always trivially relocatable; other types opt in
+         * with `using IsTriviallyRelocatable = void;` (or are detected by the compiler where supported).
+         * Callers may skip destroy altogether for trivially destructible types.
+         */
+        bool isTriviallyCopyable;
+        bool isTriviallyRelocatable;
+        bool isTriviallyDestructible;
+
+        /*
+         * Packed layout: fields with a Quantize attribute are stored in their encoded form, all others verbatim,
+         * back to back without padding. It is meant for snapshots, replication and other bulk copies of
+         * large entity arrays, e.g. World::entitiesToPacked; live pages keep the regular struct.
+         * Only generated for trivially copyable types.
+         */
+        int32_t packedSize; // 0 if the type has no packed layout
+        void (*packRange)(const void* entities, size_t count, void* packed);
+        void (*unpackRange)(const void* packed, size_t count, void* entities);
+
+        void (*constructDefault)(void*); // nullptr if not default-constructible
         void (*destroy)(void*);
         void (*swap)(void*, void*);
         void (*move)(void*, void*);
         void (*copy)(void*, void*);
 
+        /*
+         * relocate constructs dst from src and ends the lifetime of src; dst must be uninitialized storage.
+         * destroyRange destroys count contiguous entities.
+         */
+        void (*relocate)(void* dst, void* src);
+        void (*destroyRange)(void* first, size_t count);
+
         al::Vec3f (*getPosition)(void*);
         al::Vec3f (*getRotation)(void*);
         al::Vec3f (*getScale)(void*);
@@ -92,23 +147,105 @@ namespace lpg {
         void (*accumulateTransform)(void*, al::Transform&);
         void (*accumulateLocalTransform)(void*, al::Transform&);
 
+        /*
+         * Batch variants of the accessors above. They write one value per entity into out, which must have room
+         * for all of them. The strided variants also accept entities embedded as components of a larger entity.
+         */
+        void (*gatherPositions)(TypeErasedStridedSpan, al::Vec3f* out);
+        void (*gatherRotations)(TypeErasedStridedSpan, al::Vec3f* out);
+        void (*gatherScales)(TypeErasedStridedSpan, al::Vec3f* out);
+        void (*gatherIds)(TypeErasedStridedSpan, int32_t* out);
+        void (*accumulateTransforms)(TypeErasedStridedSpan, al::Transform* inOut);
+
+        void (*gatherPositionsContiguous)(void* first, size_t count, al::Vec3f* out);
+        void (*gatherRotationsContiguous)(void* first, size_t count, al::Vec3f* out);
+        void (*gatherScalesContiguous)(void* first, size_t count, al::Vec3f* out);
+        void (*gatherIdsContiguous)(void* first, size_t count, int32_t* out);
+        void (*accumulateTransformsContiguous)(void* first, size_t count, al::Transform* inOut);
+
         std::vector<int32_t> (*getChildrenIds)(void*);
         int32_t (*getParentId)(void*);
         int32_t (*getId)(void*);
 
+        /*
+         * toJSON appends one JSON object to the buffer. fromJSON returns false on malformed input,
+         * in which case the entity may be partially updated. readJSON is fromJSON for the object at the reader's
+         * position, e.g. an element of an array of entities.
+         */
         void (*toJSON)(void*, std::string&);
-        void (*fromJSON)(void*, std::string&);
+        bool (*fromJSON)(void*, std::string_view);
+        bool (*readJSON)(void*, JsonReader&);
 
+        /*
+         * Maps a property name to its index in properties, setProperty and getProperty; -1 if there is no such property.
+         */
         int32_t (*propertyNamePerfectHash)(std::string_view);
-        std::vector<void(*)(void* ent, void* prop)> setProperty;
-        std::vector<void*(*)(void* ent)> getProperty;
+        std::span<void(* const)(void* ent, const void* prop)> setProperty; // nullptr for const properties
+        std::span<void*(* const)(void* ent)> getProperty;
 
-        std::vector<void(*)(void* msg, void* ent)> sendMessage;
-        std::vector<void(*)(void* msg, TypeErasedStridedSpan ent)> sendMessageToMany;
-        std::vector<void(*)(void* msg, void* ent, size_t)> sendMessageToManyContiguous;
+        /*
+         * Indexed by message type id; nullptr (or out of range) for messages the type does not handle.
+         */
+        std::span<void(* const)(void* msg, void* ent)> sendMessage;
+        std::span<void(* const)(void* msg, TypeErasedStridedSpan ent)> sendMessageToMany;
+        std::span<void(* const)(void* msg, void* ent, size_t)> sendMessageToManyContiguous;
 
     };
 
+    namespace detail {
+        using EntityInterfaceGetter = const EntityInterface& (*)();
+
+        /*
+         * Entity types registered with LPG_REGISTER_ENTITY_TYPE, in static initialization order.
+         */
+        inline std::vector<EntityInterfaceGetter>& GetAutoRegisteredEntityTypes() {
+            static std::vector<EntityInterfaceGetter> entityTypes;
+            return entityTypes;
+        }
+    }
+
+    /*
+     * Typed property access. Returns nullptr (or false) if the index is out of range or the property is not of type T.
+     * Const properties are only reachable as const T, e.g. GetPropertyPtr<const int>, and never through SetProperty.
+     * Resolve the index once with EntityInterface::propertyNamePerfectHash when setting the same property repeatedly.
+     */
+    template<typename T>
+    T* GetPropertyPtr(const EntityInterface& entityInterface, void* entity, int32_t propertyIndex) {
+        if (propertyIndex < 0 || propertyIndex >= entityInterface.properties.size()) {
+            return nullptr;
+        }
+        const auto& property = entityInterface.properties[propertyIndex];
+        if (property.typeKey != detail::GetTypeKey<T>() || (property.isConst && not std::is_const_v<T>)) {
+            return nullptr;
+        }
+        LPG_RECORD_FIELD_READ(entityInterface.entityTypeId, propertyIndex);
+        return static_cast<T*>(entityInterface.getProperty[propertyIndex](entity));
+    }
+
+    template<typename T>
+    T* GetPropertyPtr(const EntityInterface& entityInterface, void* entity, std::string_view name) {
+        return GetPropertyPtr<T>(entityInterface, entity, entityInterface.propertyNamePerfectHash(name));
+    }
+
+    template<typename T>
+    bool SetProperty(const EntityInterface& entityInterface, void* entity, int32_t propertyIndex, const T& value) {
+        if (propertyIndex < 0 || propertyIndex >= entityInterface.properties.size()) {
+            return false;
+        }
+        auto pfnSet = entityInterface.setProperty[propertyIndex];
+        if (entityInterface.properties[propertyIndex].typeKey != detail::GetTypeKey<T>() || not pfnSet) {
+            return false;
+        }
+        LPG_RECORD_FIELD_WRITE(entityInterface.entityTypeId, propertyIndex);
+        pfnSet(entity, &value);
+        return true;
+    }
+
+    template<typename T>
+    bool SetProperty(const EntityInterface& entityInterface, void* entity, std::string_view name, const T& value) {
+        return SetProperty<T>(entityInterface, entity, entityInterface.propertyNamePerfectHash(name), value);
+    }
+
     template<Entity TEntity>
     struct EntityQueryResult {
         std::vector<std::span<TEntity>> results;
@@ -141,6 +278,17 @@ namespace lpg {
         EntityID id = 0;
     };
 
+    /*
+     * Declares a component that is stored out of line, in a page linked to the owner's page:
+     *
+     * struct Npc {
+     *     al::Vec3f position;
+     *     LPG_NO_UNIQUE_ADDRESS Managed<DialogueState> dialogue;
+     * };
+     *
+     * The component is default-constructed when the owner is spawned and destroyed when it is despawned.
+     * Use World::getManaged to reach it, or query its entity type directly.
+     */
     template<Entity TEntity>
     struct Managed {
         using IsManagedComponent = void;
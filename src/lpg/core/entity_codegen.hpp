@@ -9,13 +9,26 @@
 #define LPG_ENGINE_SRC_LPG_CORE_ENTITY_CODEGEN_HPP_
 
 #include <reflect>
+#include <mph>
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <initializer_list>
+#include <memory>
 #include <ranges>
+#include <span>
+#include <string_view>
+#include <tuple>
+#include <utility>
 #include <vector>
 #include <typeindex>
 #include <concepts>
 #include "data.hpp"
 #include "message.hpp"
 #include "entity.hpp"
+#include "json.hpp"
+#include "quantize.hpp"
+#include "../math/TransformKernels.hpp"
 
 #include <axxegro/com/math/math.hpp>
 #include <axxegro/core/Transform.hpp>
@@ -33,32 +46,532 @@ namespace lpg {
         return (Default); \
     }()
 
+        /*
+         * A ComponentInfo whose entity type id is not known yet. Type ids are handed out at runtime,
+         * so the layouts below are constexpr and the ids are filled in once per process.
+         */
+        struct ComponentLayout {
+            int32_t (*entityTypeId)();
+            std::string_view name;
+            int position;
+            int offset;
+        };
+
+        template<int I, typename TEntity>
+        inline constexpr bool IsMemberEmbeddedComponent() {
+            using FieldType = refl::member_type<I, TEntity>;
+            return refl::has_member_attr<IsComponent, I, TEntity>() || requires{typename FieldType::IsEntity;};
+        }
+
+        template<int I, typename TEntity>
+        inline constexpr bool IsMemberManagedComponent() {
+            return requires{typename refl::member_type<I, TEntity>::IsManagedComponent;};
+        }
+
+        template<typename TEntity>
+        inline constexpr int NumEmbeddedComponents();
+
+        template<int I, typename TEntity>
+        inline constexpr int NumEmbeddedComponentsOfMember() {
+            if constexpr(IsMemberEmbeddedComponent<I, TEntity>()) {
+                return 1 + NumEmbeddedComponents<refl::member_type<I, TEntity>>();
+            } else {
+                return 0;
+            }
+        }
+
+        template<typename TEntity>
+        inline constexpr int NumEmbeddedComponents() {
+            return []<int... Is>(std::integer_sequence<int, Is...>) {
+                return (0 + ... + NumEmbeddedComponentsOfMember<Is, TEntity>());
+            }(std::make_integer_sequence<int, refl::num_data_members<TEntity>()>{});
+        }
+
+        /*
+         * Appends the embedded components of TEntity, depth first, with offsets relative to the outermost entity.
+         */
+        template<typename TEntity, size_t N>
+        inline constexpr void AppendEmbeddedComponents(std::array<ComponentLayout, N>& out, int& count, int baseOffset) {
+            [&]<int... Is>(std::integer_sequence<int, Is...>) {
+                ([&]() {
+                    if constexpr(IsMemberEmbeddedComponent<Is, TEntity>()) {
+                        using FieldType = refl::member_type<Is, TEntity>;
+                        int fieldOffset = baseOffset + refl::member_offset<Is, TEntity>();
+                        out[count++] = ComponentLayout {
+                            .entityTypeId = &GetEntityTypeId<FieldType>,
+                            .name = refl::member_name<Is, TEntity>(),
+                            .position = Is,
+                            .offset = fieldOffset
+                        };
+                        AppendEmbeddedComponents<FieldType>(out, count, fieldOffset);
+                    }
+                }(), ...);
+            }(std::make_integer_sequence<int, refl::num_data_members<TEntity>()>{});
+        }
+
+        template<size_t N>
+        std::array<ComponentInfo, N> ResolveComponentLayouts(const std::array<ComponentLayout, N>& layouts) {
+            std::array<ComponentInfo, N> result {};
+            for (size_t i = 0; i < N; i++) {
+                result[i] = ComponentInfo {
+                    .entityTypeId = layouts[i].entityTypeId(),
+                    .name = layouts[i].name,
+                    .position = layouts[i].position,
+                    .offset = layouts[i].offset
+                };
+            }
+            return result;
+        }
+
+        template<typename TEntity, typename TMessage>
+        struct MessageHandlers {
+            static void Send(void* vpMsg, void* vpEnt) {
+                static_cast<TEntity*>(vpEnt)->msg(static_cast<TMessage*>(vpMsg));
+            }
+
+            static void SendToMany(void* vpMsg, TypeErasedStridedSpan tssEntities) {
+                TMessage* message = static_cast<TMessage*>(vpMsg);
+                for (auto& entity: tssEntities.interpretAs<TEntity>()) {
+                    entity.msg(message);
+                }
+            }
+
+            static void SendToManyContiguous(void* vpMsg, void* vpArrEnt, size_t arrSize) {
+                TMessage* message = static_cast<TMessage*>(vpMsg);
+                TEntity* firstEntity = static_cast<TEntity*>(vpArrEnt);
+                for (auto& entity: std::span {firstEntity, firstEntity + arrSize}) {
+                    entity.msg(message);
+                }
+            }
+        };
+
+        struct MessageHandlerLayout {
+            int32_t (*messageTypeId)();
+            void (*sendMessage)(void*, void*);
+            void (*sendMessageToMany)(void*, TypeErasedStridedSpan);
+            void (*sendMessageToManyContiguous)(void*, void*, size_t);
+        };
+
+        template<typename TTag>
+        inline constexpr bool IsMessageHandlerTag() {
+            return requires{typename std::remove_cvref_t<TTag>::LPGHandlesMessageTag;};
+        }
+
+        template<typename TEntity, typename... TTags>
+        inline constexpr auto MakeMessageHandlerLayouts(std::tuple<TTags...>*) {
+            std::array<MessageHandlerLayout, (0 + ... + (IsMessageHandlerTag<TTags>() ? 1 : 0))> result {};
+            int count = 0;
+            ([&]() {
+                if constexpr(IsMessageHandlerTag<TTags>()) {
+                    using Handlers = MessageHandlers<TEntity, typename std::remove_cvref_t<TTags>::Type>;
+                    result[count++] = MessageHandlerLayout {
+                        .messageTypeId = &GetMessageTypeId<typename std::remove_cvref_t<TTags>::Type>,
+                        .sendMessage = &Handlers::Send,
+                        .sendMessageToMany = &Handlers::SendToMany,
+                        .sendMessageToManyContiguous = &Handlers::SendToManyContiguous
+                    };
+                }
+            }(), ...);
+            return result;
+        }
+
+        template<size_t N>
+        inline constexpr bool AreMessageHandlersUnique(const std::array<MessageHandlerLayout, N>& layouts) {
+            for (size_t i = 0; i < N; i++) {
+                for (size_t j = i + 1; j < N; j++) {
+                    if (layouts[i].messageTypeId == layouts[j].messageTypeId) {
+                        return false;
+                    }
+                }
+            }
+            return true;
+        }
+
+        /*
+         * Handler tables indexed by message type id, as EntityInterface expects them.
+         */
+        struct MessageHandlerTables {
+            std::vector<void(*)(void*, void*)> sendMessage;
+            std::vector<void(*)(void*, TypeErasedStridedSpan)> sendMessageToMany;
+            std::vector<void(*)(void*, void*, size_t)> sendMessageToManyContiguous;
+        };
+
+        inline MessageHandlerTables ResolveMessageHandlerLayouts(std::span<const MessageHandlerLayout> layouts) {
+            MessageHandlerTables result;
+            for (const auto& layout: layouts) {
+                auto messageTypeId = layout.messageTypeId();
+                if (result.sendMessage.size() <= messageTypeId) {
+                    result.sendMessage.resize(messageTypeId + 1, nullptr);
+                    result.sendMessageToMany.resize(messageTypeId + 1, nullptr);
+                    result.sendMessageToManyContiguous.resize(messageTypeId + 1, nullptr);
+                }
+                result.sendMessage[messageTypeId] = layout.sendMessage;
+                result.sendMessageToMany[messageTypeId] = layout.sendMessageToMany;
+                result.sendMessageToManyContiguous[messageTypeId] = layout.sendMessageToManyContiguous;
+            }
+            return result;
+        }
+
+        /*
+         * Everything in EntityInterface that can be computed without runtime type ids is a constexpr table here,
+         * so building an interface only stores pointers to them. The rest is resolved on first use and cached.
+         */
         template<typename TEntity>
-        inline std::vector<ComponentInfo> GetEntityEmbeddedComponentsInfo(int baseOffset = 0) {
-            std::vector<ComponentInfo> result;
+        struct EntityTables {
+            static constexpr int NumProperties = refl::num_data_members<TEntity>();
+
+            template<int I>
+            static void* GetProperty(void* entity) {
+                return static_cast<std::byte*>(entity) + refl::member_offset<I, TEntity>();
+            }
 
-            refl::for_each_decl<TEntity>([&](auto I) {
+            template<int I>
+            static void SetProperty(void* entity, const void* value) {
                 using FieldType = refl::member_type<I, TEntity>;
+                auto* field = reinterpret_cast<FieldType*>(static_cast<std::byte*>(entity) + refl::member_offset<I, TEntity>());
+                *field = *static_cast<const FieldType*>(value);
+            }
+
+            template<int I>
+            static constexpr auto GetPropertySetter() -> void(*)(void*, const void*) {
+                if constexpr(not refl::is_member_const<I, TEntity>() && std::is_copy_assignable_v<refl::member_type<I, TEntity>>) {
+                    return &SetProperty<I>;
+                } else {
+                    return nullptr;
+                }
+            }
+
+            static constexpr auto Properties = []<int... Is>(std::integer_sequence<int, Is...>) {
+                return std::array<PropertyInfo, NumProperties> {PropertyInfo {
+                    .name = refl::member_name<Is, TEntity>(),
+                    .position = Is,
+                    .offset = static_cast<int>(refl::member_offset<Is, TEntity>()),
+                    .size = sizeof(refl::member_type<Is, TEntity>),
+                    .typeKey = GetTypeKey<refl::member_type<Is, TEntity>>(),
+                    .isConst = refl::is_member_const<Is, TEntity>()
+                }...};
+            }(std::make_integer_sequence<int, NumProperties>{});
+
+            static constexpr auto PropertyGetters = []<int... Is>(std::integer_sequence<int, Is...>) {
+                return std::array<void*(*)(void*), NumProperties> {&GetProperty<Is>...};
+            }(std::make_integer_sequence<int, NumProperties>{});
+
+            static constexpr auto PropertySetters = []<int... Is>(std::integer_sequence<int, Is...>) {
+                return std::array<void(*)(void*, const void*), NumProperties> {GetPropertySetter<Is>()...};
+            }(std::make_integer_sequence<int, NumProperties>{});
 
-                if constexpr(refl::has_member_attr<IsComponent, I, TEntity>() || requires{typename FieldType::IsEntity;}) {
-                    int fieldOffset = baseOffset + refl::member_offset<I, TEntity>();
-                    result.push_back(ComponentInfo {
-                        .name = refl::member_name<I, TEntity>(),
-                        .offset = fieldOffset,
-                        .position = I,
-                        .entityTypeId = GetEntityTypeId<TEntity>()
-                    });
+            static constexpr auto EmbeddedComponentLayouts = []() {
+                std::array<ComponentLayout, NumEmbeddedComponents<TEntity>()> result {};
+                int count = 0;
+                AppendEmbeddedComponents<TEntity>(result, count, 0);
+                return result;
+            }();
 
-                    auto subResult = GetEntityEmbeddedComponentsInfo<FieldType>(fieldOffset);
-                    result.insert(result.end(), subResult.begin(), subResult.end());
+            static constexpr auto ManagedComponentLayouts = []() {
+                constexpr int NumManaged = []<int... Is>(std::integer_sequence<int, Is...>) {
+                    return (0 + ... + (IsMemberManagedComponent<Is, TEntity>() ? 1 : 0));
+                }(std::make_integer_sequence<int, NumProperties>{});
+
+                std::array<ComponentLayout, NumManaged> result {};
+                int count = 0;
+                [&]<int... Is>(std::integer_sequence<int, Is...>) {
+                    ([&]() {
+                        if constexpr(IsMemberManagedComponent<Is, TEntity>()) {
+                            result[count++] = ComponentLayout {
+                                .entityTypeId = &GetEntityTypeId<typename refl::member_type<Is, TEntity>::EntityType>,
+                                .name = refl::member_name<Is, TEntity>(),
+                                .position = Is,
+                                .offset = -1
+                            };
+                        }
+                    }(), ...);
+                }(std::make_integer_sequence<int, NumProperties>{});
+                return result;
+            }();
+
+            static constexpr auto MessageHandlerLayouts = MakeMessageHandlerLayouts<TEntity>(
+                static_cast<std::remove_cvref_t<decltype(refl::all_type_tags<TEntity>())>*>(nullptr)
+            );
+            static_assert(
+                AreMessageHandlersUnique(MessageHandlerLayouts),
+                "LPG_MESSAGE_HANDLER must appear exactly once for each message type"
+            );
+
+            static std::span<const ComponentInfo> GetEmbeddedComponents() {
+                static const auto result = ResolveComponentLayouts(EmbeddedComponentLayouts);
+                return result;
+            }
+
+            static std::span<const ComponentInfo> GetManagedComponents() {
+                static const auto result = ResolveComponentLayouts(ManagedComponentLayouts);
+                return result;
+            }
+
+            static const MessageHandlerTables& GetMessageHandlers() {
+                static const auto result = ResolveMessageHandlerLayouts(MessageHandlerLayouts);
+                return result;
+            }
+        };
+
+        /*
+         * Compile-time table of property names. Values are index + 1 so that 0 can mean "not found".
+         */
+        template<typename TEntity>
+        struct PropertyNameTable {
+            static constexpr int NumProperties = refl::num_data_members<TEntity>();
+
+            static constexpr auto Entries = []() {
+                std::array<std::pair<std::string_view, int>, NumProperties> result {};
+                [&]<int... Is>(std::integer_sequence<int, Is...>) {
+                    ((result[Is] = {refl::member_name<Is, TEntity>(), Is + 1}), ...);
+                }(std::make_integer_sequence<int, NumProperties>{});
+                return result;
+            }();
+
+            static constexpr size_t MaxNameLength = []() {
+                size_t result = 0;
+                for (const auto& [name, value]: Entries) {
+                    result = std::max(result, name.size());
                 }
+                return result;
+            }();
+
+            // mph requires every key to fit in 128 bits
+            static constexpr bool UsePerfectHash = NumProperties > 0 && MaxNameLength <= 16;
+        };
+
+        template<typename TEntity>
+        int32_t LookupPropertyIndex(std::string_view name) {
+            using Table = PropertyNameTable<TEntity>;
+            int value = 0;
+            if constexpr(Table::UsePerfectHash) {
+                value = mph::lookup<Table::Entries>(name);
+            } else {
+                auto it = std::ranges::find(Table::Entries, name, &std::pair<std::string_view, int>::first);
+                value = (it != Table::Entries.end()) ? it->second : 0;
+            }
+            if (value == 0 || Table::Entries[value - 1].first != name) {
+                return -1;
+            }
+            return value - 1;
+        }
+
+        template<typename TEntity>
+        inline constexpr bool IsTriviallyRelocatable() {
+            if constexpr(std::is_trivially_copyable_v<TEntity> || requires{typename TEntity::IsTriviallyRelocatable;}) {
+                return true;
+            } else {
+#if defined(__has_builtin)
+#if __has_builtin(__is_trivially_relocatable)
+                return __is_trivially_relocatable(TEntity);
+#endif
+#endif
+                return false;
+            }
+        }
+
+        template<int I, typename TEntity>
+        inline constexpr bool IsMemberArchived() {
+            if constexpr(refl::has_member_attr<DoNotSerialize, I, TEntity>()) {
+                return false;
+            } else if constexpr(refl::has_member_attr<RValFlags, I, TEntity>()) {
+                return refl::member_attr<RValFlags, I, TEntity>().archive;
+            } else {
+                return true;
+            }
+        }
+
+        /*
+         * Containers written as JSON arrays: growable ones are cleared and refilled on read,
+         * fixed-size ones (std::array and the like) are read element by element.
+         */
+        template<typename T>
+        concept JsonGrowableContainer = requires(T container) {
+            typename T::value_type;
+            container.begin();
+            container.end();
+            container.clear();
+            container.emplace_back();
+        };
 
+        template<typename T>
+        concept JsonFixedSizeContainer = not JsonGrowableContainer<T> && requires(T container) {
+            typename T::value_type;
+            container.begin();
+            container.end();
+            std::tuple_size<T>::value;
+        };
+
+        template<typename T>
+        inline constexpr bool IsJsonSerializable() {
+            if constexpr(std::is_arithmetic_v<T> || std::is_enum_v<T> || al::VectorType<T>) {
+                return true;
+            } else if constexpr(std::same_as<T, std::string> || std::same_as<T, InternedString>) {
+                return true;
+            } else if constexpr(requires(T asset){T::Type; asset.path;}) {
+                return IsJsonSerializable<decltype(T::path)>();
+            } else if constexpr(JsonGrowableContainer<T> || JsonFixedSizeContainer<T>) {
+                return IsJsonSerializable<typename T::value_type>();
+            } else if constexpr(requires{typename T::value_type;}) {
+                // other ranges (maps, sets, views) have no array representation
+                return false;
+            } else {
+                return std::is_aggregate_v<T> && std::is_class_v<T>;
+            }
+        }
+
+        /*
+         * Members that are neither archived nor representable in JSON (pointers, handles, etc.)
+         * are left out of the document and keep their current value when reading.
+         */
+        template<int I, typename TEntity>
+        inline constexpr bool IsMemberSerialized() {
+            return IsMemberArchived<I, TEntity>() && IsJsonSerializable<refl::member_type<I, TEntity>>();
+        }
+
+        template<typename T>
+        void WriteJsonValue(JsonWriter& writer, const T& value);
+
+        template<typename T>
+        bool ReadJsonValue(JsonReader& reader, T& value);
+
+        template<typename T>
+        void WriteJsonObject(JsonWriter& writer, const T& object) {
+            writer.beginObject();
+            refl::for_each_decl<T>([&](auto I) {
+                if constexpr(IsMemberSerialized<I, T>()) {
+                    writer.key(refl::member_name<I, T>());
+                    WriteJsonValue(writer, refl::get<I>(object));
+                }
             });
+            writer.endObject();
+        }
 
-            return result;
+        /*
+         * Keys are dispatched through LookupPropertyIndex to a per-field reader. Unknown keys,
+         * const members and members that are not serialized are skipped; missing keys keep their value.
+         */
+        template<typename T>
+        bool ReadJsonObject(JsonReader& reader, T& object) {
+            using FieldReader = bool (*)(JsonReader&, T&);
+            static const auto fieldReaders = []() {
+                std::array<FieldReader, refl::num_data_members<T>()> result {};
+                refl::for_each_decl<T>([&](auto I) {
+                    static constexpr int Index = I;
+                    if constexpr(IsMemberSerialized<Index, T>() && not refl::is_member_const<Index, T>()) {
+                        result[Index] = [](JsonReader& reader, T& object) {
+                            return ReadJsonValue(reader, refl::get<Index>(object));
+                        };
+                    }
+                });
+                return result;
+            }();
+
+            if (not reader.beginObject()) {
+                return false;
+            }
+            std::string_view key;
+            while (reader.nextKey(key)) {
+                int32_t index = LookupPropertyIndex<T>(key);
+                FieldReader fieldReader = (index >= 0) ? fieldReaders[index] : nullptr;
+                bool ok = fieldReader ? fieldReader(reader, object) : reader.skipValue();
+                if (not ok) {
+                    return false;
+                }
+            }
+            return not reader.failed();
+        }
 
+        template<typename T>
+        void WriteJsonValue(JsonWriter& writer, const T& value) {
+            if constexpr(std::is_arithmetic_v<T>) {
+                writer.value(value);
+            } else if constexpr(std::is_enum_v<T>) {
+                writer.value(static_cast<std::underlying_type_t<T>>(value));
+            } else if constexpr(al::VectorType<T>) {
+                writer.beginArray();
+                for (int i = 0; i < T::NumElements; i++) {
+                    writer.value(value[i]);
+                }
+                writer.endArray();
+            } else if constexpr(std::same_as<T, std::string> || std::same_as<T, InternedString>) {
+                writer.value(std::string_view(value));
+            } else if constexpr(requires{T::Type; value.path;}) {
+                WriteJsonValue(writer, value.path);
+            } else if constexpr(JsonGrowableContainer<T> || JsonFixedSizeContainer<T>) {
+                writer.beginArray();
+                for (const auto& element: value) {
+                    WriteJsonValue(writer, element);
+                }
+                writer.endArray();
+            } else {
+                WriteJsonObject(writer, value);
+            }
         }
 
+        template<typename T>
+        bool ReadJsonValue(JsonReader& reader, T& value) {
+            if constexpr(std::is_arithmetic_v<T>) {
+                return reader.read(value);
+            } else if constexpr(std::is_enum_v<T>) {
+                auto underlying = static_cast<std::underlying_type_t<T>>(value);
+                if (not reader.read(underlying)) {
+                    return false;
+                }
+                value = static_cast<T>(underlying);
+                return true;
+            } else if constexpr(al::VectorType<T>) {
+                if (not reader.beginArray()) {
+                    return false;
+                }
+                int i = 0;
+                while (reader.nextElement()) {
+                    bool ok = (i < T::NumElements) ? reader.read(value[i]) : reader.skipValue();
+                    if (not ok) {
+                        return false;
+                    }
+                    i++;
+                }
+                return not reader.failed();
+            } else if constexpr(std::same_as<T, std::string>) {
+                return reader.read(value);
+            } else if constexpr(std::same_as<T, InternedString>) {
+                std::string str;
+                if (not reader.read(str)) {
+                    return false;
+                }
+                value = InternedString(str);
+                return true;
+            } else if constexpr(requires{T::Type; value.path;}) {
+                return ReadJsonValue(reader, value.path);
+            } else if constexpr(JsonGrowableContainer<T>) {
+                if (not reader.beginArray()) {
+                    return false;
+                }
+                value.clear();
+                while (reader.nextElement()) {
+                    if (not ReadJsonValue(reader, value.emplace_back())) {
+                        return false;
+                    }
+                }
+                return not reader.failed();
+            } else if constexpr(JsonFixedSizeContainer<T>) {
+                // like vectors: extra elements are skipped, missing ones keep their value
+                if (not reader.beginArray()) {
+                    return false;
+                }
+                auto it = value.begin();
+                while (reader.nextElement()) {
+                    bool ok = (it != value.end()) ? ReadJsonValue(reader, *it++) : reader.skipValue();
+                    if (not ok) {
+                        return false;
+                    }
+                }
+                return not reader.failed();
+            } else {
+                return ReadJsonObject(reader, value);
+            }
+        }
 
         template<typename TEntity>
         al::Vec3f EntGetPosition(const TEntity& entity) {
@@ -92,6 +605,204 @@ namespace lpg {
             return LPG_DATA_MEMBER_OR_DEFAULT(entity, localRotation, al::Vec3f{});
         }
 
+        template<typename TAttrTuple>
+        struct FindQuantizeEncoding {
+            using type = void;
+        };
+
+        template<typename TFirst, typename... TRest>
+        struct FindQuantizeEncoding<std::tuple<TFirst, TRest...>> {
+            using type = typename std::conditional_t<
+                requires{typename TFirst::Encoding;},
+                std::type_identity<TFirst>,
+                FindQuantizeEncoding<std::tuple<TRest...>>
+            >::type;
+        };
+
+        /*
+         * The encoding named by the member's Quantize attribute, or void if it has none.
+         */
+        template<int I, typename TEntity>
+        inline constexpr auto GetMemberQuantizeEncoding() {
+            if constexpr(refl::has_attributes<I, TEntity>()) {
+                using Attr = typename FindQuantizeEncoding<std::remove_cvref_t<decltype(refl::member_attr_list<I, TEntity>())>>::type;
+                if constexpr(not std::is_void_v<Attr>) {
+                    return std::type_identity<typename Attr::Encoding>{};
+                } else {
+                    return std::type_identity<void>{};
+                }
+            } else {
+                return std::type_identity<void>{};
+            }
+        }
+
+        template<int I, typename TEntity>
+        using MemberQuantizeEncoding = typename decltype(GetMemberQuantizeEncoding<I, TEntity>())::type;
+
+        template<typename T>
+        inline constexpr int NumScalarElements() {
+            if constexpr(al::VectorType<T>) {
+                return T::NumElements;
+            } else {
+                return 1;
+            }
+        }
+
+        template<typename TEntity>
+        struct PackedLayout {
+            static constexpr int NumMembers = refl::num_data_members<TEntity>();
+
+            template<int I>
+            static constexpr int PackedMemberSize() {
+                using FieldType = refl::member_type<I, TEntity>;
+                using Encoding = MemberQuantizeEncoding<I, TEntity>;
+                if constexpr(std::is_void_v<Encoding>) {
+                    return sizeof(FieldType);
+                } else {
+                    return NumScalarElements<FieldType>() * sizeof(typename quant::Codec<Encoding>::Packed);
+                }
+            }
+
+            static constexpr auto Offsets = []() {
+                std::array<int, NumMembers + 1> result {};
+                [&]<int... Is>(std::integer_sequence<int, Is...>) {
+                    ((result[Is + 1] = result[Is] + PackedMemberSize<Is>()), ...);
+                }(std::make_integer_sequence<int, NumMembers>{});
+                return result;
+            }();
+
+            static constexpr int Size = Offsets[NumMembers];
+
+            template<int I>
+            static void PackMember(const TEntity& entity, std::byte* packed) {
+                using FieldType = refl::member_type<I, TEntity>;
+                using Encoding = MemberQuantizeEncoding<I, TEntity>;
+                const auto& field = refl::get<I>(entity);
+                std::byte* dst = packed + Offsets[I];
+
+                if constexpr(std::is_void_v<Encoding>) {
+                    std::memcpy(dst, &field, sizeof(FieldType));
+                } else {
+                    using Codec = quant::Codec<Encoding>;
+                    auto [min, max] = GetRange<I>();
+                    for (int e = 0; e < NumScalarElements<FieldType>(); e++) {
+                        double value;
+                        if constexpr(al::VectorType<FieldType>) {
+                            value = field[e];
+                        } else {
+                            value = field;
+                        }
+                        typename Codec::Packed encoded = Codec::Pack(value, min, max);
+                        std::memcpy(dst + e * sizeof(encoded), &encoded, sizeof(encoded));
+                    }
+                }
+            }
+
+            /*
+             * Writes through the entity's bytes rather than the member, so that const members are restored too.
+             */
+            template<int I>
+            static void UnpackMember(const std::byte* packed, TEntity& entity) {
+                using FieldType = std::remove_cv_t<refl::member_type<I, TEntity>>;
+                using Encoding = MemberQuantizeEncoding<I, TEntity>;
+                std::byte* dst = reinterpret_cast<std::byte*>(&entity) + refl::member_offset<I, TEntity>();
+                const std::byte* src = packed + Offsets[I];
+
+                if constexpr(std::is_void_v<Encoding>) {
+                    std::memcpy(dst, src, sizeof(FieldType));
+                } else {
+                    using Codec = quant::Codec<Encoding>;
+                    auto [min, max] = GetRange<I>();
+                    FieldType field {};
+                    for (int e = 0; e < NumScalarElements<FieldType>(); e++) {
+                        typename Codec::Packed encoded;
+                        std::memcpy(&encoded, src + e * sizeof(encoded), sizeof(encoded));
+                        double value = Codec::Unpack(encoded, min, max);
+                        if constexpr(al::VectorType<FieldType>) {
+                            field[e] = static_cast<std::remove_cvref_t<decltype(field[e])>>(value);
+                        } else {
+                            field = static_cast<FieldType>(value);
+                        }
+                    }
+                    std::memcpy(dst, &field, sizeof(FieldType));
+                }
+            }
+
+            template<int I>
+            static constexpr std::pair<double, double> GetRange() {
+                using Codec = quant::Codec<MemberQuantizeEncoding<I, TEntity>>;
+                if constexpr(Codec::NeedsRange) {
+                    static_assert(
+                        refl::has_member_attr<MinValue, I, TEntity>() && refl::has_member_attr<MaxValue, I, TEntity>(),
+                        "FixedPoint quantization requires both MinValue and MaxValue"
+                    );
+                    return {refl::member_attr<MinValue, I, TEntity>().val, refl::member_attr<MaxValue, I, TEntity>().val};
+                } else {
+                    return {0.0, 0.0};
+                }
+            }
+
+            static void PackRange(const void* vpEntities, size_t count, void* vpPacked) {
+                const TEntity* entities = static_cast<const TEntity*>(vpEntities);
+                std::byte* packed = static_cast<std::byte*>(vpPacked);
+                for (size_t i = 0; i < count; i++) {
+                    [&]<int... Is>(std::integer_sequence<int, Is...>) {
+                        (PackMember<Is>(entities[i], packed + i * Size), ...);
+                    }(std::make_integer_sequence<int, NumMembers>{});
+                }
+            }
+
+            static void UnpackRange(const void* vpPacked, size_t count, void* vpEntities) {
+                TEntity* entities = static_cast<TEntity*>(vpEntities);
+                const std::byte* packed = static_cast<const std::byte*>(vpPacked);
+                for (size_t i = 0; i < count; i++) {
+                    [&]<int... Is>(std::integer_sequence<int, Is...>) {
+                        (UnpackMember<Is>(packed + i * Size, entities[i]), ...);
+                    }(std::make_integer_sequence<int, NumMembers>{});
+                }
+            }
+        };
+
+        /*
+         * Counts a read of the named fields of count entities, for those fields TEntity has.
+         * Compiles to nothing unless the field access profiler is enabled.
+         */
+        template<typename TEntity>
+        void RecordFieldReads([[maybe_unused]] std::initializer_list<std::string_view> fieldNames, [[maybe_unused]] size_t count) {
+#ifdef LPG_ENABLE_FIELD_ACCESS_PROFILER
+            for (auto fieldName: fieldNames) {
+                if (int32_t index = LookupPropertyIndex<TEntity>(fieldName); index >= 0) {
+                    profiler::RecordFieldAccess(GetEntityTypeId<TEntity>(), index, count, 0);
+                }
+            }
+#endif
+        }
+
+        /*
+         * Instantiates a strided and a contiguous batch accessor from a per-entity function,
+         * so the loop is compiled once per entity type with the accessor inlined.
+         * TPRecordReads(count) reports the fields it reads to the field access profiler.
+         */
+        template<typename TEntity, typename TOut, auto TPFn, auto TPRecordReads>
+        struct BatchAccessor {
+            static void Strided(TypeErasedStridedSpan tssEntities, TOut* out) {
+                auto entities = tssEntities.interpretAs<TEntity>();
+                size_t count = entities.size();
+                TPRecordReads(count);
+                for (size_t i = 0; i < count; i++) {
+                    TPFn(entities[i], out[i]);
+                }
+            }
+
+            static void Contiguous(void* vpFirst, size_t count, TOut* out) {
+                const TEntity* first = static_cast<const TEntity*>(vpFirst);
+                TPRecordReads(count);
+                for (size_t i = 0; i < count; i++) {
+                    TPFn(first[i], out[i]);
+                }
+            }
+        };
+
         template<typename TEntity>
         void EntApplyTransform(const TEntity& entity, al::Transform& transform) {
             if constexpr(reflect::has_member_name<TEntity, "rotation">) {
@@ -105,6 +816,60 @@ namespace lpg {
             }
         }
 
+        /*
+         * EntApplyTransform over a batch, for entity types with a rotation, where al::Transform::rotate dominates:
+         * BlockSize entities at a time are gathered into arrays, turned into matrices with math::ComposeTRS
+         * and composed onto inOut with math::Compose. inOut is taken to be affine, as al::Transform::translate does.
+         */
+        template<typename TEntity>
+        struct TransformBatchAccessor {
+            static constexpr size_t BlockSize = 64;
+
+            static void Strided(TypeErasedStridedSpan tssEntities, al::Transform* inOut) {
+                auto entities = tssEntities.interpretAs<TEntity>();
+                Accumulate(entities, entities.size(), inOut);
+            }
+
+            static void Contiguous(void* vpFirst, size_t count, al::Transform* inOut) {
+                Accumulate(static_cast<const TEntity*>(vpFirst), count, inOut);
+            }
+
+        private:
+            static void Accumulate(const auto& entities, size_t count, al::Transform* inOut) {
+                RecordFieldReads<TEntity>({"rotation", "scale", "position"}, count);
+
+                // translation, angles, scale, then the matrices of the entities and of inOut
+                alignas(32) float storage[(9 + 16 + 16) * BlockSize];
+                auto vec3 = [&](size_t at) {
+                    return math::Vec3fArrays {&storage[at], &storage[at + BlockSize], &storage[at + 2 * BlockSize]};
+                };
+                auto mat4 = [&](size_t at) {
+                    math::Mat4Arrays result;
+                    for (int k = 0; k < 16; k++) {
+                        result.m[k] = &storage[at + k * BlockSize];
+                    }
+                    return result;
+                };
+                auto translation = vec3(0), angles = vec3(3 * BlockSize), scale = vec3(6 * BlockSize);
+                auto local = mat4(9 * BlockSize), accumulated = mat4(25 * BlockSize);
+
+                for (size_t first = 0; first < count; first += BlockSize) {
+                    size_t blockCount = std::min(BlockSize, count - first);
+                    for (size_t i = 0; i < blockCount; i++) {
+                        const TEntity& entity = entities[first + i];
+                        al::Vec3f position = EntGetPosition(entity), rotation = EntGetRotation(entity), entityScale = EntGetScale(entity);
+                        translation.x[i] = position.x, translation.y[i] = position.y, translation.z[i] = position.z;
+                        angles.x[i] = rotation.x, angles.y[i] = rotation.y, angles.z[i] = rotation.z;
+                        scale.x[i] = entityScale.x, scale.y[i] = entityScale.y, scale.z[i] = entityScale.z;
+                    }
+                    math::ComposeTRS(translation, angles, scale, local, blockCount);
+                    math::LoadTransforms(inOut + first, accumulated, blockCount);
+                    math::Compose(accumulated, local, accumulated, blockCount);
+                    math::StoreTransforms(accumulated, inOut + first, blockCount);
+                }
+            }
+        };
+
         template<typename TEntity>
         void EntApplyLocalTransform(const TEntity& entity, al::Transform& transform) {
             if constexpr(reflect::has_member_name<TEntity, "rotation">) {
@@ -122,64 +887,187 @@ namespace lpg {
 
 
 
+    /*
+     * Builds the interface of TEntity. All of its tables are static data owned by the generated code,
+     * so this only stores pointers; prefer GetEntityInterface, which builds it once per process.
+     */
     template<typename TEntity>
-    inline EntityInterface CreateEntityInterface(MessageRegistry& registry) {
+    inline EntityInterface CreateEntityInterface() {
+        using Tables = detail::EntityTables<TEntity>;
         EntityInterface result {};
 
         result.name = reflect::type_name<TEntity>();
+        result.entityTypeId = detail::GetEntityTypeId<TEntity>();
 
         result.entitySize = sizeof(TEntity);
         result.entityAlign = alignof(TEntity);
 
-        result.embeddedComponents = detail::GetEntityEmbeddedComponentsInfo<TEntity>();
+        result.embeddedComponents = Tables::GetEmbeddedComponents();
+
+        result.managedComponents = Tables::GetManagedComponents();
+
+        if constexpr(std::is_trivially_copyable_v<TEntity>) {
+            result.packedSize = detail::PackedLayout<TEntity>::Size;
+            result.packRange = &detail::PackedLayout<TEntity>::PackRange;
+            result.unpackRange = &detail::PackedLayout<TEntity>::UnpackRange;
+        }
+
+        result.propertyNamePerfectHash = &detail::LookupPropertyIndex<TEntity>;
+        result.properties = Tables::Properties;
+        result.getProperty = Tables::PropertyGetters;
+        result.setProperty = Tables::PropertySetters;
+
+        result.toJSON = [](void* entity, std::string& out) {
+            JsonWriter writer(out);
+            detail::WriteJsonObject(writer, *static_cast<const TEntity*>(entity));
+        };
+
+        result.fromJSON = [](void* entity, std::string_view json) {
+            JsonReader reader(json);
+            return detail::ReadJsonObject(reader, *static_cast<TEntity*>(entity));
+        };
+
+        result.readJSON = [](void* entity, JsonReader& reader) {
+            return detail::ReadJsonObject(reader, *static_cast<TEntity*>(entity));
+        };
 
-        //TODO managed components
+        static constexpr bool IsTriviallyCopyable = std::is_trivially_copyable_v<TEntity>;
+        static constexpr bool IsTriviallyRelocatable = detail::IsTriviallyRelocatable<TEntity>();
+        static constexpr bool IsTriviallyDestructible = std::is_trivially_destructible_v<TEntity>;
+
+        result.isTriviallyCopyable = IsTriviallyCopyable;
+        result.isTriviallyRelocatable = IsTriviallyRelocatable;
+        result.isTriviallyDestructible = IsTriviallyDestructible;
+
+        if constexpr(std::is_default_constructible_v<TEntity>) {
+            result.constructDefault = [](void* entity) {
+                std::construct_at(static_cast<TEntity*>(entity));
+            };
+        }
 
         result.destroy = [](void* entity) {
             TEntity* entityPtr = static_cast<TEntity*>(entity);
             std::destroy_at(entityPtr);
         };
 
+        result.destroyRange = [](void* first, size_t count) {
+            if constexpr(not IsTriviallyDestructible) {
+                TEntity* firstPtr = static_cast<TEntity*>(first);
+                std::destroy(firstPtr, firstPtr + count);
+            }
+        };
+
         result.swap = [](void* entity1, void* entity2) {
-            TEntity* entity1Ptr = static_cast<TEntity*>(entity1);
-            TEntity* entity2Ptr = static_cast<TEntity*>(entity2);
-            std::swap(*entity1Ptr, *entity2Ptr);
+            if constexpr(IsTriviallyRelocatable) {
+                alignas(TEntity) std::byte tmp[sizeof(TEntity)];
+                std::memcpy(tmp, entity1, sizeof(TEntity));
+                std::memcpy(entity1, entity2, sizeof(TEntity));
+                std::memcpy(entity2, tmp, sizeof(TEntity));
+            } else {
+                TEntity* entity1Ptr = static_cast<TEntity*>(entity1);
+                TEntity* entity2Ptr = static_cast<TEntity*>(entity2);
+                std::swap(*entity1Ptr, *entity2Ptr);
+            }
         };
 
         result.copy = [](void* entity1, void* entity2) {
-            TEntity* entity1Ptr = static_cast<TEntity*>(entity1);
-            TEntity* entity2Ptr = static_cast<TEntity*>(entity2);
-            *entity1Ptr = *entity2Ptr;
+            if constexpr(IsTriviallyCopyable) {
+                std::memcpy(entity1, entity2, sizeof(TEntity));
+            } else {
+                TEntity* entity1Ptr = static_cast<TEntity*>(entity1);
+                TEntity* entity2Ptr = static_cast<TEntity*>(entity2);
+                *entity1Ptr = *entity2Ptr;
+            }
         };
 
         result.move = [](void* entity1, void* entity2) {
-            TEntity* entity1Ptr = static_cast<TEntity*>(entity1);
-            TEntity* entity2Ptr = static_cast<TEntity*>(entity2);
-            *entity1Ptr = std::move(*entity2Ptr);
+            if constexpr(IsTriviallyCopyable) {
+                std::memcpy(entity1, entity2, sizeof(TEntity));
+            } else {
+                TEntity* entity1Ptr = static_cast<TEntity*>(entity1);
+                TEntity* entity2Ptr = static_cast<TEntity*>(entity2);
+                *entity1Ptr = std::move(*entity2Ptr);
+            }
+        };
+
+        result.relocate = [](void* dst, void* src) {
+            if constexpr(IsTriviallyRelocatable) {
+                std::memcpy(dst, src, sizeof(TEntity));
+            } else {
+                TEntity* srcPtr = static_cast<TEntity*>(src);
+                std::construct_at(static_cast<TEntity*>(dst), std::move(*srcPtr));
+                std::destroy_at(srcPtr);
+            }
         };
-        
+
         result.getPosition = [](void* entity) -> al::Vec3f {
+            detail::RecordFieldReads<TEntity>({"position"}, 1);
             return detail::EntGetPosition(*static_cast<const TEntity*>(entity));
         };
         result.getLocalPosition = [](void* entity) -> al::Vec3f {
+            detail::RecordFieldReads<TEntity>({"localPosition"}, 1);
             return detail::EntGetLocalPosition(*static_cast<const TEntity*>(entity));
         };
 
         result.getScale = [](void* entity) -> al::Vec3f {
+            detail::RecordFieldReads<TEntity>({"scale"}, 1);
             return detail::EntGetScale(*static_cast<const TEntity*>(entity));
         };
         result.getLocalScale = [](void* entity) -> al::Vec3f {
+            detail::RecordFieldReads<TEntity>({"localScale"}, 1);
             return detail::EntGetLocalScale(*static_cast<const TEntity*>(entity));
         };
 
         result.getRotation = [](void* entity) -> al::Vec3f {
+            detail::RecordFieldReads<TEntity>({"rotation"}, 1);
             return detail::EntGetRotation(*static_cast<const TEntity*>(entity));
         };
         result.getLocalRotation = [](void* entity) -> al::Vec3f {
+            detail::RecordFieldReads<TEntity>({"localRotation"}, 1);
             return detail::EntGetLocalRotation(*static_cast<const TEntity*>(entity));
         };
 
+        using PositionAccessor = detail::BatchAccessor<TEntity, al::Vec3f, [](const TEntity& entity, al::Vec3f& out) {
+            out = detail::EntGetPosition(entity);
+        }, [](size_t count) {
+            detail::RecordFieldReads<TEntity>({"position"}, count);
+        }>;
+        using RotationAccessor = detail::BatchAccessor<TEntity, al::Vec3f, [](const TEntity& entity, al::Vec3f& out) {
+            out = detail::EntGetRotation(entity);
+        }, [](size_t count) {
+            detail::RecordFieldReads<TEntity>({"rotation"}, count);
+        }>;
+        using ScaleAccessor = detail::BatchAccessor<TEntity, al::Vec3f, [](const TEntity& entity, al::Vec3f& out) {
+            out = detail::EntGetScale(entity);
+        }, [](size_t count) {
+            detail::RecordFieldReads<TEntity>({"scale"}, count);
+        }>;
+        using IdAccessor = detail::BatchAccessor<TEntity, int32_t, [](const TEntity& entity, int32_t& out) {
+            out = LPG_DATA_MEMBER_OR_DEFAULT(entity, id, -1);
+        }, [](size_t count) {
+            detail::RecordFieldReads<TEntity>({"id"}, count);
+        }>;
+        using TransformAccessor = std::conditional_t<reflect::has_member_name<TEntity, "rotation">, detail::TransformBatchAccessor<TEntity>,
+            detail::BatchAccessor<TEntity, al::Transform, [](const TEntity& entity, al::Transform& inOut) {
+                detail::EntApplyTransform(entity, inOut);
+            }, [](size_t count) {
+                detail::RecordFieldReads<TEntity>({"scale", "position"}, count);
+            }>>;
+
+        result.gatherPositions = &PositionAccessor::Strided;
+        result.gatherRotations = &RotationAccessor::Strided;
+        result.gatherScales = &ScaleAccessor::Strided;
+        result.gatherIds = &IdAccessor::Strided;
+        result.accumulateTransforms = &TransformAccessor::Strided;
+
+        result.gatherPositionsContiguous = &PositionAccessor::Contiguous;
+        result.gatherRotationsContiguous = &RotationAccessor::Contiguous;
+        result.gatherScalesContiguous = &ScaleAccessor::Contiguous;
+        result.gatherIdsContiguous = &IdAccessor::Contiguous;
+        result.accumulateTransformsContiguous = &TransformAccessor::Contiguous;
+
         result.getId = [](void* entity) {
+            detail::RecordFieldReads<TEntity>({"id"}, 1);
             TEntity* entityPtr = static_cast<TEntity*>(entity);
             return LPG_DATA_MEMBER_OR_DEFAULT(*entityPtr, id, -1);
         };
@@ -195,58 +1083,50 @@ namespace lpg {
         };
 
 
-        std::apply([&](auto&&... tpl) {
-            ([&]<typename T>(T&&) {
-                using ArgT = std::remove_cvref_t<T>;
-                if constexpr(requires{typename ArgT::LPGHandlesMessageTag;}) {
-                    using MessageType = typename ArgT::Type;
-                    if (registry.getMessageTypeId<MessageType>() == -1) {
-                        registry.registerMessageType<MessageType>();
-                    }
-                    int messageTypeId = registry.getMessageTypeId<MessageType>();
-                    if (result.sendMessage[messageTypeId] != nullptr) {
-                        throw std::runtime_error(
-                            "LPG_MESSAGE_HANDLER must appear exactly once for each message type, however, a duplicate was detected for "
-                            + std::string(reflect::type_name<MessageType>())
-                            + " when generating code for the entity "
-                            + std::string(reflect::type_name<TEntity>())
-                        );
-                    }
-                    if (result.sendMessage.size() <= messageTypeId) {
-                        result.sendMessage.resize(messageTypeId + 1, nullptr);
-                        result.sendMessageToMany.resize(messageTypeId + 1, nullptr);
-                        result.sendMessageToManyContiguous.resize(messageTypeId + 1, nullptr);
-                    }
-                    result.sendMessage[messageTypeId] = [](void* vpMsg, void* vpEnt) {
-                        TEntity* entity = static_cast<TEntity*>(vpEnt);
-                        MessageType* message = static_cast<MessageType*>(vpMsg);
-                        entity->msg(message);
-                    };
-                    result.sendMessageToMany[messageTypeId] = [](void* vpMsg, TypeErasedStridedSpan tssEntities) {
-                        MessageType* message = static_cast<MessageType*>(vpMsg);
-                        auto entities = tssEntities.interpretAs<TEntity>();
+        const auto& messageHandlers = Tables::GetMessageHandlers();
+        result.sendMessage = messageHandlers.sendMessage;
+        result.sendMessageToMany = messageHandlers.sendMessageToMany;
+        result.sendMessageToManyContiguous = messageHandlers.sendMessageToManyContiguous;
 
-                        for (auto& entity : entities) {
-                            entity->msg(message);
-                        }
-                    };
-                    result.sendMessageToManyContiguous[messageTypeId] = [](void* vpMsg, void* vpArrEnt, size_t arrSize) {
-                        MessageType* message = static_cast<MessageType*>(vpMsg);
-                        TEntity* firstEntity = static_cast<TEntity*>(vpArrEnt);
-                        auto entities = std::span {firstEntity, firstEntity + arrSize};
+        return result;
+    }
 
-                        for (auto& entity : entities) {
-                            entity->msg(message);
-                        }
-                    };
+    /*
+     * The interface of TEntity, built on first use and shared by all Worlds.
+     */
+    template<typename TEntity>
+    const EntityInterface& GetEntityInterface() {
+        static const EntityInterface result = CreateEntityInterface<TEntity>();
+        return result;
+    }
 
-                }
-            }(tpl), ...);
-        }, refl::all_type_tags<TEntity>());
+    /*
+     * Message type ids are the ones World uses (detail::GetMessageTypeId), so the registry is not consulted.
+     */
+    template<typename TEntity>
+    inline EntityInterface CreateEntityInterface(MessageRegistry&) {
+        return GetEntityInterface<TEntity>();
+    }
 
-        return result;
+    namespace detail {
+        template<typename TEntity>
+        bool AutoRegisterEntityType() {
+            static bool registered = (GetAutoRegisteredEntityTypes().push_back(&GetEntityInterface<TEntity>), true);
+            return registered;
+        }
     }
 
+/*
+ * Registers an entity type with every World at finalizeInit, e.g. next to the type's generated code:
+ *
+ * LPG_REGISTER_ENTITY_TYPE(PointLightEntity);
+ *
+ * Registration only records a function pointer during static initialization; the interface is built
+ * when the first World is finalized. Types registered explicitly with World::registerEntityType are not replaced.
+ */
+#define LPG_REGISTER_ENTITY_TYPE(Type) \
+    [[maybe_unused]] static const bool LPG_CONCAT(lpg___entity_type_registered_, __COUNTER__) = ::lpg::detail::AutoRegisterEntityType<Type>()
+
 }
 
 #endif //LPG_ENGINE_SRC_LPG_CORE_ENTITY_CODEGEN_HPP_
@@ -0,0 +1,227 @@
+//
+// Created by volt on 2026-10-19.
+//
+
+
+
+
+#include "json.hpp"
+
+namespace lpg {
+
+    static void AppendUtf8(std::string& out, uint32_t codePoint) {
+        if (codePoint < 0x80) {
+            out.push_back(static_cast<char>(codePoint));
+        } else if (codePoint < 0x800) {
+            out.push_back(static_cast<char>(0xC0 | (codePoint >> 6)));
+            out.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+        } else if (codePoint < 0x10000) {
+            out.push_back(static_cast<char>(0xE0 | (codePoint >> 12)));
+            out.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+            out.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+        } else {
+            out.push_back(static_cast<char>(0xF0 | (codePoint >> 18)));
+            out.push_back(static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F)));
+            out.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+            out.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+        }
+    }
+
+    static bool ParseHex4(std::string_view digits, uint32_t& result) {
+        if (digits.size() < 4) {
+            return false;
+        }
+        auto [ptr, ec] = std::from_chars(digits.data(), digits.data() + 4, result, 16);
+        return ec == std::errc{} && ptr == digits.data() + 4;
+    }
+
+    void JsonWriter::value(std::string_view value) {
+        static constexpr char HexDigits[] = "0123456789abcdef";
+
+        separate();
+        out_.push_back('"');
+        for (char c: value) {
+            switch (c) {
+                case '"': out_.append("\\\""); break;
+                case '\\': out_.append("\\\\"); break;
+                case '\n': out_.append("\\n"); break;
+                case '\r': out_.append("\\r"); break;
+                case '\t': out_.append("\\t"); break;
+                default:
+                    if (static_cast<unsigned char>(c) < 0x20) {
+                        out_.append("\\u00");
+                        out_.push_back(HexDigits[c >> 4]);
+                        out_.push_back(HexDigits[c & 15]);
+                    } else {
+                        out_.push_back(c);
+                    }
+            }
+        }
+        out_.push_back('"');
+        needComma_ = true;
+    }
+
+    bool JsonReader::nextItem(char close) {
+        if (failed_) {
+            return false;
+        }
+        if (tryConsume(close)) {
+            firstItem_ = false;
+            return false;
+        }
+        if (not firstItem_ && not expect(',')) {
+            return false;
+        }
+        firstItem_ = false;
+        skipWhitespace();
+        if (cur_ == end_ || *cur_ == close) {
+            return fail();
+        }
+        return true;
+    }
+
+    bool JsonReader::nextKey(std::string_view& key) {
+        if (not nextItem('}')) {
+            return false;
+        }
+        if (not readRawString(key)) {
+            return false;
+        }
+        return expect(':');
+    }
+
+    bool JsonReader::nextElement() {
+        return nextItem(']');
+    }
+
+    bool JsonReader::read(bool& value) {
+        skipWhitespace();
+        if (readLiteral("true")) {
+            value = true;
+            return true;
+        }
+        if (readLiteral("false")) {
+            value = false;
+            return true;
+        }
+        if (readLiteral("null")) {
+            return true;
+        }
+        return fail();
+    }
+
+    bool JsonReader::read(std::string& value) {
+        skipWhitespace();
+        if (readLiteral("null")) {
+            return true;
+        }
+        std::string_view raw;
+        if (not readRawString(raw)) {
+            return false;
+        }
+
+        value.clear();
+        for (size_t i = 0; i < raw.size(); i++) {
+            if (raw[i] != '\\') {
+                value.push_back(raw[i]);
+                continue;
+            }
+            if (++i == raw.size()) {
+                return fail();
+            }
+            switch (raw[i]) {
+                case '"': value.push_back('"'); break;
+                case '\\': value.push_back('\\'); break;
+                case '/': value.push_back('/'); break;
+                case 'b': value.push_back('\b'); break;
+                case 'f': value.push_back('\f'); break;
+                case 'n': value.push_back('\n'); break;
+                case 'r': value.push_back('\r'); break;
+                case 't': value.push_back('\t'); break;
+                case 'u': {
+                    uint32_t codePoint;
+                    if (not ParseHex4(raw.substr(i + 1), codePoint)) {
+                        return fail();
+                    }
+                    i += 4;
+                    uint32_t lowSurrogate;
+                    if (codePoint >= 0xD800 && codePoint < 0xDC00
+                        && raw.substr(i + 1).starts_with("\\u")
+                        && ParseHex4(raw.substr(i + 3), lowSurrogate)
+                        && lowSurrogate >= 0xDC00 && lowSurrogate < 0xE000) {
+                        codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (lowSurrogate - 0xDC00);
+                        i += 6;
+                    }
+                    AppendUtf8(value, codePoint);
+                    break;
+                }
+                default:
+                    return fail();
+            }
+        }
+        return true;
+    }
+
+    bool JsonReader::skipValue() {
+        skipWhitespace();
+        if (cur_ == end_) {
+            return fail();
+        }
+        switch (*cur_) {
+            case '{': {
+                beginObject();
+                std::string_view key;
+                while (nextKey(key)) {
+                    if (not skipValue()) {
+                        return false;
+                    }
+                }
+                return not failed_;
+            }
+            case '[': {
+                beginArray();
+                while (nextElement()) {
+                    if (not skipValue()) {
+                        return false;
+                    }
+                }
+                return not failed_;
+            }
+            case '"': {
+                std::string_view raw;
+                return readRawString(raw);
+            }
+            default: {
+                const char* begin = cur_;
+                while (cur_ != end_ && *cur_ != ',' && *cur_ != '}' && *cur_ != ']'
+                       && *cur_ != ' ' && *cur_ != '\n' && *cur_ != '\r' && *cur_ != '\t') {
+                    ++cur_;
+                }
+                return (cur_ != begin) || fail();
+            }
+        }
+    }
+
+    /*
+     * Reads a quoted string without decoding escape sequences.
+     */
+    bool JsonReader::readRawString(std::string_view& raw) {
+        if (cur_ == end_ || *cur_ != '"') {
+            return fail();
+        }
+        const char* begin = ++cur_;
+        while (cur_ != end_ && *cur_ != '"') {
+            if (*cur_ == '\\' && cur_ + 1 != end_) {
+                ++cur_;
+            }
+            ++cur_;
+        }
+        if (cur_ == end_) {
+            return fail();
+        }
+        raw = std::string_view(begin, cur_ - begin);
+        ++cur_;
+        return true;
+    }
+
+} // lpg
@@ -0,0 +1,236 @@
+//
+// Created by volt on 2026-10-19.
+//
+
+
+
+
+#ifndef LPG_ENGINE_SRC_LPG_CORE_JSON_HPP_
+#define LPG_ENGINE_SRC_LPG_CORE_JSON_HPP_
+
+#include <charconv>
+#include <concepts>
+#include <string>
+#include <string_view>
+
+namespace lpg {
+
+    /*
+     * Appends JSON to a caller-owned buffer. Clear and reuse the buffer between documents
+     * to avoid reallocating it. Numbers are written with std::to_chars (shortest round-trip form).
+     */
+    class JsonWriter {
+    public:
+        explicit JsonWriter(std::string& out) : out_(out) {}
+
+        void beginObject() {
+            separate();
+            out_.push_back('{');
+            needComma_ = false;
+        }
+
+        void endObject() {
+            out_.push_back('}');
+            needComma_ = true;
+        }
+
+        void beginArray() {
+            separate();
+            out_.push_back('[');
+            needComma_ = false;
+        }
+
+        void endArray() {
+            out_.push_back(']');
+            needComma_ = true;
+        }
+
+        /*
+         * The key is written verbatim, so it must not contain characters that need escaping.
+         */
+        void key(std::string_view key) {
+            separate();
+            out_.push_back('"');
+            out_.append(key);
+            out_.append("\":");
+            needComma_ = false;
+        }
+
+        void value(bool value) {
+            separate();
+            out_.append(value ? "true" : "false");
+            needComma_ = true;
+        }
+
+        template<typename T>
+            requires (std::integral<T> || std::floating_point<T>) && (not std::same_as<T, bool>)
+        void value(T value) {
+            separate();
+            if constexpr(std::floating_point<T>) {
+                if (value != value || value - value != 0) {
+                    out_.append("null");
+                    needComma_ = true;
+                    return;
+                }
+            }
+            char buf[32];
+            auto [ptr, ec] = std::to_chars(buf, buf + sizeof(buf), value);
+            out_.append(buf, ptr);
+            needComma_ = true;
+        }
+
+        void value(std::string_view value);
+
+        void null() {
+            separate();
+            out_.append("null");
+            needComma_ = true;
+        }
+
+    private:
+        void separate() {
+            if (needComma_) {
+                out_.push_back(',');
+            }
+        }
+
+        std::string& out_;
+        bool needComma_ = false;
+    };
+
+    /*
+     * Single-pass pull parser over a view of the whole document. It never allocates;
+     * only reading a string value into a std::string may grow that string.
+     * Every read function returns false and marks the reader as failed on malformed input,
+     * including missing or trailing commas between items.
+     */
+    class JsonReader {
+    public:
+        explicit JsonReader(std::string_view input)
+            : cur_(input.data()),
+              end_(input.data() + input.size()) {
+        }
+
+        bool beginObject() {
+            return beginContainer('{');
+        }
+
+        /*
+         * Reads the next key of the current object. Returns false after consuming the closing brace.
+         * Escape sequences in keys are not decoded.
+         */
+        bool nextKey(std::string_view& key);
+
+        bool beginArray() {
+            return beginContainer('[');
+        }
+
+        /*
+         * Positions the reader at the next element of the current array.
+         * Returns false after consuming the closing bracket.
+         */
+        bool nextElement();
+
+        bool read(bool& value);
+        bool read(std::string& value);
+
+        template<typename T>
+            requires (std::integral<T> || std::floating_point<T>) && (not std::same_as<T, bool>)
+        bool read(T& value) {
+            skipWhitespace();
+            if (readLiteral("null")) {
+                return true;
+            }
+            auto [ptr, ec] = std::from_chars(cur_, end_, value);
+            if (ec != std::errc{}) {
+                return fail();
+            }
+            cur_ = ptr;
+            return true;
+        }
+
+        bool skipValue();
+
+        /*
+         * The first character of the next value, or '\0' at the end of the input. Does not consume it.
+         */
+        [[nodiscard]] char peek() {
+            skipWhitespace();
+            return cur_ != end_ ? *cur_ : '\0';
+        }
+
+        [[nodiscard]] bool failed() const {
+            return failed_;
+        }
+
+        [[nodiscard]] bool atEnd() {
+            skipWhitespace();
+            return cur_ == end_;
+        }
+
+    private:
+        void skipWhitespace() {
+            while (cur_ != end_ && (*cur_ == ' ' || *cur_ == '\n' || *cur_ == '\r' || *cur_ == '\t')) {
+                ++cur_;
+            }
+        }
+
+        bool expect(char c) {
+            skipWhitespace();
+            if (cur_ == end_ || *cur_ != c) {
+                return fail();
+            }
+            ++cur_;
+            return true;
+        }
+
+        bool beginContainer(char open) {
+            if (not expect(open)) {
+                return false;
+            }
+            firstItem_ = true;
+            return true;
+        }
+
+        /*
+         * Consumes the separator before the next item of the current container, or its closing character.
+         * Returns false at the end of the container, or on malformed input.
+         */
+        bool nextItem(char close);
+
+        bool tryConsume(char c) {
+            skipWhitespace();
+            if (cur_ != end_ && *cur_ == c) {
+                ++cur_;
+                return true;
+            }
+            return false;
+        }
+
+        bool readLiteral(std::string_view literal) {
+            if (std::string_view(cur_, end_ - cur_).starts_with(literal)) {
+                cur_ += literal.size();
+                return true;
+            }
+            return false;
+        }
+
+        bool readRawString(std::string_view& raw);
+
+        bool fail() {
+            failed_ = true;
+            return false;
+        }
+
+        const char* cur_;
+        const char* end_;
+        bool failed_ = false;
+
+        // no item of the innermost open container has been read yet; a single flag is enough,
+        // because when a nested container closes its parent has just read an item
+        bool firstItem_ = false;
+    };
+
+} // lpg
+
+#endif //LPG_ENGINE_SRC_LPG_CORE_JSON_HPP_
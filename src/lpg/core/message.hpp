@@ -10,6 +10,8 @@
 #include <unordered_map>
 #include <string>
 
+#include "entity.hpp"
+
 namespace lpg {
 
     struct MessageInterface {
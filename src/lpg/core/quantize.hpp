@@ -0,0 +1,129 @@
+//
+// Created by volt on 2026-10-19.
+//
+
+
+
+
+#ifndef LPG_ENGINE_SRC_LPG_CORE_QUANTIZE_HPP_
+#define LPG_ENGINE_SRC_LPG_CORE_QUANTIZE_HPP_
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+#include "data.hpp"
+
+namespace lpg::quant {
+
+    /*
+     * IEEE 754 binary32 -> binary16 with round-to-nearest-even. Overflow becomes infinity, NaN stays NaN.
+     */
+    inline uint16_t FloatToHalf(float value) {
+        uint32_t bits = std::bit_cast<uint32_t>(value);
+        uint32_t sign = (bits >> 16) & 0x8000;
+        uint32_t absBits = bits & 0x7FFFFFFF;
+
+        if (absBits >= 0x7F800000) {
+            return sign | 0x7C00 | (absBits > 0x7F800000 ? 0x200 : 0);
+        }
+        if (absBits >= 0x477FF000) {
+            return sign | 0x7C00;
+        }
+        if (absBits < 0x38800000) {
+            // subnormal half: shift the implicit-one mantissa into place, rounding to nearest even
+            if (absBits < 0x33000000) {
+                return sign;
+            }
+            uint32_t exponent = absBits >> 23;
+            uint32_t mantissa = (absBits & 0x7FFFFF) | 0x800000;
+            uint32_t shift = 126 - exponent;
+            uint32_t result = mantissa >> shift;
+            uint32_t remainder = mantissa & ((1u << shift) - 1);
+            uint32_t halfway = 1u << (shift - 1);
+            if (remainder > halfway || (remainder == halfway && (result & 1))) {
+                result++;
+            }
+            return sign | result;
+        }
+
+        uint32_t result = ((absBits - 0x38000000) >> 13);
+        uint32_t remainder = absBits & 0x1FFF;
+        if (remainder > 0x1000 || (remainder == 0x1000 && (result & 1))) {
+            result++;
+        }
+        return sign | result;
+    }
+
+    inline float HalfToFloat(uint16_t half) {
+        uint32_t sign = static_cast<uint32_t>(half & 0x8000) << 16;
+        uint32_t exponent = (half >> 10) & 0x1F;
+        uint32_t mantissa = half & 0x3FF;
+
+        if (exponent == 0x1F) {
+            return std::bit_cast<float>(sign | 0x7F800000 | (mantissa << 13));
+        }
+        if (exponent == 0) {
+            float magnitude = std::ldexp(static_cast<float>(mantissa), -24);
+            return sign ? -magnitude : magnitude;
+        }
+        return std::bit_cast<float>(sign | ((exponent + 112) << 23) | (mantissa << 13));
+    }
+
+    /*
+     * Codec<TEncoding>::Pack/Unpack convert one element. min and max are the field's MinValue/MaxValue
+     * and are only used by encodings that need a range.
+     */
+    template<typename TEncoding>
+    struct Codec;
+
+    template<>
+    struct Codec<Half> {
+        using Packed = uint16_t;
+        static constexpr bool NeedsRange = false;
+
+        static Packed Pack(double value, double, double) {
+            return FloatToHalf(static_cast<float>(value));
+        }
+        static double Unpack(Packed packed, double, double) {
+            return HalfToFloat(packed);
+        }
+    };
+
+    template<>
+    struct Codec<SNorm16> {
+        using Packed = int16_t;
+        static constexpr bool NeedsRange = false;
+
+        static Packed Pack(double value, double, double) {
+            return static_cast<Packed>(std::lround(std::clamp(value, -1.0, 1.0) * 32767.0));
+        }
+        static double Unpack(Packed packed, double, double) {
+            return std::max(packed / 32767.0, -1.0);
+        }
+    };
+
+    template<typename T>
+    struct Codec<FixedPoint<T>> {
+        static_assert(std::is_integral_v<T>, "FixedPoint storage must be an integer type");
+
+        using Packed = T;
+        static constexpr bool NeedsRange = true;
+
+        static constexpr double Steps = static_cast<double>(std::numeric_limits<T>::max()) - std::numeric_limits<T>::min();
+
+        static Packed Pack(double value, double min, double max) {
+            double normalized = (std::clamp(value, min, max) - min) / (max - min);
+            return static_cast<Packed>(std::llround(normalized * Steps + std::numeric_limits<T>::min()));
+        }
+        static double Unpack(Packed packed, double min, double max) {
+            double normalized = (static_cast<double>(packed) - std::numeric_limits<T>::min()) / Steps;
+            return min + normalized * (max - min);
+        }
+    };
+
+} // lpg::quant
+
+#endif //LPG_ENGINE_SRC_LPG_CORE_QUANTIZE_HPP_
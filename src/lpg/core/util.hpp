@@ -15,7 +15,7 @@ namespace lpg {
     namespace vec {
 
         template<typename TVecRef>
-        auto* TryGet(TVecRef&& vec, size_t index) -> decltype(&vec[0]) {
+        auto TryGet(TVecRef&& vec, size_t index) -> decltype(&vec[0]) {
             if (index >= vec.size()) {
                 return nullptr;
             }
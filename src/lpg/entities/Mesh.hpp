@@ -12,7 +12,7 @@
 namespace lpg {
 
     struct MeshEntity: BaseEntity {
-        const AssetPath<AssetType::Model> path;
+        const InternedAssetPath<AssetType::Model> path;
     };
 
 }
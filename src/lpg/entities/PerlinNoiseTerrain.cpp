@@ -0,0 +1,72 @@
+//
+// Created by volt on 2026-10-19.
+//
+
+
+
+
+#include "PerlinNoiseTerrain.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "../core/Profiler.hpp"
+#include "../util/HeightGrid.hpp"
+
+namespace lpg {
+
+    namespace detail {
+
+        static al::Vec2f RandomGradient(int x, int y, uint32_t seed) {
+            uint32_t a = uint32_t(x) * 89733 + uint32_t(y) * 2879327 + 0xB16B00B5;
+            a = a << 13 | a >> 19;
+            a ^= seed;
+            a *= 0xD398A93F;
+            return {float(std::cos(a)), float(std::sin(a))};
+        }
+
+        static float Interpolate(float a, float b, float weight) {
+            weight = std::clamp(weight, 0.0f, 1.0f);
+            return (b - a) * (3.0f - weight * 2.0f) * weight * weight + a;
+        }
+
+        /*
+         * https://en.wikipedia.org/wiki/Perlin_noise, in [0, 1]
+         */
+        static float PerlinOctave(float x, float y, uint32_t seed) {
+            float floorX = std::floor(x), floorY = std::floor(y);
+            float n[4];
+            for (int i = 0; i < 4; i++) {
+                float cornerX = floorX + float(i & 1), cornerY = floorY + float((i & 2) >> 1);
+                al::Vec2f gradient = RandomGradient(int(cornerX), int(cornerY), seed);
+                n[i] = gradient.x * (x - cornerX) + gradient.y * (y - cornerY);
+            }
+            float ix0 = Interpolate(n[0], n[1], x - floorX);
+            float ix1 = Interpolate(n[2], n[3], x - floorX);
+            return std::clamp(Interpolate(ix0, ix1, y - floorY), -1.0f, 1.0f) * 0.5f + 0.5f;
+        }
+
+        static float PerlinNoise(float x, float y, int numOctaves, uint32_t seed) {
+            numOctaves = std::max(1, numOctaves);
+            float sum = 0.0f, max = 0.0f;
+            for (int i = 0; i < numOctaves; i++) {
+                float coeff = 1.0f / float(1 << i);
+                max += coeff;
+                sum += PerlinOctave(x * float(1 << i), y * float(1 << i), seed) * coeff;
+            }
+            return sum / max;
+        }
+
+    } // namespace detail
+
+    std::shared_ptr<HeightGrid> CreateHeightGrid(const PerlinNoiseTerrain& terrain) {
+        LPG_PROFILE_ZONE("CreateHeightGrid");
+        auto grid = std::make_shared<HeightGrid>(terrain.gridSize, terrain.gridSize, terrain.cellSize, 0.0f, terrain.height);
+        grid->edit(grid->getBounds(), [&terrain](int x, int y, float& height) {
+            height = terrain.height * detail::PerlinNoise(x * terrain.frequency, y * terrain.frequency, terrain.numOctaves, terrain.seed);
+        });
+        grid->applyEdits();
+        return grid;
+    }
+
+} // lpg
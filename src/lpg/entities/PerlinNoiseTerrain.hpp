@@ -5,10 +5,16 @@
 #ifndef LPG_ENGINE_TERRAIN_HPP
 #define LPG_ENGINE_TERRAIN_HPP
 
+#include <cstdint>
+#include <memory>
 #include <string>
 
+#include <axxegro/com/math/math.hpp>
+
 namespace lpg {
 
+    class HeightGrid;
+
     struct PerlinNoiseTerrain {
 
         al::Vec3f position{}, scale{};
@@ -16,9 +22,19 @@ namespace lpg {
 
         int numOctaves = 8;
 
+        int gridSize = 128; // samples along each side
+        float cellSize = 1.0f;
+        float height = 96.0f; // heights are in [0, height]
+        float frequency = 0.01f; // of the first octave, per sample
+
 
     };
 
+    /*
+     * Samples the terrain's noise once into a compact grid, shared by its render mesh and its collision shape.
+     */
+    std::shared_ptr<HeightGrid> CreateHeightGrid(const PerlinNoiseTerrain& terrain);
+
 } // lpg
 
 #endif //LPG_ENGINE_TERRAIN_HPP
@@ -9,11 +9,13 @@
 #define LPG_ENGINE_SRC_LPG_ENTITIES_POINTLIGHT_HPP_
 
 #include <axxegro/com/math/math.hpp>
+#include "../core/entity.hpp"
 
 namespace lpg {
     struct PointLightEntity: BaseEntity {
         al::Vec3f position;
         al::Vec3f color;
+        LPG_ATTR(Quantize<Half>{}, MinValue{0})
         double intensity;
     };
 }
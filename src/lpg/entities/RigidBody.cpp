@@ -0,0 +1,13 @@
+//
+// Created by volt on 2026-10-19.
+//
+
+
+
+
+#include "RigidBody.hpp"
+#include "../core/entity_codegen.hpp"
+
+namespace lpg {
+    LPG_REGISTER_ENTITY_TYPE(RigidBody);
+} // lpg
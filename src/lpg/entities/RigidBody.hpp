@@ -0,0 +1,60 @@
+//
+// Created by volt on 2026-10-19.
+//
+
+
+
+
+#ifndef LPG_ENGINE_SRC_LPG_ENTITIES_RIGIDBODY_HPP_
+#define LPG_ENGINE_SRC_LPG_ENTITIES_RIGIDBODY_HPP_
+
+#include <cstdint>
+
+#include <axxegro/com/math/math.hpp>
+#include "../core/entity.hpp"
+
+namespace lpg {
+
+    enum class CollisionShapeType {
+        Box,
+        Sphere,
+        Capsule
+    };
+
+    /*
+     * Gives the owning entity a rigid body simulated by PhysicsSimulationSystem. Declare it as a managed component:
+     *
+     * struct Crate {
+     *     al::Vec3f position, rotation, scale {1, 1, 1};
+     *     LPG_NO_UNIQUE_ADDRESS Managed<RigidBody> body;
+     * };
+     *
+     * The body is created from the owner's position, rotation and scale, and the simulated position and rotation
+     * are written back into the owner's position and rotation fields. Everything below is read once, when the body is created.
+     */
+    struct RigidBody: BaseEntity {
+        CollisionShapeType shape = CollisionShapeType::Box;
+
+        /*
+         * Half extents of boxes. Spheres use x as the radius; capsules (along Y) use x as the radius
+         * and y as half the height of the cylindrical part. Multiplied by the owner's scale.
+         */
+        al::Vec3f halfExtents {0.5f, 0.5f, 0.5f};
+
+        LPG_ATTR(MinValue{0})
+        float mass = 1.0f; // 0 makes the body static
+        float friction = 0.5f;
+        float restitution = 0.0f;
+
+        /*
+         * Kinematic bodies push other bodies around but only move with the owner, see PhysicsSimulationSystem::markDirty.
+         */
+        bool kinematic = false;
+
+        LPG_ATTR(DoNotSerialize{})
+        uint32_t bodyId = 0; // assigned by PhysicsSimulationSystem
+    };
+
+}
+
+#endif //LPG_ENGINE_SRC_LPG_ENTITIES_RIGIDBODY_HPP_
@@ -3,6 +3,7 @@
 #include "PerlinNoiseTerrain.hpp"
 #include "PointLight.hpp"
 #include "DirectionalLight.hpp"
+#include "RigidBody.hpp"
 
 
 
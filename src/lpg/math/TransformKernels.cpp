@@ -0,0 +1,535 @@
+//
+// Created by volt on 2026-10-19.
+//
+
+
+
+
+#include "TransformKernels.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numbers>
+#include <random>
+#include <type_traits>
+#include <vector>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define LPG_MATH_X86
+#include <immintrin.h>
+#endif
+
+// the kernels are lambdas called once per group; left to the inliner they stay calls with Mat4V spilled to the stack
+#if defined(__GNUC__) || defined(__clang__)
+#define LPG_MATH_FLATTEN [[gnu::flatten]]
+#elif defined(_MSC_VER)
+#define LPG_MATH_FLATTEN [[msvc::flatten]]
+#else
+#define LPG_MATH_FLATTEN
+#endif
+
+// as in SimdKernels.cpp: GCC and Clang need the instruction sets enabled per function, MSVC does not
+#if defined(__GNUC__) || defined(__clang__)
+#define LPG_MATH_TARGET_SSE2 __attribute__((target("sse2")))
+#define LPG_MATH_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define LPG_MATH_TARGET_SSE2
+#define LPG_MATH_TARGET_AVX2
+#endif
+
+// GCC notes that returning FloatAVX by value changes the ABI without AVX enabled;
+// FloatAVX only lives in functions flattened into CallWithAVX2, so no such call is made
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic ignored "-Wpsabi"
+#endif
+
+namespace lpg::math {
+
+    namespace detail {
+
+        /*
+         * Minimal float vector types with the same interface, so that each kernel is written once
+         * as a template and instantiated for every instruction set and for the scalar tail.
+         */
+        struct FloatScalar {
+            using Mask = bool;
+            static constexpr size_t Width = 1;
+            float v;
+
+            static FloatScalar Load(const float* p) {return {*p};}
+            void store(float* p) const {*p = v;}
+            static FloatScalar Set1(float f) {return {f};}
+            static FloatScalar Round(FloatScalar a) {return {std::nearbyint(a.v)};}
+            static FloatScalar Select(Mask mask, FloatScalar a, FloatScalar b) {return mask ? a : b;}
+
+            friend FloatScalar operator+(FloatScalar a, FloatScalar b) {return {a.v + b.v};}
+            friend FloatScalar operator-(FloatScalar a, FloatScalar b) {return {a.v - b.v};}
+            friend FloatScalar operator*(FloatScalar a, FloatScalar b) {return {a.v * b.v};}
+            friend FloatScalar operator/(FloatScalar a, FloatScalar b) {return {a.v / b.v};}
+            friend FloatScalar operator-(FloatScalar a) {return {-a.v};}
+            friend Mask operator==(FloatScalar a, FloatScalar b) {return a.v == b.v;}
+        };
+
+#ifdef LPG_MATH_X86
+        /*
+         * AVX only, run when simd::GetInstructionSet() is AVX2.
+         */
+        struct FloatAVX {
+            using Mask = __m256;
+            static constexpr size_t Width = 8;
+            __m256 v;
+
+            LPG_MATH_TARGET_AVX2 static FloatAVX Load(const float* p) {return {_mm256_loadu_ps(p)};}
+            LPG_MATH_TARGET_AVX2 void store(float* p) const {_mm256_storeu_ps(p, v);}
+            LPG_MATH_TARGET_AVX2 static FloatAVX Set1(float f) {return {_mm256_set1_ps(f)};}
+            LPG_MATH_TARGET_AVX2 static FloatAVX Round(FloatAVX a) {return {_mm256_round_ps(a.v, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC)};}
+            LPG_MATH_TARGET_AVX2 static FloatAVX Select(Mask mask, FloatAVX a, FloatAVX b) {return {_mm256_blendv_ps(b.v, a.v, mask)};}
+
+            LPG_MATH_TARGET_AVX2 friend FloatAVX operator+(FloatAVX a, FloatAVX b) {return {_mm256_add_ps(a.v, b.v)};}
+            LPG_MATH_TARGET_AVX2 friend FloatAVX operator-(FloatAVX a, FloatAVX b) {return {_mm256_sub_ps(a.v, b.v)};}
+            LPG_MATH_TARGET_AVX2 friend FloatAVX operator*(FloatAVX a, FloatAVX b) {return {_mm256_mul_ps(a.v, b.v)};}
+            LPG_MATH_TARGET_AVX2 friend FloatAVX operator/(FloatAVX a, FloatAVX b) {return {_mm256_div_ps(a.v, b.v)};}
+            LPG_MATH_TARGET_AVX2 friend FloatAVX operator-(FloatAVX a) {return {_mm256_xor_ps(a.v, _mm256_set1_ps(-0.0f))};}
+            LPG_MATH_TARGET_AVX2 friend Mask operator==(FloatAVX a, FloatAVX b) {return _mm256_cmp_ps(a.v, b.v, _CMP_EQ_OQ);}
+        };
+
+        struct FloatSSE2 {
+            using Mask = __m128;
+            static constexpr size_t Width = 4;
+            __m128 v;
+
+            LPG_MATH_TARGET_SSE2 static FloatSSE2 Load(const float* p) {return {_mm_loadu_ps(p)};}
+            LPG_MATH_TARGET_SSE2 void store(float* p) const {_mm_storeu_ps(p, v);}
+            LPG_MATH_TARGET_SSE2 static FloatSSE2 Set1(float f) {return {_mm_set1_ps(f)};}
+            // exact for |a| < 2^31, which covers every use below
+            LPG_MATH_TARGET_SSE2 static FloatSSE2 Round(FloatSSE2 a) {return {_mm_cvtepi32_ps(_mm_cvtps_epi32(a.v))};}
+            LPG_MATH_TARGET_SSE2 static FloatSSE2 Select(Mask mask, FloatSSE2 a, FloatSSE2 b) {return {_mm_or_ps(_mm_and_ps(mask, a.v), _mm_andnot_ps(mask, b.v))};}
+
+            LPG_MATH_TARGET_SSE2 friend FloatSSE2 operator+(FloatSSE2 a, FloatSSE2 b) {return {_mm_add_ps(a.v, b.v)};}
+            LPG_MATH_TARGET_SSE2 friend FloatSSE2 operator-(FloatSSE2 a, FloatSSE2 b) {return {_mm_sub_ps(a.v, b.v)};}
+            LPG_MATH_TARGET_SSE2 friend FloatSSE2 operator*(FloatSSE2 a, FloatSSE2 b) {return {_mm_mul_ps(a.v, b.v)};}
+            LPG_MATH_TARGET_SSE2 friend FloatSSE2 operator/(FloatSSE2 a, FloatSSE2 b) {return {_mm_div_ps(a.v, b.v)};}
+            LPG_MATH_TARGET_SSE2 friend FloatSSE2 operator-(FloatSSE2 a) {return {_mm_xor_ps(a.v, _mm_set1_ps(-0.0f))};}
+            LPG_MATH_TARGET_SSE2 friend Mask operator==(FloatSSE2 a, FloatSSE2 b) {return _mm_cmpeq_ps(a.v, b.v);}
+        };
+#endif
+
+        /*
+         * Calls fn.template operator()<V>(i) for every group of V::Width elements starting at i, then
+         * fn.template operator()<FloatScalar>(i) for the rest.
+         */
+        template<typename V, typename TFn>
+        LPG_MATH_FLATTEN static void ForEachGroup(size_t count, TFn&& fn) {
+            size_t i = 0;
+            if constexpr(V::Width > 1) {
+                for (; i + V::Width <= count; i += V::Width) {
+                    fn.template operator()<V>(i);
+                }
+            }
+            for (; i < count; i++) {
+                fn.template operator()<FloatScalar>(i);
+            }
+        }
+
+#ifdef LPG_MATH_X86
+        // flattened with the target enabled, so that the vector operations inline into fn
+        template<typename TFn>
+        LPG_MATH_TARGET_AVX2 LPG_MATH_FLATTEN static void CallWithAVX2(TFn& fn) {
+            fn.template operator()<FloatAVX>();
+        }
+
+        template<typename TFn>
+        LPG_MATH_TARGET_SSE2 LPG_MATH_FLATTEN static void CallWithSSE2(TFn& fn) {
+            fn.template operator()<FloatSSE2>();
+        }
+#endif
+
+        /*
+         * Calls fn.template operator()<V>() with the widest vector type of simd::GetInstructionSet(),
+         * compiled for that instruction set.
+         */
+        template<typename TFn>
+        static void DispatchVectorType(TFn&& fn) {
+            switch (simd::GetInstructionSet()) {
+#ifdef LPG_MATH_X86
+                case simd::InstructionSet::AVX2:
+                    CallWithAVX2(fn);
+                    return;
+                case simd::InstructionSet::SSE2:
+                    CallWithSSE2(fn);
+                    return;
+#endif
+                default:
+                    fn.template operator()<FloatScalar>();
+            }
+        }
+
+        template<typename TFn>
+        static void DispatchGroups(size_t count, TFn&& fn) {
+            DispatchVectorType([&]<typename V>() {
+                ForEachGroup<V>(count, fn);
+            });
+        }
+
+        template<typename V>
+        struct Vec3V {
+            V x, y, z;
+        };
+
+        template<typename V>
+        struct QuatV {
+            V x, y, z, w;
+        };
+
+        template<typename V>
+        struct Mat4V {
+            V m[16];
+        };
+
+        template<typename V>
+        static Vec3V<V> LoadVec3(Vec3fArrays arrays, size_t i) {
+            return {V::Load(arrays.x + i), V::Load(arrays.y + i), V::Load(arrays.z + i)};
+        }
+
+        template<typename V>
+        static void StoreVec3(Vec3fArrays arrays, size_t i, const Vec3V<V>& value) {
+            value.x.store(arrays.x + i);
+            value.y.store(arrays.y + i);
+            value.z.store(arrays.z + i);
+        }
+
+        template<typename V>
+        static QuatV<V> LoadQuat(QuatArrays arrays, size_t i) {
+            return {V::Load(arrays.x + i), V::Load(arrays.y + i), V::Load(arrays.z + i), V::Load(arrays.w + i)};
+        }
+
+        template<typename V>
+        static void StoreQuat(QuatArrays arrays, size_t i, const QuatV<V>& value) {
+            value.x.store(arrays.x + i);
+            value.y.store(arrays.y + i);
+            value.z.store(arrays.z + i);
+            value.w.store(arrays.w + i);
+        }
+
+        template<typename V>
+        static Mat4V<V> LoadMat4(Mat4Arrays arrays, size_t i) {
+            Mat4V<V> result;
+            for (int k = 0; k < 16; k++) {
+                result.m[k] = V::Load(arrays.m[k] + i);
+            }
+            return result;
+        }
+
+        template<typename V>
+        static void StoreMat4(Mat4Arrays arrays, size_t i, const Mat4V<V>& value) {
+            for (int k = 0; k < 16; k++) {
+                value.m[k].store(arrays.m[k] + i);
+            }
+        }
+
+        /*
+         * Cody-Waite reduction by pi/2 with Cephes' split constants, then minimax polynomials on [-pi/4, pi/4].
+         * Within a few ulp of std::sin/std::cos for arguments up to a few thousand radians.
+         */
+        template<typename V>
+        static void SinCos(V x, V& sinOut, V& cosOut) {
+            V q = V::Round(x * V::Set1(std::numbers::inv_pi_v<float> * 2.0f));
+            V r = ((x - q * V::Set1(1.5703125f)) - q * V::Set1(4.837512969970703125e-4f)) - q * V::Set1(7.54978995489188216e-8f);
+            V r2 = r * r;
+            V s = r + r * r2 * (V::Set1(-1.6666654611e-1f) + r2 * (V::Set1(8.3321608736e-3f) + r2 * V::Set1(-1.9515295891e-4f)));
+            V c = V::Set1(1.0f) - V::Set1(0.5f) * r2
+                  + r2 * r2 * (V::Set1(4.166664568298827e-2f) + r2 * (V::Set1(-1.388731625493765e-3f) + r2 * V::Set1(2.443315711809948e-5f)));
+
+            // q is an integer, so these roundings are exact floors: quadrant = q mod 4, half = floor(quadrant / 2)
+            V quadrant = q - V::Set1(4.0f) * V::Round(q * V::Set1(0.25f) - V::Set1(0.375f));
+            V half = V::Round(quadrant * V::Set1(0.5f) - V::Set1(0.25f));
+            V one = V::Set1(1.0f);
+            auto swap = (quadrant - V::Set1(2.0f) * half) == one;
+            auto negateSin = half == one;
+            auto negateCos = V::Round((quadrant + one) * V::Set1(0.5f) - V::Set1(0.25f)) == one;
+
+            V sinValue = V::Select(swap, c, s);
+            V cosValue = V::Select(swap, s, c);
+            sinOut = V::Select(negateSin, -sinValue, sinValue);
+            cosOut = V::Select(negateCos, -cosValue, cosValue);
+        }
+
+        /*
+         * R = Rz * Ry * Rx, stored as m[4 * column + row] with the remaining entries of the identity.
+         */
+        template<typename V>
+        static Mat4V<V> EulerRotation(const Vec3V<V>& angles) {
+            V sx, cx, sy, cy, sz, cz;
+            SinCos(angles.x, sx, cx);
+            SinCos(angles.y, sy, cy);
+            SinCos(angles.z, sz, cz);
+            V zero = V::Set1(0.0f);
+            return {{
+                cz * cy, sz * cy, -sy, zero,
+                cz * sy * sx - sz * cx, sz * sy * sx + cz * cx, cy * sx, zero,
+                cz * sy * cx + sz * sx, sz * sy * cx - cz * sx, cy * cx, zero,
+                zero, zero, zero, V::Set1(1.0f)
+            }};
+        }
+
+        template<typename V>
+        static Vec3V<V> TransformPoint(const Mat4V<V>& t, const Vec3V<V>& p) {
+            return {
+                t.m[0] * p.x + t.m[4] * p.y + t.m[8] * p.z + t.m[12],
+                t.m[1] * p.x + t.m[5] * p.y + t.m[9] * p.z + t.m[13],
+                t.m[2] * p.x + t.m[6] * p.y + t.m[10] * p.z + t.m[14]
+            };
+        }
+
+        static float RelativeError(float value, float expected) {
+            return std::abs(value - expected) / std::max(1.0f, std::abs(expected));
+        }
+    }
+
+    void EulerToMatrix(Vec3fArrays angles, Mat4Arrays out, size_t count) {
+        detail::DispatchGroups(count, [&]<typename V>(size_t i) {
+            detail::StoreMat4(out, i, detail::EulerRotation(detail::LoadVec3<V>(angles, i)));
+        });
+    }
+
+    void EulerToQuat(Vec3fArrays angles, QuatArrays out, size_t count) {
+        detail::DispatchGroups(count, [&]<typename V>(size_t i) {
+            auto a = detail::LoadVec3<V>(angles, i);
+            V half = V::Set1(0.5f);
+            V sx, cx, sy, cy, sz, cz;
+            detail::SinCos(a.x * half, sx, cx);
+            detail::SinCos(a.y * half, sy, cy);
+            detail::SinCos(a.z * half, sz, cz);
+            detail::StoreQuat(out, i, detail::QuatV<V> {
+                .x = cz * cy * sx - sz * sy * cx,
+                .y = cz * sy * cx + sz * cy * sx,
+                .z = sz * cy * cx - cz * sy * sx,
+                .w = cz * cy * cx + sz * sy * sx
+            });
+        });
+    }
+
+    void QuatToMatrix(QuatArrays rotation, Mat4Arrays out, size_t count) {
+        detail::DispatchGroups(count, [&]<typename V>(size_t i) {
+            auto q = detail::LoadQuat<V>(rotation, i);
+            V two = V::Set1(2.0f);
+            V one = V::Set1(1.0f);
+            V zero = V::Set1(0.0f);
+            V xx = q.x * q.x, yy = q.y * q.y, zz = q.z * q.z;
+            V xy = q.x * q.y, xz = q.x * q.z, yz = q.y * q.z;
+            V xw = q.x * q.w, yw = q.y * q.w, zw = q.z * q.w;
+            detail::StoreMat4(out, i, detail::Mat4V<V> {{
+                one - two * (yy + zz), two * (xy + zw), two * (xz - yw), zero,
+                two * (xy - zw), one - two * (xx + zz), two * (yz + xw), zero,
+                two * (xz + yw), two * (yz - xw), one - two * (xx + yy), zero,
+                zero, zero, zero, one
+            }});
+        });
+    }
+
+    void QuatMultiply(QuatArrays a, QuatArrays b, QuatArrays out, size_t count) {
+        detail::DispatchGroups(count, [&]<typename V>(size_t i) {
+            auto p = detail::LoadQuat<V>(a, i);
+            auto q = detail::LoadQuat<V>(b, i);
+            detail::StoreQuat(out, i, detail::QuatV<V> {
+                .x = p.w * q.x + p.x * q.w + p.y * q.z - p.z * q.y,
+                .y = p.w * q.y - p.x * q.z + p.y * q.w + p.z * q.x,
+                .z = p.w * q.z + p.x * q.y - p.y * q.x + p.z * q.w,
+                .w = p.w * q.w - p.x * q.x - p.y * q.y - p.z * q.z
+            });
+        });
+    }
+
+    void ComposeTRS(Vec3fArrays translation, Vec3fArrays angles, Vec3fArrays scale, Mat4Arrays out, size_t count) {
+        detail::DispatchGroups(count, [&]<typename V>(size_t i) {
+            auto m = detail::EulerRotation(detail::LoadVec3<V>(angles, i));
+            auto s = detail::LoadVec3<V>(scale, i);
+            auto t = detail::LoadVec3<V>(translation, i);
+            for (int column = 0; column < 3; column++) {
+                m.m[4 * column] = m.m[4 * column] * s.x;
+                m.m[4 * column + 1] = m.m[4 * column + 1] * s.y;
+                m.m[4 * column + 2] = m.m[4 * column + 2] * s.z;
+            }
+            m.m[12] = t.x;
+            m.m[13] = t.y;
+            m.m[14] = t.z;
+            detail::StoreMat4(out, i, m);
+        });
+    }
+
+    void Compose(Mat4Arrays first, Mat4Arrays second, Mat4Arrays out, size_t count) {
+        detail::DispatchGroups(count, [&]<typename V>(size_t i) {
+            auto a = detail::LoadMat4<V>(first, i);
+            auto b = detail::LoadMat4<V>(second, i);
+            detail::Mat4V<V> result;
+            for (int column = 0; column < 4; column++) {
+                for (int row = 0; row < 4; row++) {
+                    result.m[4 * column + row] = b.m[row] * a.m[4 * column]
+                                                 + b.m[4 + row] * a.m[4 * column + 1]
+                                                 + b.m[8 + row] * a.m[4 * column + 2]
+                                                 + b.m[12 + row] * a.m[4 * column + 3];
+                }
+            }
+            detail::StoreMat4(out, i, result);
+        });
+    }
+
+    void InverseAffine(Mat4Arrays in, Mat4Arrays out, size_t count) {
+        detail::DispatchGroups(count, [&]<typename V>(size_t i) {
+            auto t = detail::LoadMat4<V>(in, i);
+            // a_rc is row r, column c of the linear part
+            V a00 = t.m[0], a10 = t.m[1], a20 = t.m[2];
+            V a01 = t.m[4], a11 = t.m[5], a21 = t.m[6];
+            V a02 = t.m[8], a12 = t.m[9], a22 = t.m[10];
+
+            V c00 = a11 * a22 - a12 * a21;
+            V c01 = a12 * a20 - a10 * a22;
+            V c02 = a10 * a21 - a11 * a20;
+            V invDet = V::Set1(1.0f) / (a00 * c00 + a01 * c01 + a02 * c02);
+
+            // the inverse is the transposed cofactor matrix over the determinant
+            V i00 = c00 * invDet;
+            V i01 = (a02 * a21 - a01 * a22) * invDet;
+            V i02 = (a01 * a12 - a02 * a11) * invDet;
+            V i10 = c01 * invDet;
+            V i11 = (a00 * a22 - a02 * a20) * invDet;
+            V i12 = (a02 * a10 - a00 * a12) * invDet;
+            V i20 = c02 * invDet;
+            V i21 = (a01 * a20 - a00 * a21) * invDet;
+            V i22 = (a00 * a11 - a01 * a10) * invDet;
+
+            V zero = V::Set1(0.0f);
+            detail::StoreMat4(out, i, detail::Mat4V<V> {{
+                i00, i10, i20, zero,
+                i01, i11, i21, zero,
+                i02, i12, i22, zero,
+                -(i00 * t.m[12] + i01 * t.m[13] + i02 * t.m[14]),
+                -(i10 * t.m[12] + i11 * t.m[13] + i12 * t.m[14]),
+                -(i20 * t.m[12] + i21 * t.m[13] + i22 * t.m[14]),
+                V::Set1(1.0f)
+            }});
+        });
+    }
+
+    void TransformPoints(const al::Transform& transform, Vec3fArrays points, Vec3fArrays out, size_t count) {
+        detail::DispatchVectorType([&]<typename V>() {
+            // splatted once, since the stores to out could alias transform and would make every group load it again
+            detail::Mat4V<V> vector;
+            detail::Mat4V<detail::FloatScalar> scalar;
+            for (int k = 0; k < 16; k++) {
+                vector.m[k] = V::Set1(transform.m[k / 4][k % 4]);
+                scalar.m[k] = detail::FloatScalar::Set1(transform.m[k / 4][k % 4]);
+            }
+            detail::ForEachGroup<V>(count, [&]<typename W>(size_t i) {
+                const auto& t = [&]() -> const detail::Mat4V<W>& {
+                    if constexpr(std::is_same_v<W, V>) {
+                        return vector;
+                    } else {
+                        return scalar;
+                    }
+                }();
+                detail::StoreVec3(out, i, detail::TransformPoint(t, detail::LoadVec3<W>(points, i)));
+            });
+        });
+    }
+
+    void LoadTransforms(const al::Transform* in, Mat4Arrays out, size_t count) {
+        for (size_t i = 0; i < count; i++) {
+            for (int k = 0; k < 16; k++) {
+                out.m[k][i] = in[i].m[k / 4][k % 4];
+            }
+        }
+    }
+
+    void StoreTransforms(Mat4Arrays in, al::Transform* out, size_t count) {
+        for (size_t i = 0; i < count; i++) {
+            for (int k = 0; k < 16; k++) {
+                out[i].m[k / 4][k % 4] = in.m[k][i];
+            }
+        }
+    }
+
+    TransformValidationReport ValidateTransformKernels(size_t count, uint32_t seed) {
+        std::mt19937 rng(seed);
+        std::uniform_real_distribution<float> angleDist(-std::numbers::pi_v<float>, std::numbers::pi_v<float>);
+        std::uniform_real_distribution<float> scaleDist(0.5f, 2.0f);
+        std::uniform_real_distribution<float> positionDist(-100.0f, 100.0f);
+
+        std::vector<float> storage;
+        auto allocate = [&](int numArrays) {
+            size_t offset = storage.size();
+            storage.resize(offset + numArrays * count);
+            return offset;
+        };
+        // offsets first, pointers once storage has stopped growing
+        size_t translationAt = allocate(3), anglesAt = allocate(3), scaleAt = allocate(3);
+        size_t pointsAt = allocate(3), transformedAt = allocate(3), quatAt = allocate(4);
+        size_t trsAt = allocate(16), rotationAt = allocate(16), quatRotationAt = allocate(16);
+        size_t inverseAt = allocate(16), productAt = allocate(16);
+
+        auto vec3 = [&](size_t at) {
+            return Vec3fArrays {&storage[at], &storage[at + count], &storage[at + 2 * count]};
+        };
+        auto mat4 = [&](size_t at) {
+            Mat4Arrays result;
+            for (int k = 0; k < 16; k++) {
+                result.m[k] = &storage[at + k * count];
+            }
+            return result;
+        };
+        QuatArrays quat {&storage[quatAt], &storage[quatAt + count], &storage[quatAt + 2 * count], &storage[quatAt + 3 * count]};
+
+        std::vector<al::Transform> references(count);
+        for (size_t i = 0; i < count; i++) {
+            al::Vec3f translation {positionDist(rng), positionDist(rng), positionDist(rng)};
+            al::Vec3f angles {angleDist(rng), angleDist(rng), angleDist(rng)};
+            al::Vec3f scale {scaleDist(rng), scaleDist(rng), scaleDist(rng)};
+            for (int k = 0; k < 3; k++) {
+                storage[translationAt + k * count + i] = translation[k];
+                storage[anglesAt + k * count + i] = angles[k];
+                storage[scaleAt + k * count + i] = scale[k];
+                storage[pointsAt + k * count + i] = positionDist(rng);
+            }
+
+            auto& reference = references[i];
+            for (int column = 0; column < 4; column++) {
+                for (int row = 0; row < 4; row++) {
+                    reference.m[column][row] = column == row ? 1.0f : 0.0f;
+                }
+            }
+            reference.rotate(angles).scale(scale).translate(translation);
+        }
+
+        TransformValidationReport report {.count = count};
+
+        ComposeTRS(vec3(translationAt), vec3(anglesAt), vec3(scaleAt), mat4(trsAt), count);
+        EulerToMatrix(vec3(anglesAt), mat4(rotationAt), count);
+        EulerToQuat(vec3(anglesAt), quat, count);
+        QuatToMatrix(quat, mat4(quatRotationAt), count);
+        InverseAffine(mat4(trsAt), mat4(inverseAt), count);
+        Compose(mat4(trsAt), mat4(inverseAt), mat4(productAt), count);
+        TransformPoints(references.front(), vec3(pointsAt), vec3(transformedAt), count);
+
+        for (size_t i = 0; i < count; i++) {
+            const auto& reference = references[i];
+            for (int k = 0; k < 16; k++) {
+                float expected = reference.m[k / 4][k % 4];
+                report.composeError = std::max(report.composeError, detail::RelativeError(mat4(trsAt).m[k][i], expected));
+                report.quatError = std::max(report.quatError, detail::RelativeError(mat4(quatRotationAt).m[k][i], mat4(rotationAt).m[k][i]));
+                report.inverseError = std::max(report.inverseError, detail::RelativeError(mat4(productAt).m[k][i], k % 5 == 0 ? 1.0f : 0.0f));
+            }
+
+            const auto& shared = references.front();
+            for (int row = 0; row < 3; row++) {
+                float expected = shared.m[3][row];
+                for (int column = 0; column < 3; column++) {
+                    expected += shared.m[column][row] * storage[pointsAt + column * count + i];
+                }
+                report.pointError = std::max(report.pointError, detail::RelativeError(storage[transformedAt + row * count + i], expected));
+            }
+        }
+        return report;
+    }
+
+} // lpg::math
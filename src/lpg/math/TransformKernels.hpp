@@ -0,0 +1,109 @@
+//
+// Created by volt on 2026-10-19.
+//
+
+
+
+
+#ifndef LPG_ENGINE_SRC_LPG_MATH_TRANSFORMKERNELS_HPP_
+#define LPG_ENGINE_SRC_LPG_MATH_TRANSFORMKERNELS_HPP_
+
+#include <cstddef>
+#include <cstdint>
+
+#include <axxegro/core/Transform.hpp>
+
+#include "../util/SimdKernels.hpp"
+
+namespace lpg::math {
+
+    /*
+     * Batch kernels over structure-of-arrays data: element i of a batch is (x[i], y[i], z[i]) and so on.
+     * Every kernel processes count elements, as many at a time as simd::GetInstructionSet() allows
+     * (8 with AVX2, 4 with SSE2), with a scalar tail.
+     * Inputs and outputs may be the same arrays.
+     *
+     * Matrices follow the ALLEGRO_TRANSFORM layout: m[4 * column + row], where column 3 holds the translation,
+     * so they convert to and from al::Transform by copying.
+     */
+
+    using Vec3fArrays = simd::Vec3fArrays;
+
+    struct QuatArrays {
+        float* x;
+        float* y;
+        float* z;
+        float* w;
+    };
+
+    struct Mat4Arrays {
+        float* m[16];
+    };
+
+    /*
+     * Euler angles in radians, applied as a rotation about X, then Y, then Z (R = Rz * Ry * Rx);
+     * al::Transform::rotate with the same angles is expected to agree, see ValidateTransformKernels.
+     */
+    void EulerToMatrix(Vec3fArrays angles, Mat4Arrays out, size_t count);
+    void EulerToQuat(Vec3fArrays angles, QuatArrays out, size_t count);
+
+    /*
+     * Quaternions are expected to be normalized.
+     */
+    void QuatToMatrix(QuatArrays rotation, Mat4Arrays out, size_t count);
+
+    /*
+     * out = a * b, the rotation b followed by a.
+     */
+    void QuatMultiply(QuatArrays a, QuatArrays b, QuatArrays out, size_t count);
+
+    /*
+     * Rotates by the Euler angles, then scales, then translates: the same matrix as
+     * identity.rotate(angles).scale(scale).translate(translation) on al::Transform.
+     */
+    void ComposeTRS(Vec3fArrays translation, Vec3fArrays angles, Vec3fArrays scale, Mat4Arrays out, size_t count);
+
+    /*
+     * The transform that applies first and then second, like al_compose_transform(first, second).
+     */
+    void Compose(Mat4Arrays first, Mat4Arrays second, Mat4Arrays out, size_t count);
+
+    /*
+     * Inverts affine transforms (the last row is taken to be 0 0 0 1). Singular matrices give non-finite results.
+     */
+    void InverseAffine(Mat4Arrays in, Mat4Arrays out, size_t count);
+
+    /*
+     * Transforms every point by the same matrix, ignoring the projective row like al_transform_coordinates_3d,
+     * e.g. the vertices of one skinned bone or the corners of bounding boxes.
+     * There is no overload with a matrix per point: loading 12 matrix streams per point is no faster than al::Transform.
+     */
+    void TransformPoints(const al::Transform& transform, Vec3fArrays points, Vec3fArrays out, size_t count);
+
+    void LoadTransforms(const al::Transform* in, Mat4Arrays out, size_t count);
+    void StoreTransforms(Mat4Arrays in, al::Transform* out, size_t count);
+
+    /*
+     * Largest relative differences (|a - b| / max(1, |b|)) found by ValidateTransformKernels.
+     */
+    struct TransformValidationReport {
+        size_t count;
+        float composeError; // ComposeTRS against al::Transform rotate/scale/translate
+        float quatError; // QuatToMatrix(EulerToQuat) against EulerToMatrix
+        float inverseError; // Compose(m, InverseAffine(m)) against the identity
+        float pointError; // TransformPoints by the first transform against its al::Transform matrix applied one point at a time
+
+        [[nodiscard]] bool passed(float tolerance = 1e-4f) const {
+            return composeError <= tolerance && quatError <= tolerance && inverseError <= tolerance && pointError <= tolerance;
+        }
+    };
+
+    /*
+     * Runs the kernels over count random transforms and compares them with al::Transform and with each other.
+     * Meant for tests and for checking a new platform or compiler; it allocates and is not fast.
+     */
+    TransformValidationReport ValidateTransformKernels(size_t count = 4096, uint32_t seed = 1);
+
+} // lpg::math
+
+#endif //LPG_ENGINE_SRC_LPG_MATH_TRANSFORMKERNELS_HPP_
@@ -7,5 +7,841 @@
 
 #include "PhysicsSimulationSystem.hpp"
 
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include <bullet/btBulletDynamicsCommon.h>
+#include <bullet/BulletCollision/CollisionShapes/btHeightfieldTerrainShape.h>
+
+#include "../core/EntityPage.hpp"
+#include "../core/Profiler.hpp"
+#include "../core/World.hpp"
+#include "../core/util.hpp"
+#include "../util/HeightGrid.hpp"
+#include "../util/ThreadPool.hpp"
+
 namespace lpg {
-} // lpg
\ No newline at end of file
+
+    namespace detail {
+
+        struct PhysicsPage;
+
+        /*
+         * A collision object as queries see it: at its transform of the last published step, in a tree of
+         * PhysicsData::queryTree that msg() updates between steps. Queries may then run while Bullet steps,
+         * which moves its broadphase around. filter holds the object's collision filter group and mask.
+         */
+        struct PhysicsQueryProxy {
+            btDbvtNode* leaf = nullptr;
+            btCollisionObject* object = nullptr;
+            btTransform transform;
+            btBroadphaseProxy filter;
+        };
+
+        /*
+         * Bullet calls setWorldTransform only for active, non-kinematic bodies after each step,
+         * which is what makes sleeping bodies free: their slots are never flagged.
+         *
+         * transform belongs to the thread stepping Bullet. previous and current are the published snapshot:
+         * the results of the last two steps, only written by msg() while no step is in flight.
+         */
+        struct PhysicsBody final: btMotionState {
+            PhysicsPage* page = nullptr;
+            int slot = 0;
+            uint32_t id = 0;
+            btTransform transform;
+            btTransform previous;
+            btTransform current;
+            std::unique_ptr<btRigidBody> rigidBody;
+            PhysicsQueryProxy query;
+
+            void getWorldTransform(btTransform& worldTransform) const override {
+                worldTransform = transform;
+            }
+
+            void setWorldTransform(const btTransform& worldTransform) override;
+        };
+
+        /*
+         * Mirrors one page of RigidBody components. Slot N holds the body of the owner in slot N of the owner page.
+         */
+        struct PhysicsPage {
+            int32_t pageId;
+            int32_t ownerPageId;
+            uint32_t seenStructureVersion = 0;
+
+            std::array<uint64_t, EntityPageSize / 64> movedMask {};
+            std::array<uint64_t, EntityPageSize / 64> publishedMask {}; // moved in the last published step
+            bool queuedForSync = false;
+            std::vector<PhysicsPage*>* syncQueue;
+
+            std::array<std::unique_ptr<PhysicsBody>, EntityPageSize> bodies;
+        };
+
+        void PhysicsBody::setWorldTransform(const btTransform& worldTransform) {
+            transform = worldTransform;
+            page->movedMask[slot / 64] |= uint64_t{1} << (slot % 64);
+            if (not page->queuedForSync) {
+                page->queuedForSync = true;
+                page->syncQueue->push_back(page);
+            }
+        }
+
+        /*
+         * Offsets of the owner's writable al::Vec3f position and rotation fields; -1 if it has none.
+         */
+        struct PhysicsOwnerBinding {
+            bool resolved = false;
+            int positionOffset = -1;
+            int rotationOffset = -1;
+        };
+
+        struct PhysicsCommand {
+            PhysicsCommandType type;
+            EntityDescriptor owner;
+            al::Vec3f value;
+            PhysicsBody* body; // resolved by msg() before the step
+        };
+
+        /*
+         * A static body whose shape reads the heights straight from grid.
+         */
+        struct PhysicsTerrain {
+            int id;
+            std::shared_ptr<HeightGrid> grid;
+            int subscriptionId;
+            btVector3 origin;
+            std::unique_ptr<btHeightfieldTerrainShape> shape;
+            std::unique_ptr<btRigidBody> body;
+            PhysicsQueryProxy query;
+        };
+
+        struct TerrainEdit {
+            int terrainId;
+            HeightGridRegion region;
+        };
+
+        struct PhysicsData {
+            World& world;
+            int32_t rigidBodyTypeId = GetEntityTypeId<RigidBody>();
+
+            btDefaultCollisionConfiguration collisionConfiguration;
+            btCollisionDispatcher dispatcher {&collisionConfiguration};
+            btDbvtBroadphase broadphase;
+            btSequentialImpulseConstraintSolver solver;
+            btDiscreteDynamicsWorld dynamicsWorld {&dispatcher, &broadphase, &solver, &collisionConfiguration};
+            PhysicsConfig config;
+
+            std::map<std::tuple<CollisionShapeType, float, float, float>, std::unique_ptr<btCollisionShape>> shapes;
+            std::vector<std::unique_ptr<PhysicsPage>> pagesById; // indexed by the id of the RigidBody page
+            std::vector<PhysicsOwnerBinding> ownerBindings; // indexed by owner entity type id
+            std::vector<PhysicsPage*> syncQueue; // pages with moved bodies, filled while stepping
+            std::vector<PhysicsPage*> publishedPages; // pages with bodies moved in the last published step
+            uint32_t lastBodyId = 0;
+            btDbvt queryTree; // of PhysicsQueryProxy, only changed by msg() and the other calls that may not overlap with queries
+
+            std::mutex queueMutex;
+            std::vector<EntityDescriptor> dirtyOwners;
+            std::vector<EntityDescriptor> dirtyOwnersScratch;
+            std::vector<PhysicsCommand> commands;
+            std::vector<PhysicsCommand> stepCommands; // owned by the step once it is in flight
+            std::vector<TerrainEdit> terrainEdits;
+            std::vector<TerrainEdit> terrainEditsScratch;
+
+            std::vector<std::unique_ptr<PhysicsTerrain>> terrains;
+            int lastTerrainId = 0;
+
+            PhysicsStepStats stats;
+
+            std::mutex stepMutex;
+            std::condition_variable stepFinished;
+            bool stepInFlight = false;
+            std::unique_ptr<ThreadPool> worker; // nullptr when stepping on the calling thread
+
+            PhysicsData(World& world, const PhysicsConfig& config): world(world), config(config) {
+                if (config.stepOnWorkerThread) {
+                    worker = std::make_unique<ThreadPool>(1);
+                }
+            }
+
+            void waitForStep() {
+                std::unique_lock lock(stepMutex);
+                stepFinished.wait(lock, [this] { return not stepInFlight; });
+            }
+
+            ~PhysicsData() {
+                waitForStep();
+                worker.reset();
+                // bodies must leave the dynamics world before it is destroyed
+                for (auto& page: pagesById) {
+                    if (not page) {
+                        continue;
+                    }
+                    for (auto& body: page->bodies) {
+                        if (body) {
+                            dynamicsWorld.removeRigidBody(body->rigidBody.get());
+                        }
+                    }
+                }
+                for (auto& terrain: terrains) {
+                    terrain->grid->unsubscribe(terrain->subscriptionId);
+                    dynamicsWorld.removeRigidBody(terrain->body.get());
+                }
+            }
+        };
+
+        static btTransform MakeBtTransform(al::Vec3f position, al::Vec3f rotation) {
+            btMatrix3x3 basis;
+            // rotation about X, then Y, then Z, like al::Transform::rotate
+            basis.setEulerZYX(rotation.x, rotation.y, rotation.z);
+            return btTransform(basis, btVector3(position.x, position.y, position.z));
+        }
+
+        static btDbvtVolume GetQueryVolume(const PhysicsQueryProxy& proxy) {
+            btVector3 lo, hi;
+            proxy.object->getCollisionShape()->getAabb(proxy.transform, lo, hi);
+            return btDbvtVolume::FromMM(lo, hi);
+        }
+
+        /*
+         * object must already be in the dynamics world, which assigns its collision filter.
+         */
+        static void InsertQueryProxy(PhysicsData& data, PhysicsQueryProxy& proxy, btCollisionObject& object, const btTransform& transform) {
+            proxy.object = &object;
+            proxy.transform = transform;
+            proxy.filter.m_collisionFilterGroup = object.getBroadphaseHandle()->m_collisionFilterGroup;
+            proxy.filter.m_collisionFilterMask = object.getBroadphaseHandle()->m_collisionFilterMask;
+            proxy.leaf = data.queryTree.insert(GetQueryVolume(proxy), &proxy);
+        }
+
+        static void UpdateQueryProxy(PhysicsData& data, PhysicsQueryProxy& proxy, const btTransform& transform) {
+            proxy.transform = transform;
+            btDbvtVolume volume = GetQueryVolume(proxy);
+            data.queryTree.update(proxy.leaf, volume);
+        }
+
+        static void RemoveQueryProxy(PhysicsData& data, PhysicsQueryProxy& proxy) {
+            data.queryTree.remove(proxy.leaf);
+            proxy.leaf = nullptr;
+        }
+
+        static int FindVec3fProperty(const EntityInterface& entityInterface, std::string_view name) {
+            if (not entityInterface.propertyNamePerfectHash) {
+                return -1;
+            }
+            int32_t index = entityInterface.propertyNamePerfectHash(name);
+            if (index < 0 || index >= entityInterface.properties.size()) {
+                return -1;
+            }
+            const auto& property = entityInterface.properties[index];
+            if (property.typeKey != GetTypeKey<al::Vec3f>() || property.isConst) {
+                return -1;
+            }
+            return property.offset;
+        }
+
+        static const PhysicsOwnerBinding& GetOwnerBinding(PhysicsData& data, int32_t ownerTypeId) {
+            vec::ResizeFor(data.ownerBindings, ownerTypeId);
+            auto& binding = data.ownerBindings[ownerTypeId];
+            if (not binding.resolved) {
+                const auto& ownerInterface = data.world.getEntityInterface(ownerTypeId);
+                binding.positionOffset = FindVec3fProperty(ownerInterface, "position");
+                binding.rotationOffset = FindVec3fProperty(ownerInterface, "rotation");
+                binding.resolved = true;
+            }
+            return binding;
+        }
+
+        static btCollisionShape* GetShape(PhysicsData& data, CollisionShapeType type, al::Vec3f dims) {
+            auto key = std::make_tuple(type, dims.x, dims.y, dims.z);
+            auto& shape = data.shapes[key];
+            if (not shape) {
+                switch (type) {
+                    case CollisionShapeType::Box:
+                        shape = std::make_unique<btBoxShape>(btVector3(dims.x, dims.y, dims.z));
+                        break;
+                    case CollisionShapeType::Sphere:
+                        shape = std::make_unique<btSphereShape>(dims.x);
+                        break;
+                    case CollisionShapeType::Capsule:
+                        shape = std::make_unique<btCapsuleShape>(dims.x, 2.0f * dims.y);
+                        break;
+                }
+            }
+            return shape.get();
+        }
+
+        static void CreateBody(PhysicsData& data, PhysicsPage& page, int slot, RigidBody& rigidBody) {
+            auto& ownerPage = data.world.getPage(page.ownerPageId);
+            const auto& ownerInterface = data.world.getEntityInterface(ownerPage.entityTypeId);
+            void* owner = ownerPage.entityPtr(slot);
+
+            al::Vec3f scale = ownerInterface.getScale(owner);
+            al::Vec3f dims {rigidBody.halfExtents.x * scale.x, rigidBody.halfExtents.y * scale.y, rigidBody.halfExtents.z * scale.z};
+            btCollisionShape* shape = GetShape(data, rigidBody.shape, dims);
+
+            float mass = rigidBody.kinematic ? 0.0f : rigidBody.mass;
+            btVector3 localInertia(0, 0, 0);
+            if (mass > 0.0f) {
+                shape->calculateLocalInertia(mass, localInertia);
+            }
+
+            auto body = std::make_unique<PhysicsBody>();
+            body->page = &page;
+            body->slot = slot;
+            body->id = ++data.lastBodyId;
+            body->transform = MakeBtTransform(ownerInterface.getPosition(owner), ownerInterface.getRotation(owner));
+            body->previous = body->transform;
+            body->current = body->transform;
+
+            btRigidBody::btRigidBodyConstructionInfo info(mass, body.get(), shape, localInertia);
+            info.m_friction = rigidBody.friction;
+            info.m_restitution = rigidBody.restitution;
+            body->rigidBody = std::make_unique<btRigidBody>(info);
+            body->rigidBody->setUserIndex(static_cast<int>(page.ownerPageId * EntityPageSize + slot));
+            if (rigidBody.kinematic) {
+                body->rigidBody->setCollisionFlags(body->rigidBody->getCollisionFlags() | btCollisionObject::CF_KINEMATIC_OBJECT);
+                body->rigidBody->setActivationState(DISABLE_DEACTIVATION);
+            }
+
+            data.dynamicsWorld.addRigidBody(body->rigidBody.get());
+            InsertQueryProxy(data, body->query, *body->rigidBody, body->current);
+            rigidBody.bodyId = body->id;
+            page.bodies[slot] = std::move(body);
+            data.stats.numBodies++;
+        }
+
+        static void DestroyBody(PhysicsData& data, PhysicsPage& page, int slot) {
+            RemoveQueryProxy(data, page.bodies[slot]->query);
+            data.dynamicsWorld.removeRigidBody(page.bodies[slot]->rigidBody.get());
+            page.bodies[slot].reset();
+            page.movedMask[slot / 64] &= ~(uint64_t{1} << (slot % 64));
+            page.publishedMask[slot / 64] &= ~(uint64_t{1} << (slot % 64));
+            data.stats.numBodies--;
+        }
+
+        static PhysicsBody* FindBody(PhysicsData& data, EntityDescriptor owner) {
+            auto [pageId, slot] = DecomposeEntityDescriptor(owner);
+            auto& ownerPage = data.world.getPage(pageId);
+            if (not ownerPage.isEntityPresent(slot)) {
+                return nullptr;
+            }
+            for (int32_t linkedPageId: ownerPage.managedComponentPages) {
+                auto* physicsPage = vec::TryGet(data.pagesById, linkedPageId);
+                if (physicsPage && *physicsPage && (*physicsPage)->bodies[slot]) {
+                    return (*physicsPage)->bodies[slot].get();
+                }
+            }
+            return nullptr;
+        }
+
+        static btVector3 ToBtVector3(al::Vec3f v) {
+            return btVector3(v.x, v.y, v.z);
+        }
+
+        /*
+         * Runs on the worker thread when there is one. Touches nothing but Bullet and the bodies.
+         */
+        static void RunStep(PhysicsData& data, double deltaTime) {
+            LPG_PROFILE_ZONE("PhysicsSimulationSystem::stepSimulation");
+            for (const auto& command: data.stepCommands) {
+                btRigidBody& rigidBody = *command.body->rigidBody;
+                switch (command.type) {
+                    case PhysicsCommandType::SetLinearVelocity:
+                        rigidBody.setLinearVelocity(ToBtVector3(command.value));
+                        break;
+                    case PhysicsCommandType::SetAngularVelocity:
+                        rigidBody.setAngularVelocity(ToBtVector3(command.value));
+                        break;
+                    case PhysicsCommandType::ApplyCentralImpulse:
+                        rigidBody.applyCentralImpulse(ToBtVector3(command.value));
+                        break;
+                }
+                rigidBody.activate(true);
+            }
+            data.stepCommands.clear();
+            data.dynamicsWorld.stepSimulation(static_cast<btScalar>(deltaTime), data.config.maxSubSteps, static_cast<btScalar>(data.config.fixedTimeStep));
+        }
+
+        /*
+         * Grid space, with the height along z, to world space.
+         */
+        static btVector3 GridToWorld(int upAxis, float x, float y, float height) {
+            return upAxis == 2 ? btVector3(x, y, height) : btVector3(x, height, y);
+        }
+
+        /*
+         * Activates every body whose bounds overlap the query box.
+         */
+        struct WakeBodiesCallback final: btBroadphaseAabbCallback {
+            bool process(const btBroadphaseProxy* proxy) override {
+                static_cast<btCollisionObject*>(proxy->m_clientObject)->activate(true);
+                return true;
+            }
+        };
+
+        /*
+         * Segments are clamped to this length, Bullet needs finite ones.
+         */
+        static constexpr float MaxQueryDistance = 1.0e5f;
+
+        /*
+         * btCollisionWorld::rayTest and convexSweepTest share a traversal stack inside the broadphase, which the
+         * step in flight moves around besides, so queries walk PhysicsData::queryTree with the reentrant btDbvt
+         * traversals and pass its proxies to the same narrowphase as those functions, at their published transforms.
+         */
+        struct RayTestPolicy final: btDbvt::ICollide {
+            const btTransform& from;
+            const btTransform& to;
+            btCollisionWorld::ClosestRayResultCallback& callback;
+
+            RayTestPolicy(const btTransform& from, const btTransform& to, btCollisionWorld::ClosestRayResultCallback& callback):
+                from(from), to(to), callback(callback) {}
+
+            void Process(const btDbvtNode* leaf) override {
+                auto& proxy = *static_cast<PhysicsQueryProxy*>(leaf->data);
+                if (callback.needsCollision(&proxy.filter)) {
+                    btCollisionWorld::rayTestSingle(from, to, proxy.object, proxy.object->getCollisionShape(), proxy.transform, callback);
+                }
+            }
+        };
+
+        struct SphereCastPolicy final: btDbvt::ICollide {
+            const btConvexShape& shape;
+            const btTransform& from;
+            const btTransform& to;
+            btCollisionWorld::ClosestConvexResultCallback& callback;
+
+            SphereCastPolicy(const btConvexShape& shape, const btTransform& from, const btTransform& to, btCollisionWorld::ClosestConvexResultCallback& callback):
+                shape(shape), from(from), to(to), callback(callback) {}
+
+            void Process(const btDbvtNode* leaf) override {
+                auto& proxy = *static_cast<PhysicsQueryProxy*>(leaf->data);
+                if (callback.needsCollision(&proxy.filter)) {
+                    btCollisionWorld::objectQuerySingle(&shape, from, to, proxy.object, proxy.object->getCollisionShape(), proxy.transform, callback, 0.0f);
+                }
+            }
+        };
+
+        /*
+         * The end of the query's segment and its length, or false if the direction is zero.
+         */
+        static bool GetQuerySegment(const RayQuery& ray, btVector3& from, btVector3& to, float& length) {
+            btVector3 direction = ToBtVector3(ray.direction);
+            if (not (direction.length2() > 0.0f)) {
+                return false;
+            }
+            length = std::min(ray.maxDistance, MaxQueryDistance);
+            from = ToBtVector3(ray.origin);
+            to = from + direction.normalized() * length;
+            return true;
+        }
+
+        static RayHit MakeRayHit(const btCollisionObject* object, float distance, const btVector3& point, const btVector3& normal) {
+            return {
+                .hit = true,
+                .entity = static_cast<EntityDescriptor>(object->getUserIndex()),
+                .distance = distance,
+                .point = {point.x(), point.y(), point.z()},
+                .normal = {normal.x(), normal.y(), normal.z()}
+            };
+        }
+
+        static RayHit CastRay(PhysicsData& data, const RayQuery& ray) {
+            btVector3 from, to;
+            float length;
+            if (not GetQuerySegment(ray, from, to, length)) {
+                return {};
+            }
+            btCollisionWorld::ClosestRayResultCallback callback(from, to);
+            callback.m_collisionFilterMask = static_cast<int>(ray.collidesWith);
+            btTransform fromTransform(btMatrix3x3::getIdentity(), from);
+            btTransform toTransform(btMatrix3x3::getIdentity(), to);
+            RayTestPolicy policy(fromTransform, toTransform, callback);
+            btDbvt::rayTest(data.queryTree.m_root, from, to, policy);
+            if (not callback.hasHit()) {
+                return {};
+            }
+            return MakeRayHit(callback.m_collisionObject, callback.m_closestHitFraction * length, callback.m_hitPointWorld, callback.m_hitNormalWorld);
+        }
+
+        static RayHit CastSphere(PhysicsData& data, const RayQuery& ray, float radius) {
+            btVector3 from, to;
+            float length;
+            if (not GetQuerySegment(ray, from, to, length)) {
+                return {};
+            }
+            btSphereShape sphere(radius);
+            btCollisionWorld::ClosestConvexResultCallback callback(from, to);
+            callback.m_collisionFilterMask = static_cast<int>(ray.collidesWith);
+            btTransform fromTransform(btMatrix3x3::getIdentity(), from);
+            btTransform toTransform(btMatrix3x3::getIdentity(), to);
+            SphereCastPolicy policy(sphere, fromTransform, toTransform, callback);
+            btVector3 margin(radius, radius, radius);
+            btVector3 lo = from, hi = from;
+            lo.setMin(to);
+            hi.setMax(to);
+            btDbvtVolume volume = btDbvtVolume::FromMM(lo - margin, hi + margin);
+            data.queryTree.collideTV(data.queryTree.m_root, volume, policy);
+            if (not callback.hasHit()) {
+                return {};
+            }
+            return MakeRayHit(callback.m_hitCollisionObject, callback.m_closestHitFraction * length, callback.m_hitPointWorld, callback.m_hitNormalWorld);
+        }
+
+    } // namespace detail
+
+    PhysicsSimulationSystem::PhysicsSimulationSystem(World& world, const PhysicsConfig& config):
+        data_(std::make_unique<detail::PhysicsData>(world, config)) {
+        data_->dynamicsWorld.setGravity(btVector3(config.gravity.x, config.gravity.y, config.gravity.z));
+    }
+
+    PhysicsSimulationSystem::~PhysicsSimulationSystem() = default;
+    PhysicsSimulationSystem::PhysicsSimulationSystem(PhysicsSimulationSystem&&) noexcept = default;
+    PhysicsSimulationSystem& PhysicsSimulationSystem::operator=(PhysicsSimulationSystem&&) noexcept = default;
+
+    void PhysicsSimulationSystem::msg(FixedUpdateMessage* message) {
+        LPG_PROFILE_ZONE("PhysicsSimulationSystem::step");
+        auto& data = *data_;
+
+        {
+            LPG_PROFILE_ZONE("PhysicsSimulationSystem::waitForStep");
+            data.waitForStep();
+        }
+        int numBodies = data.stats.numBodies;
+        data.stats = {.numBodies = numBodies};
+
+        // structural changes and teleports first, so that publishing never writes to a despawned or teleported owner
+        syncStructure();
+        applyDirty();
+        applyTerrainEdits();
+        // results of the step started by the previous call on the worker
+        if (data.worker) {
+            publishStep();
+        }
+        resolveCommands();
+
+        if (not data.worker) {
+            detail::RunStep(data, message->deltaTime);
+            publishStep();
+            return;
+        }
+        {
+            std::lock_guard lock(data.stepMutex);
+            data.stepInFlight = true;
+        }
+        data.worker->submit([&data, deltaTime = message->deltaTime] {
+            detail::RunStep(data, deltaTime);
+            {
+                std::lock_guard lock(data.stepMutex);
+                data.stepInFlight = false;
+            }
+            data.stepFinished.notify_all();
+        });
+    }
+
+    void PhysicsSimulationSystem::waitForStep() {
+        data_->waitForStep();
+    }
+
+    void PhysicsSimulationSystem::syncStructure() {
+        LPG_PROFILE_ZONE("PhysicsSimulationSystem::syncStructure");
+        auto& data = *data_;
+
+        for (int pageId: data.world.getPagesOfType(data.rigidBodyTypeId)) {
+            auto& page = data.world.getPage(pageId);
+            // a RigidBody spawned on its own has no owner to move
+            if (page.parentPage == -1) {
+                continue;
+            }
+
+            vec::ResizeFor(data.pagesById, pageId);
+            auto& physicsPage = data.pagesById[pageId];
+            if (not physicsPage) {
+                physicsPage = std::make_unique<detail::PhysicsPage>();
+                physicsPage->pageId = pageId;
+                physicsPage->ownerPageId = page.parentPage;
+                physicsPage->syncQueue = &data.syncQueue;
+            }
+            if (physicsPage->seenStructureVersion == page.structureVersion) {
+                continue;
+            }
+            physicsPage->seenStructureVersion = page.structureVersion;
+            data.stats.numPagesRescanned++;
+
+            for (int slot = 0; slot < detail::EntityPageSize; slot++) {
+                bool present = page.isEntityPresent(slot);
+                auto& body = physicsPage->bodies[slot];
+                auto* rigidBody = present ? static_cast<RigidBody*>(page.entityPtr(slot)) : nullptr;
+                // a different entity may have been spawned into the slot since the last scan
+                if (body && (not present || rigidBody->bodyId != body->id)) {
+                    detail::DestroyBody(data, *physicsPage, slot);
+                }
+                if (present && not body) {
+                    detail::CreateBody(data, *physicsPage, slot, *rigidBody);
+                }
+            }
+        }
+    }
+
+    void PhysicsSimulationSystem::applyDirty() {
+        auto& data = *data_;
+        {
+            std::lock_guard lock(data.queueMutex);
+            data.dirtyOwnersScratch.swap(data.dirtyOwners);
+        }
+
+        for (EntityDescriptor owner: data.dirtyOwnersScratch) {
+            detail::PhysicsBody* body = detail::FindBody(data, owner);
+            if (not body) {
+                continue;
+            }
+            auto [pageId, slot] = DecomposeEntityDescriptor(owner);
+            auto& ownerPage = data.world.getPage(pageId);
+            const auto& ownerInterface = data.world.getEntityInterface(ownerPage.entityTypeId);
+            void* ownerPtr = ownerPage.entityPtr(slot);
+
+            body->transform = detail::MakeBtTransform(ownerInterface.getPosition(ownerPtr), ownerInterface.getRotation(ownerPtr));
+            // a teleport is not interpolated
+            body->previous = body->transform;
+            body->current = body->transform;
+            detail::UpdateQueryProxy(data, body->query, body->current);
+            body->page->movedMask[body->slot / 64] &= ~(uint64_t{1} << (body->slot % 64));
+            if (not body->rigidBody->isKinematicObject()) {
+                body->rigidBody->setWorldTransform(body->transform);
+                body->rigidBody->setInterpolationWorldTransform(body->transform);
+                body->rigidBody->activate(true);
+            }
+            data.stats.numDirtyApplied++;
+        }
+        data.dirtyOwnersScratch.clear();
+    }
+
+    void PhysicsSimulationSystem::applyTerrainEdits() {
+        auto& data = *data_;
+        // no step is in flight, so the grids' buffers may change; their subscriptions queue the edited regions
+        for (auto& terrain: data.terrains) {
+            terrain->grid->applyEdits();
+        }
+        {
+            std::lock_guard lock(data.queueMutex);
+            data.terrainEditsScratch.swap(data.terrainEdits);
+        }
+
+        detail::WakeBodiesCallback wakeBodies;
+        for (const auto& edit: data.terrainEditsScratch) {
+            auto terrain = std::find_if(data.terrains.begin(), data.terrains.end(), [&edit](const auto& terrain) {
+                return terrain->id == edit.terrainId;
+            });
+            if (terrain == data.terrains.end()) {
+                continue;
+            }
+            const HeightGrid& grid = *(*terrain)->grid;
+            // the triangles touching an edited sample reach one cell further, and anything above them may rest on them
+            HeightGridRegion region = edit.region.grown(1, grid.getWidth(), grid.getDepth());
+            float cellSize = grid.getCellSize();
+            btVector3 lo = detail::GridToWorld(data.config.terrainUpAxis, region.x0 * cellSize, region.y0 * cellSize, grid.getMinHeight());
+            btVector3 hi = detail::GridToWorld(data.config.terrainUpAxis, (region.x1 - 1) * cellSize, (region.y1 - 1) * cellSize, grid.getMaxHeight());
+            data.broadphase.aabbTest((*terrain)->origin + lo, (*terrain)->origin + hi, wakeBodies);
+            data.stats.numTerrainEditsApplied++;
+        }
+        data.terrainEditsScratch.clear();
+    }
+
+    void PhysicsSimulationSystem::resolveCommands() {
+        auto& data = *data_;
+        {
+            std::lock_guard lock(data.queueMutex);
+            data.stepCommands.swap(data.commands);
+        }
+
+        // commands for owners without a body (yet) are dropped
+        std::erase_if(data.stepCommands, [&](detail::PhysicsCommand& command) {
+            command.body = detail::FindBody(data, command.owner);
+            return command.body == nullptr;
+        });
+    }
+
+    void PhysicsSimulationSystem::publishStep() {
+        LPG_PROFILE_ZONE("PhysicsSimulationSystem::publishStep");
+        auto& data = *data_;
+
+        // bodies that moved in the previous step but not in this one come to rest at their current transform
+        for (detail::PhysicsPage* physicsPage: data.publishedPages) {
+            for (int word = 0; word < physicsPage->publishedMask.size(); word++) {
+                uint64_t bits = physicsPage->publishedMask[word] & ~physicsPage->movedMask[word];
+                while (bits != 0) {
+                    int slot = word * 64 + std::countr_zero(bits);
+                    bits &= bits - 1;
+                    auto& body = *physicsPage->bodies[slot];
+                    body.previous = body.current;
+                }
+            }
+            physicsPage->publishedMask = {};
+        }
+        data.publishedPages.clear();
+
+        for (detail::PhysicsPage* physicsPage: data.syncQueue) {
+            auto& ownerPage = data.world.getPage(physicsPage->ownerPageId);
+            const auto& binding = detail::GetOwnerBinding(data, ownerPage.entityTypeId);
+            auto* ownerBase = static_cast<std::byte*>(ownerPage.entityPtr(0));
+
+            for (int word = 0; word < physicsPage->movedMask.size(); word++) {
+                uint64_t bits = std::exchange(physicsPage->movedMask[word], 0);
+                physicsPage->publishedMask[word] = bits;
+                while (bits != 0) {
+                    int slot = word * 64 + std::countr_zero(bits);
+                    bits &= bits - 1;
+
+                    auto& body = *physicsPage->bodies[slot];
+                    body.previous = body.current;
+                    body.current = body.transform;
+                    detail::UpdateQueryProxy(data, body.query, body.current);
+                    const btTransform& transform = body.current;
+                    std::byte* owner = ownerBase + slot * ownerPage.stride;
+                    if (binding.positionOffset >= 0) {
+                        const btVector3& origin = transform.getOrigin();
+                        *reinterpret_cast<al::Vec3f*>(owner + binding.positionOffset) = {origin.x(), origin.y(), origin.z()};
+                    }
+                    if (binding.rotationOffset >= 0) {
+                        btScalar z, y, x;
+                        transform.getBasis().getEulerZYX(z, y, x);
+                        *reinterpret_cast<al::Vec3f*>(owner + binding.rotationOffset) = {x, y, z};
+                    }
+                    data.stats.numOwnersSynced++;
+                }
+            }
+            physicsPage->queuedForSync = false;
+            data.publishedPages.push_back(physicsPage);
+            data.stats.numPagesSynced++;
+        }
+        data.syncQueue.clear();
+    }
+
+    void PhysicsSimulationSystem::markDirty(EntityDescriptor owner) {
+        std::lock_guard lock(data_->queueMutex);
+        data_->dirtyOwners.push_back(owner);
+    }
+
+    void PhysicsSimulationSystem::queueCommand(PhysicsCommandType type, EntityDescriptor owner, al::Vec3f value) {
+        std::lock_guard lock(data_->queueMutex);
+        data_->commands.push_back({.type = type, .owner = owner, .value = value, .body = nullptr});
+    }
+
+    void PhysicsSimulationSystem::setLinearVelocity(EntityDescriptor owner, al::Vec3f velocity) {
+        queueCommand(PhysicsCommandType::SetLinearVelocity, owner, velocity);
+    }
+
+    void PhysicsSimulationSystem::setAngularVelocity(EntityDescriptor owner, al::Vec3f velocity) {
+        queueCommand(PhysicsCommandType::SetAngularVelocity, owner, velocity);
+    }
+
+    void PhysicsSimulationSystem::applyCentralImpulse(EntityDescriptor owner, al::Vec3f impulse) {
+        queueCommand(PhysicsCommandType::ApplyCentralImpulse, owner, impulse);
+    }
+
+    bool PhysicsSimulationSystem::getInterpolatedTransform(EntityDescriptor owner, float alpha, al::Vec3f& position, al::Vec3f& rotation) {
+        detail::PhysicsBody* body = detail::FindBody(*data_, owner);
+        if (not body) {
+            return false;
+        }
+        btVector3 origin = body->previous.getOrigin().lerp(body->current.getOrigin(), alpha);
+        btQuaternion orientation = body->previous.getRotation().slerp(body->current.getRotation(), alpha);
+        btScalar z, y, x;
+        btMatrix3x3(orientation).getEulerZYX(z, y, x);
+        position = {origin.x(), origin.y(), origin.z()};
+        rotation = {x, y, z};
+        return true;
+    }
+
+    void PhysicsSimulationSystem::castRays(std::span<const RayQuery> rays, std::span<RayHit> hits) {
+        LPG_PROFILE_ZONE("PhysicsSimulationSystem::castRays");
+        if (hits.size() < rays.size()) {
+            throw std::runtime_error("Fewer hits than queries passed to PhysicsSimulationSystem::castRays");
+        }
+        auto& data = *data_;
+        detail::RunSpatialQueries(data.world.getScheduler().getThreadPool(), rays, [&](uint32_t i) {
+            hits[i] = detail::CastRay(data, rays[i]);
+        });
+    }
+
+    void PhysicsSimulationSystem::castSpheres(std::span<const SphereCastQuery> spheres, std::span<RayHit> hits) {
+        LPG_PROFILE_ZONE("PhysicsSimulationSystem::castSpheres");
+        if (hits.size() < spheres.size()) {
+            throw std::runtime_error("Fewer hits than queries passed to PhysicsSimulationSystem::castSpheres");
+        }
+        auto& data = *data_;
+        std::vector<RayQuery> rays(spheres.size());
+        std::transform(spheres.begin(), spheres.end(), rays.begin(), [](const SphereCastQuery& sphere) {
+            return sphere.ray;
+        });
+        detail::RunSpatialQueries(data.world.getScheduler().getThreadPool(), rays, [&](uint32_t i) {
+            hits[i] = detail::CastSphere(data, spheres[i].ray, spheres[i].radius);
+        });
+    }
+
+    int PhysicsSimulationSystem::addHeightGrid(std::shared_ptr<HeightGrid> grid, al::Vec3f origin, EntityDescriptor entity) {
+        auto& data = *data_;
+        data.waitForStep();
+        int upAxis = data.config.terrainUpAxis;
+        float cellSize = grid->getCellSize();
+
+        auto terrain = std::make_unique<detail::PhysicsTerrain>();
+        terrain->id = ++data.lastTerrainId;
+        terrain->origin = detail::ToBtVector3(origin);
+        // unit spacing and heights used as they are, scaled to the cell size along the grid
+        terrain->shape = std::make_unique<btHeightfieldTerrainShape>(grid->getWidth(), grid->getDepth(), grid->data(), 1.0f,
+                                                                     grid->getMinHeight(), grid->getMaxHeight(), upAxis, PHY_FLOAT, false);
+        terrain->shape->setLocalScaling(detail::GridToWorld(upAxis, cellSize, cellSize, 1.0f));
+
+        // Bullet centers the shape on its bounds
+        btVector3 center = detail::GridToWorld(upAxis, (grid->getWidth() - 1) * cellSize * 0.5f, (grid->getDepth() - 1) * cellSize * 0.5f,
+                                               (grid->getMinHeight() + grid->getMaxHeight()) * 0.5f);
+        btRigidBody::btRigidBodyConstructionInfo info(0.0f, nullptr, terrain->shape.get());
+        info.m_startWorldTransform.setIdentity();
+        info.m_startWorldTransform.setOrigin(terrain->origin + center);
+        terrain->body = std::make_unique<btRigidBody>(info);
+        terrain->body->setUserIndex(static_cast<int>(entity));
+        data.dynamicsWorld.addRigidBody(terrain->body.get());
+        detail::InsertQueryProxy(data, terrain->query, *terrain->body, info.m_startWorldTransform);
+
+        terrain->subscriptionId = grid->subscribe([&data, id = terrain->id](const HeightGridRegion& region) {
+            std::lock_guard lock(data.queueMutex);
+            data.terrainEdits.push_back({.terrainId = id, .region = region});
+        });
+        terrain->grid = std::move(grid);
+        data.terrains.push_back(std::move(terrain));
+        return data.lastTerrainId;
+    }
+
+    void PhysicsSimulationSystem::removeHeightGrid(int heightGridId) {
+        auto& data = *data_;
+        data.waitForStep();
+        std::erase_if(data.terrains, [&](const std::unique_ptr<detail::PhysicsTerrain>& terrain) {
+            if (terrain->id != heightGridId) {
+                return false;
+            }
+            terrain->grid->unsubscribe(terrain->subscriptionId);
+            detail::RemoveQueryProxy(data, terrain->query);
+            data.dynamicsWorld.removeRigidBody(terrain->body.get());
+            return true;
+        });
+    }
+
+    btDiscreteDynamicsWorld& PhysicsSimulationSystem::getDynamicsWorld() {
+        return data_->dynamicsWorld;
+    }
+
+    const PhysicsStepStats& PhysicsSimulationSystem::getLastStepStats() const {
+        return data_->stats;
+    }
+
+} // lpg
@@ -8,10 +8,152 @@
 #ifndef LPG_ENGINE_SRC_LPG_SYSTEMS_PHYSICSSIMULATIONSYSTEM_HPP_
 #define LPG_ENGINE_SRC_LPG_SYSTEMS_PHYSICSSIMULATIONSYSTEM_HPP_
 
+#include <memory>
+#include <span>
+
+#include <axxegro/com/math/math.hpp>
+
+#include "../core/SysCounter.hpp"
+#include "../core/entity.hpp"
+#include "../core/message.hpp"
+#include "../entities/RigidBody.hpp"
+#include "SpatialQuery.hpp"
+
+class btDiscreteDynamicsWorld;
+
 namespace lpg {
 
-    struct PhysicsSimulationSystem {
+    class HeightGrid;
+    class World;
+
+    namespace detail {
+        struct PhysicsData;
+    }
+
+    struct PhysicsConfig {
+        al::Vec3f gravity {0.0f, 0.0f, -9.81f};
+        double fixedTimeStep = GetSysFreqPeriod(SysFreq::Div0003_120Hz);
+        int maxSubSteps = 8;
+
+        /*
+         * Steps Bullet on a dedicated thread, overlapped with whatever runs until the system's next tick.
+         * Owners then lag one step behind the simulation. When false, msg() steps and publishes in place.
+         */
+        bool stepOnWorkerThread = true;
+
+        /*
+         * World axis the heights of HeightGrid terrains point along: 1 for Y, 2 for Z.
+         * Z by default, like HeightGrid's own normals and vertices; keep gravity opposite to it.
+         */
+        int terrainUpAxis = 2;
+    };
+
+    enum class PhysicsCommandType {
+        SetLinearVelocity,
+        SetAngularVelocity,
+        ApplyCentralImpulse
+    };
+
+    struct PhysicsStepStats {
+        int numBodies = 0;
+        int numPagesRescanned = 0; // RigidBody pages whose entities were spawned or despawned since the previous step
+        int numDirtyApplied = 0;
+        int numPagesSynced = 0; // pages and owners published by msg(), from the step it started last time when threaded
+        int numOwnersSynced = 0;
+        int numTerrainEditsApplied = 0;
+    };
+
+    /*
+     * Simulates every entity that has a Managed<RigidBody> component in a Bullet dynamics world:
+     *
+     * world.registerSystem("physics", PhysicsSimulationSystem(world), SysFreq::Div0003_120Hz);
+     *
+     * It declares no Queries since it writes to the owners of RigidBody, whatever their type, so it runs exclusively.
+     * Each step:
+     *  - RigidBody pages whose structureVersion changed are rescanned; bodies are created for new entities
+     *    and destroyed for despawned ones. Unchanged pages cost one comparison.
+     *  - Owners passed to markDirty have their body moved to their current transform.
+     *  - Bullet is stepped by FixedUpdateMessage::deltaTime.
+     *  - Position and rotation are written back to the owners of the bodies Bullet moved, page by page.
+     *    Bullet only reports active bodies through their motion states, so sleeping bodies are never visited.
+     *
+     * With PhysicsConfig::stepOnWorkerThread, msg() first waits for the step it started last time and publishes
+     * its results, then hands the next step to the worker and returns, so Bullet runs alongside game logic at the
+     * system's SysFreq. Every published body keeps the results of the last two steps; getInterpolatedTransform
+     * blends between them for rendering at rates other than the physics rate.
+     */
+    class PhysicsSimulationSystem {
+    public:
+
+        explicit PhysicsSimulationSystem(World& world, const PhysicsConfig& config = {});
+        ~PhysicsSimulationSystem();
+
+        PhysicsSimulationSystem(PhysicsSimulationSystem&&) noexcept;
+        PhysicsSimulationSystem& operator=(PhysicsSimulationSystem&&) noexcept;
+
+        void msg(FixedUpdateMessage* message);
+
+        /*
+         * The owner's position or rotation was changed outside the simulation. Its body is teleported there
+         * and woken up before the next step. Safe to call from any thread.
+         */
+        void markDirty(EntityDescriptor owner);
+
+        /*
+         * Queued and applied by the physics thread at the start of the next step, which wakes the body up.
+         * Safe to call from any thread. Owners without a body by then are ignored.
+         */
+        void setLinearVelocity(EntityDescriptor owner, al::Vec3f velocity);
+        void setAngularVelocity(EntityDescriptor owner, al::Vec3f velocity);
+        void applyCentralImpulse(EntityDescriptor owner, al::Vec3f impulse);
+
+        /*
+         * The owner's transform alpha of the way from the second-to-last published step to the last one,
+         * e.g. with alpha being the fraction of the physics period elapsed since the last msg().
+         * Returns false if the owner has no body. Must not be called concurrently with msg().
+         */
+        bool getInterpolatedTransform(EntityDescriptor owner, float alpha, al::Vec3f& position, al::Vec3f& rotation);
+
+        /*
+         * Blocks until the step in flight, if any, is finished. Bullet must not be touched through
+         * getDynamicsWorld() before that.
+         */
+        void waitForStep();
+
+        /*
+         * Closest Bullet object hit by each query in the state of the last published step, i.e. where msg() last
+         * moved the owners; hits[i] answers rays[i]. Queries do not wait for the step in flight, and run on the
+         * world's worker threads and the calling thread. Bullet does not report objects a query starts inside of.
+         * Bodies of RigidBody components are reported as their owner. Calls may overlap with each other, but not
+         * with msg(), addHeightGrid or removeHeightGrid.
+         */
+        void castRays(std::span<const RayQuery> rays, std::span<RayHit> hits);
+        void castSpheres(std::span<const SphereCastQuery> spheres, std::span<RayHit> hits);
+
+        /*
+         * Adds a static btHeightfieldTerrainShape that reads the grid's buffer in place, with sample (0, 0) at origin,
+         * triangulated like HeightGrid::buildTriangleIndices. Query hits on it report entity.
+         * From then on the system applies the grid's staged edits (HeightGrid::applyEdits) in msg(), after the step
+         * in flight has finished, and the next step wakes the bodies above the edited samples. Add a grid to one
+         * system only.
+         * Returns an id for removeHeightGrid. Must not be called concurrently with msg().
+         */
+        int addHeightGrid(std::shared_ptr<HeightGrid> grid, al::Vec3f origin, EntityDescriptor entity = RayHit::NullEntity);
+        void removeHeightGrid(int heightGridId);
+
+        [[nodiscard]] btDiscreteDynamicsWorld& getDynamicsWorld();
+        [[nodiscard]] const PhysicsStepStats& getLastStepStats() const;
+
+    private:
+
+        void syncStructure();
+        void applyDirty();
+        void applyTerrainEdits();
+        void publishStep();
+        void resolveCommands();
+        void queueCommand(PhysicsCommandType type, EntityDescriptor owner, al::Vec3f value);
 
+        std::unique_ptr<detail::PhysicsData> data_;
     };
 
 } // lpg
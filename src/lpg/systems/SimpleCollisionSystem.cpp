@@ -0,0 +1,684 @@
+//
+// Created by volt on 2026-10-19.
+//
+
+
+
+
+#include "SimpleCollisionSystem.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <iterator>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <tuple>
+
+#include "../core/EntityPage.hpp"
+#include "../core/Profiler.hpp"
+#include "../core/World.hpp"
+#include "../util/SimdKernels.hpp"
+
+namespace lpg {
+
+    namespace detail {
+
+        static float ComponentOf(al::Vec3f v, int axis) {
+            return axis == 0 ? v.x : (axis == 1 ? v.y : v.z);
+        }
+
+        static float BoxSphereDistanceSquared(const float* boxMin, const float* boxMax, al::Vec3f center) {
+            float result = 0.0f;
+            for (int axis = 0; axis < 3; axis++) {
+                float c = ComponentOf(center, axis);
+                float d = std::max({boxMin[axis] - c, 0.0f, c - boxMax[axis]});
+                result += d * d;
+            }
+            return result;
+        }
+
+        /*
+         * Insertion sort of order by key, giving up after maxMoves element moves.
+         * Returns false if it gave up, leaving order a permutation that still needs sorting.
+         */
+        static bool InsertionSortBounded(std::vector<uint32_t>& order, const std::vector<float>& key, size_t maxMoves) {
+            size_t numMoves = 0;
+            for (size_t i = 1; i < order.size(); i++) {
+                uint32_t value = order[i];
+                float valueKey = key[value];
+                size_t j = i;
+                while (j > 0 && key[order[j - 1]] > valueKey) {
+                    order[j] = order[j - 1];
+                    j--;
+                    if (++numMoves > maxMoves) {
+                        order[j] = value;
+                        return false;
+                    }
+                }
+                order[j] = value;
+            }
+            return true;
+        }
+
+        static int32_t FindVec3fProperty(const EntityInterface& entityInterface, std::string_view name) {
+            if (not entityInterface.propertyNamePerfectHash) {
+                return -1;
+            }
+            int32_t index = entityInterface.propertyNamePerfectHash(name);
+            if (index < 0 || index >= entityInterface.properties.size()) {
+                return -1;
+            }
+            return entityInterface.properties[index].typeKey == GetTypeKey<al::Vec3f>() ? index : -1;
+        }
+
+        /*
+         * Gathers the Vec3f property of every entity of the span into out, or, if propertyIndex is -1,
+         * whatever the batch accessor gives, e.g. the default for a type without the field.
+         */
+        static void GatherVec3fProperty(
+            const EntityInterface& entityInterface,
+            int32_t propertyIndex,
+            void (*EntityInterface::* contiguousFn)(void*, size_t, al::Vec3f*),
+            TypeErasedStridedSpan entities,
+            std::vector<al::Vec3f>& scratch,
+            simd::Vec3fArrays out
+        ) {
+            size_t count = entities.numElements();
+            if (propertyIndex >= 0) {
+#ifdef LPG_ENABLE_FIELD_ACCESS_PROFILER
+                profiler::RecordFieldAccess(entityInterface.entityTypeId, propertyIndex, count, 0);
+#endif
+                simd::GatherVec3f(entities, entityInterface.properties[propertyIndex].offset, out);
+                return;
+            }
+            scratch.resize(count);
+            (entityInterface.*contiguousFn)(entities.data(), count, scratch.data());
+            for (size_t i = 0; i < count; i++) {
+                out.x[i] = scratch[i].x;
+                out.y[i] = scratch[i].y;
+                out.z[i] = scratch[i].z;
+            }
+        }
+
+    } // namespace detail
+
+    SimpleCollisionSystem::SimpleCollisionSystem(World& world): world_(&world) {
+
+    }
+
+    void SimpleCollisionSystem::addEntityType(int entityTypeId, const SimpleColliderConfig& config) {
+        for (const auto& tracked: trackedTypes_) {
+            if (tracked.entityTypeId == entityTypeId) {
+                throw std::runtime_error("Entity type already added to SimpleCollisionSystem");
+            }
+        }
+        trackedTypes_.push_back({.entityTypeId = entityTypeId, .config = config});
+    }
+
+    void SimpleCollisionSystem::msg(FixedUpdateMessage*) {
+        LPG_PROFILE_ZONE("SimpleCollisionSystem::step");
+        stats_ = {};
+
+        bool structureChanged = gatherColliders();
+        updateSweepOrder(structureChanged);
+        findOverlaps();
+        reportEvents();
+        // here rather than on the first query, so that queries only read and may run in parallel
+        buildQueryTree();
+    }
+
+    bool SimpleCollisionSystem::gatherColliders() {
+        LPG_PROFILE_ZONE("SimpleCollisionSystem::gatherColliders");
+
+        descriptors_.clear();
+        trackedTypeIndex_.clear();
+        for (int axis = 0; axis < 3; axis++) {
+            center_[axis].clear();
+            min_[axis].clear();
+            max_[axis].clear();
+        }
+        radius_.clear();
+
+        std::vector<uint64_t> structureVersions;
+        structureVersions.reserve(structureVersions_.size());
+
+        for (size_t typeIndex = 0; typeIndex < trackedTypes_.size(); typeIndex++) {
+            auto& tracked = trackedTypes_[typeIndex];
+            const auto& entityInterface = world_->getEntityInterface(tracked.entityTypeId);
+            if (not tracked.resolved) {
+                tracked.positionProperty = detail::FindVec3fProperty(entityInterface, "position");
+                tracked.scaleProperty = detail::FindVec3fProperty(entityInterface, "scale");
+                tracked.resolved = true;
+            }
+            const auto& config = tracked.config;
+
+            for (int pageId: world_->getPagesOfType(tracked.entityTypeId)) {
+                auto& page = world_->getPage(pageId);
+                structureVersions.push_back(uint64_t(pageId) << 32 | page.structureVersion);
+                for (auto [beg, end]: page.getActiveRanges()) {
+                    size_t first = descriptors_.size();
+                    size_t count = end - beg;
+                    for (int axis = 0; axis < 3; axis++) {
+                        center_[axis].resize(first + count);
+                        min_[axis].resize(first + count);
+                        max_[axis].resize(first + count);
+                    }
+                    radius_.resize(first + count);
+                    for (int slot = beg; slot < end; slot++) {
+                        descriptors_.push_back(pageId * detail::EntityPageSize + slot);
+                        trackedTypeIndex_.push_back(static_cast<uint16_t>(typeIndex));
+                    }
+
+                    // the scales are gathered into max_, and turned into half extents in place
+                    TypeErasedStridedSpan entities {static_cast<std::byte*>(page.entityPtr(beg)), count, static_cast<size_t>(page.stride)};
+                    simd::Vec3fArrays centers {center_[0].data() + first, center_[1].data() + first, center_[2].data() + first};
+                    simd::Vec3fArrays mins {min_[0].data() + first, min_[1].data() + first, min_[2].data() + first};
+                    simd::Vec3fArrays extents {max_[0].data() + first, max_[1].data() + first, max_[2].data() + first};
+                    detail::GatherVec3fProperty(entityInterface, tracked.positionProperty, &EntityInterface::gatherPositionsContiguous, entities, gatherScratch_, centers);
+                    detail::GatherVec3fProperty(entityInterface, tracked.scaleProperty, &EntityInterface::gatherScalesContiguous, entities, gatherScratch_, extents);
+
+                    float* radius = radius_.data() + first;
+                    if (config.shape == SimpleColliderShape::Sphere) {
+                        for (size_t i = 0; i < count; i++) {
+                            radius[i] = config.halfExtents.x * std::max({std::abs(extents.x[i]), std::abs(extents.y[i]), std::abs(extents.z[i])});
+                            extents.x[i] = extents.y[i] = extents.z[i] = radius[i];
+                        }
+                    } else {
+                        for (size_t i = 0; i < count; i++) {
+                            extents.x[i] = config.halfExtents.x * std::abs(extents.x[i]);
+                            extents.y[i] = config.halfExtents.y * std::abs(extents.y[i]);
+                            extents.z[i] = config.halfExtents.z * std::abs(extents.z[i]);
+                        }
+                        std::fill_n(radius, count, 0.0f);
+                    }
+                    for (int axis = 0; axis < 3; axis++) {
+                        std::copy_n(center_[axis].data() + first, count, min_[axis].data() + first);
+                    }
+                    simd::AddScaled(mins, extents, -1.0f, count);
+                    simd::AddScaled(extents, centers, 1.0f, count);
+                }
+            }
+        }
+
+        stats_.numColliders = static_cast<int>(descriptors_.size());
+        bool structureChanged = structureVersions != structureVersions_;
+        structureVersions_.swap(structureVersions);
+        return structureChanged;
+    }
+
+    void SimpleCollisionSystem::updateSweepOrder(bool structureChanged) {
+        LPG_PROFILE_ZONE("SimpleCollisionSystem::updateSweepOrder");
+        size_t count = descriptors_.size();
+
+        // sweep along the axis with the largest spread of centers, so that as few pairs as possible overlap on it
+        double sum[3] {}, sumSquares[3] {};
+        for (size_t i = 0; i < count; i++) {
+            for (int axis = 0; axis < 3; axis++) {
+                double center = center_[axis][i];
+                sum[axis] += center;
+                sumSquares[axis] += center * center;
+            }
+        }
+        int bestAxis = 0;
+        double bestVariance = -1.0;
+        for (int axis = 0; axis < 3; axis++) {
+            double variance = count > 0 ? sumSquares[axis] / count - (sum[axis] / count) * (sum[axis] / count) : 0.0;
+            // hysteresis keeps the axis, and with it the order, stable when spreads are similar
+            if (axis == sweepAxis_) {
+                variance *= 1.25;
+            }
+            if (variance > bestVariance) {
+                bestVariance = variance;
+                bestAxis = axis;
+            }
+        }
+
+        const auto& key = min_[bestAxis];
+        bool fullSort = structureChanged || bestAxis != sweepAxis_ || sweepOrder_.size() != count;
+        if (not fullSort) {
+            // an insertion sort pays off as long as it moves fewer elements than a full sort compares
+            fullSort = not detail::InsertionSortBounded(sweepOrder_, key, count * std::bit_width(count));
+        }
+        if (fullSort) {
+            sweepOrder_.resize(count);
+            std::iota(sweepOrder_.begin(), sweepOrder_.end(), 0);
+            std::sort(sweepOrder_.begin(), sweepOrder_.end(), [&key](uint32_t a, uint32_t b) {
+                return key[a] < key[b];
+            });
+        }
+        sweepAxis_ = bestAxis;
+        stats_.fullSort = fullSort;
+    }
+
+    void SimpleCollisionSystem::findOverlaps() {
+        LPG_PROFILE_ZONE("SimpleCollisionSystem::findOverlaps");
+        previousOverlaps_.swap(overlaps_);
+        overlaps_.clear();
+
+        int axis1 = (sweepAxis_ + 1) % 3;
+        int axis2 = (sweepAxis_ + 2) % 3;
+
+        // bounds in sweep order, so that the inner loop reads memory sequentially
+        sweep_.resize(sweepOrder_.size());
+        for (size_t i = 0; i < sweepOrder_.size(); i++) {
+            uint32_t index = sweepOrder_[i];
+            sweep_[i] = {
+                .min = min_[sweepAxis_][index],
+                .max = max_[sweepAxis_][index],
+                .min1 = min_[axis1][index],
+                .max1 = max_[axis1][index],
+                .min2 = min_[axis2][index],
+                .max2 = max_[axis2][index],
+                .index = index
+            };
+        }
+
+        // One sweep pairs up every two colliders that overlap on the sweep axis, however far apart they are on the
+        // others. The entries are therefore split into bands along the wider of the other two axes (as min1/max1),
+        // each swept on its own; appending them in sweep order keeps every band sorted.
+        float min1 = std::numeric_limits<float>::infinity(), max1 = -min1, min2 = min1, max2 = -min1;
+        double sumExtents1 = 0.0, sumExtents2 = 0.0;
+        for (const auto& entry: sweep_) {
+            min1 = std::min(min1, entry.min1);
+            max1 = std::max(max1, entry.max1);
+            min2 = std::min(min2, entry.min2);
+            max2 = std::max(max2, entry.max2);
+            sumExtents1 += entry.max1 - entry.min1;
+            sumExtents2 += entry.max2 - entry.min2;
+        }
+        bool bandOnAxis2 = max2 - min2 > max1 - min1;
+        float bandOrigin = bandOnAxis2 ? min2 : min1;
+        double bandRange = bandOnAxis2 ? max2 - min2 : max1 - min1;
+        double averageExtent = (bandOnAxis2 ? sumExtents2 : sumExtents1) / std::max<size_t>(sweep_.size(), 1);
+
+        size_t numBands = 1;
+        if (bandRange > 0.0) {
+            double bandWidth = std::max(SweepBandExtents * averageExtent, bandRange / MaxSweepBands);
+            numBands = std::max<size_t>(1, std::min({static_cast<size_t>(bandRange / bandWidth), MaxSweepBands, sweep_.size() / MinSweepBandSize}));
+        }
+        float bandScale = bandRange > 0.0 ? static_cast<float>(numBands / bandRange) : 0.0f;
+        auto bandOf = [&](float coordinate) {
+            return std::min(static_cast<size_t>(std::max((coordinate - bandOrigin) * bandScale, 0.0f)), numBands - 1);
+        };
+
+        sweepBandOffsets_.assign(numBands + 1, 0);
+        for (const auto& entry: sweep_) {
+            float bandMin = bandOnAxis2 ? entry.min2 : entry.min1;
+            float bandMax = bandOnAxis2 ? entry.max2 : entry.max1;
+            for (size_t band = bandOf(bandMin); band <= bandOf(bandMax); band++) {
+                sweepBandOffsets_[band + 1]++;
+            }
+        }
+        std::partial_sum(sweepBandOffsets_.begin(), sweepBandOffsets_.end(), sweepBandOffsets_.begin());
+        sweepBands_.resize(sweepBandOffsets_.back());
+        sweepBandEnds_.assign(sweepBandOffsets_.begin(), sweepBandOffsets_.end() - 1);
+        for (auto entry: sweep_) {
+            if (bandOnAxis2) {
+                std::swap(entry.min1, entry.min2);
+                std::swap(entry.max1, entry.max2);
+            }
+            for (size_t band = bandOf(entry.min1); band <= bandOf(entry.max1); band++) {
+                sweepBands_[sweepBandEnds_[band]++] = entry;
+            }
+        }
+
+        size_t numCandidatePairs = 0;
+        for (size_t band = 0; band < numBands; band++) {
+            std::span<const SweepEntry> entries(sweepBands_.data() + sweepBandOffsets_[band], sweepBands_.data() + sweepBandOffsets_[band + 1]);
+            for (size_t i = 0; i < entries.size(); i++) {
+                const SweepEntry& entryA = entries[i];
+                uint32_t a = entryA.index;
+                const auto& configA = trackedTypes_[trackedTypeIndex_[a]].config;
+
+                size_t end = i + 1;
+                while (end < entries.size() && entries[end].min <= entryA.max) {
+                    end++;
+                }
+                numCandidatePairs += end - i - 1;
+
+                for (size_t j = i + 1; j < end; j++) {
+                    const SweepEntry& entryB = entries[j];
+                    // non-short-circuiting, most candidates are rejected here and the branches would be unpredictable
+                    bool separated = (entryB.min1 > entryA.max1) | (entryA.min1 > entryB.max1) | (entryB.min2 > entryA.max2) | (entryA.min2 > entryB.max2);
+                    if (separated) {
+                        continue;
+                    }
+                    // a pair in several bands is reported by the one in which its overlap begins
+                    if (bandOf(std::max(entryA.min1, entryB.min1)) != band) {
+                        continue;
+                    }
+                    uint32_t b = entryB.index;
+                    const auto& configB = trackedTypes_[trackedTypeIndex_[b]].config;
+                    if ((configA.layers & configB.collidesWith) == 0 && (configB.layers & configA.collidesWith) == 0) {
+                        continue;
+                    }
+
+                    bool sphereA = configA.shape == SimpleColliderShape::Sphere;
+                    bool sphereB = configB.shape == SimpleColliderShape::Sphere;
+                    if (sphereA && sphereB) {
+                        al::Vec3f d {center_[0][a] - center_[0][b], center_[1][a] - center_[1][b], center_[2][a] - center_[2][b]};
+                        float r = radius_[a] + radius_[b];
+                        if (d.x * d.x + d.y * d.y + d.z * d.z > r * r) {
+                            continue;
+                        }
+                    } else if (sphereA || sphereB) {
+                        uint32_t box = sphereA ? b : a;
+                        uint32_t sphere = sphereA ? a : b;
+                        float boxMin[3] {min_[0][box], min_[1][box], min_[2][box]};
+                        float boxMax[3] {max_[0][box], max_[1][box], max_[2][box]};
+                        al::Vec3f center {center_[0][sphere], center_[1][sphere], center_[2][sphere]};
+                        if (detail::BoxSphereDistanceSquared(boxMin, boxMax, center) > radius_[sphere] * radius_[sphere]) {
+                            continue;
+                        }
+                    }
+
+                    EntityDescriptor descriptorA = descriptors_[a];
+                    EntityDescriptor descriptorB = descriptors_[b];
+                    overlaps_.push_back({std::min(descriptorA, descriptorB), std::max(descriptorA, descriptorB)});
+                }
+            }
+        }
+
+        std::sort(overlaps_.begin(), overlaps_.end(), [](const OverlapPair& x, const OverlapPair& y) {
+            return std::tie(x.a, x.b) < std::tie(y.a, y.b);
+        });
+        stats_.numCandidatePairs = static_cast<int>(numCandidatePairs);
+        stats_.numOverlaps = static_cast<int>(overlaps_.size());
+    }
+
+    void SimpleCollisionSystem::buildQueryTree() {
+        LPG_PROFILE_ZONE("SimpleCollisionSystem::buildQueryTree");
+        queryEntries_ = sweep_;
+        size_t numSlabs = (queryEntries_.size() + QuerySlabSize - 1) / QuerySlabSize;
+        size_t numChunks = (queryEntries_.size() + QueryChunkSize - 1) / QueryChunkSize;
+        querySlabs_.resize(numSlabs);
+        querySlabMaxSoFar_.resize(numSlabs);
+        queryChunks_.resize(numChunks);
+
+        auto boundsOf = [this](size_t begin, size_t end) {
+            QueryBounds bounds {
+                .min = {std::numeric_limits<float>::max(), std::numeric_limits<float>::max(), std::numeric_limits<float>::max()},
+                .max = {std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest()}
+            };
+            for (size_t i = begin; i < std::min(end, queryEntries_.size()); i++) {
+                const SweepEntry& entry = queryEntries_[i];
+                bounds.min[0] = std::min(bounds.min[0], entry.min);
+                bounds.max[0] = std::max(bounds.max[0], entry.max);
+                bounds.min[1] = std::min(bounds.min[1], entry.min1);
+                bounds.max[1] = std::max(bounds.max[1], entry.max1);
+                bounds.min[2] = std::min(bounds.min[2], entry.min2);
+                bounds.max[2] = std::max(bounds.max[2], entry.max2);
+            }
+            return bounds;
+        };
+
+        float maxSoFar = std::numeric_limits<float>::lowest();
+        for (size_t slab = 0; slab < numSlabs; slab++) {
+            size_t begin = slab * QuerySlabSize;
+            size_t end = std::min(queryEntries_.size(), begin + QuerySlabSize);
+            // the slab's min on the sweep axis is that of its first entry, so slabs stay sorted by it
+            QueryBounds bounds = boundsOf(begin, end);
+            querySlabs_[slab] = bounds;
+            maxSoFar = std::max(maxSoFar, bounds.max[0]);
+            querySlabMaxSoFar_[slab] = maxSoFar;
+
+            bool byAxis1 = bounds.max[1] - bounds.min[1] >= bounds.max[2] - bounds.min[2];
+            std::sort(queryEntries_.begin() + begin, queryEntries_.begin() + end, [byAxis1](const SweepEntry& a, const SweepEntry& b) {
+                return byAxis1 ? a.min1 + a.max1 < b.min1 + b.max1 : a.min2 + a.max2 < b.min2 + b.max2;
+            });
+            for (size_t chunk = begin / QueryChunkSize; chunk * QueryChunkSize < end; chunk++) {
+                queryChunks_[chunk] = boundsOf(chunk * QueryChunkSize, (chunk + 1) * QueryChunkSize);
+            }
+        }
+    }
+
+    void SimpleCollisionSystem::reportEvents() {
+        auto less = [](const OverlapPair& x, const OverlapPair& y) {
+            return std::tie(x.a, x.b) < std::tie(y.a, y.b);
+        };
+        begun_.clear();
+        ended_.clear();
+        std::set_difference(overlaps_.begin(), overlaps_.end(), previousOverlaps_.begin(), previousOverlaps_.end(), std::back_inserter(begun_), less);
+        std::set_difference(previousOverlaps_.begin(), previousOverlaps_.end(), overlaps_.begin(), overlaps_.end(), std::back_inserter(ended_), less);
+
+        sendEvents();
+    }
+
+    void SimpleCollisionSystem::sendEvents() {
+        LPG_PROFILE_ZONE("SimpleCollisionSystem::sendEvents");
+        entityEvents_.clear();
+        for (const auto& pair: begun_) {
+            entityEvents_.push_back({.entity = pair.a, .ended = false, .pair = pair});
+            entityEvents_.push_back({.entity = pair.b, .ended = false, .pair = pair});
+        }
+        for (const auto& pair: ended_) {
+            entityEvents_.push_back({.entity = pair.a, .ended = true, .pair = pair});
+            entityEvents_.push_back({.entity = pair.b, .ended = true, .pair = pair});
+        }
+        // stable, so that the pairs of each entity stay sorted by (a, b)
+        std::stable_sort(entityEvents_.begin(), entityEvents_.end(), [](const EntityOverlapEvent& x, const EntityOverlapEvent& y) {
+            return std::tie(x.entity, x.ended) < std::tie(y.entity, y.ended);
+        });
+        entityEventPairs_.resize(entityEvents_.size());
+        for (size_t i = 0; i < entityEvents_.size(); i++) {
+            entityEventPairs_[i] = entityEvents_[i].pair;
+        }
+
+        size_t i = 0;
+        while (i < entityEvents_.size()) {
+            EntityDescriptor entity = entityEvents_[i].entity;
+            size_t endedBegin = i;
+            while (endedBegin < entityEvents_.size() && entityEvents_[endedBegin].entity == entity && not entityEvents_[endedBegin].ended) {
+                endedBegin++;
+            }
+            size_t end = endedBegin;
+            while (end < entityEvents_.size() && entityEvents_[end].entity == entity) {
+                end++;
+            }
+
+            std::span<const OverlapPair> pairs = entityEventPairs_;
+            OverlapEventsMessage message {
+                .begun = pairs.subspan(i, endedBegin - i),
+                .ended = pairs.subspan(endedBegin, end - endedBegin)
+            };
+            world_->sendMessage(entity, message);
+            i = end;
+        }
+    }
+
+    void SimpleCollisionSystem::castRays(std::span<const RayQuery> rays, std::span<RayHit> hits) {
+        LPG_PROFILE_ZONE("SimpleCollisionSystem::castRays");
+        if (hits.size() < rays.size()) {
+            throw std::runtime_error("Fewer hits than queries passed to SimpleCollisionSystem::castRays");
+        }
+        detail::RunSpatialQueries(world_->getScheduler().getThreadPool(), rays, [&](uint32_t i) {
+            hits[i] = castSphere(rays[i], 0.0f);
+        });
+    }
+
+    void SimpleCollisionSystem::castSpheres(std::span<const SphereCastQuery> spheres, std::span<RayHit> hits) {
+        LPG_PROFILE_ZONE("SimpleCollisionSystem::castSpheres");
+        if (hits.size() < spheres.size()) {
+            throw std::runtime_error("Fewer hits than queries passed to SimpleCollisionSystem::castSpheres");
+        }
+        std::vector<RayQuery> rays(spheres.size());
+        std::transform(spheres.begin(), spheres.end(), rays.begin(), [](const SphereCastQuery& sphere) {
+            return sphere.ray;
+        });
+        detail::RunSpatialQueries(world_->getScheduler().getThreadPool(), rays, [&](uint32_t i) {
+            hits[i] = castSphere(spheres[i].ray, spheres[i].radius);
+        });
+    }
+
+    RayHit SimpleCollisionSystem::castSphere(const RayQuery& ray, float radius) const {
+        float length = std::sqrt(ray.direction.x * ray.direction.x + ray.direction.y * ray.direction.y + ray.direction.z * ray.direction.z);
+        if (not (length > 0.0f) || queryEntries_.empty()) {
+            return {};
+        }
+
+        // everything below works in the axis order of SweepEntry: the sweep axis first
+        int axes[3] {sweepAxis_, (sweepAxis_ + 1) % 3, (sweepAxis_ + 2) % 3};
+        float origin[3], direction[3], inverse[3];
+        for (int k = 0; k < 3; k++) {
+            origin[k] = detail::ComponentOf(ray.origin, axes[k]);
+            direction[k] = detail::ComponentOf(ray.direction, axes[k]) / length;
+            inverse[k] = 1.0f / direction[k];
+        }
+
+        // slab test of the segment [enter, exit] against a box grown by radius
+        auto clipToBox = [&](const float* boxMin, const float* boxMax, float& enter, float& exit, int& enterAxis) {
+            for (int k = 0; k < 3; k++) {
+                float lo = boxMin[k] - radius;
+                float hi = boxMax[k] + radius;
+                if (direction[k] == 0.0f) {
+                    if (origin[k] < lo || origin[k] > hi) {
+                        return false;
+                    }
+                    continue;
+                }
+                float t0 = (lo - origin[k]) * inverse[k];
+                float t1 = (hi - origin[k]) * inverse[k];
+                if (t0 > t1) {
+                    std::swap(t0, t1);
+                }
+                if (t0 > enter) {
+                    enter = t0;
+                    enterAxis = k;
+                }
+                exit = std::min(exit, t1);
+                if (enter > exit) {
+                    return false;
+                }
+            }
+            return true;
+        };
+
+        float best = ray.maxDistance;
+        int bestEntry = -1;
+        int bestAxis = -1; // -1 when the query starts inside, or for spheres
+
+        // slabs overlapping the segment on the sweep axis
+        float end = origin[0] + direction[0] * ray.maxDistance;
+        float sweepLo = std::min(origin[0], end) - radius;
+        float sweepHi = std::max(origin[0], end) + radius;
+        size_t firstSlab = std::lower_bound(querySlabMaxSoFar_.begin(), querySlabMaxSoFar_.end(), sweepLo) - querySlabMaxSoFar_.begin();
+
+        for (size_t slab = firstSlab; slab < querySlabs_.size() && querySlabs_[slab].min[0] <= sweepHi; slab++) {
+            float enter = 0.0f, exit = best;
+            int enterAxis = -1;
+            if (not clipToBox(querySlabs_[slab].min, querySlabs_[slab].max, enter, exit, enterAxis)) {
+                continue;
+            }
+            size_t slabEnd = std::min(queryEntries_.size(), (slab + 1) * QuerySlabSize);
+
+            for (size_t chunk = slab * QuerySlabSize / QueryChunkSize; chunk * QueryChunkSize < slabEnd; chunk++) {
+                enter = 0.0f;
+                exit = best;
+                if (not clipToBox(queryChunks_[chunk].min, queryChunks_[chunk].max, enter, exit, enterAxis)) {
+                    continue;
+                }
+
+                for (size_t i = chunk * QueryChunkSize; i < std::min(slabEnd, (chunk + 1) * QueryChunkSize); i++) {
+                    const SweepEntry& entry = queryEntries_[i];
+                    const auto& config = trackedTypes_[trackedTypeIndex_[entry.index]].config;
+                    if ((config.layers & ray.collidesWith) == 0) {
+                        continue;
+                    }
+                    float boxMin[3] {entry.min, entry.min1, entry.min2};
+                    float boxMax[3] {entry.max, entry.max1, entry.max2};
+                    enter = 0.0f;
+                    exit = best;
+                    enterAxis = -1;
+                    if (not clipToBox(boxMin, boxMax, enter, exit, enterAxis)) {
+                        continue;
+                    }
+
+                    if (config.shape == SimpleColliderShape::Sphere) {
+                        float m[3];
+                        for (int k = 0; k < 3; k++) {
+                            m[k] = origin[k] - center_[axes[k]][entry.index];
+                        }
+                        float r = radius_[entry.index] + radius;
+                        float b = m[0] * direction[0] + m[1] * direction[1] + m[2] * direction[2];
+                        float c = m[0] * m[0] + m[1] * m[1] + m[2] * m[2] - r * r;
+                        if (c > 0.0f) {
+                            float discriminant = b * b - c;
+                            if (b > 0.0f || discriminant < 0.0f) {
+                                continue;
+                            }
+                            enter = -b - std::sqrt(discriminant);
+                        } else {
+                            enter = 0.0f;
+                        }
+                        if (enter > best) {
+                            continue;
+                        }
+                        enterAxis = -1;
+                    }
+                    if (bestEntry == -1 || enter < best) {
+                        best = enter;
+                        bestEntry = static_cast<int>(i);
+                        bestAxis = enterAxis;
+                    }
+                }
+            }
+        }
+
+        if (bestEntry == -1) {
+            return {};
+        }
+        const SweepEntry& entry = queryEntries_[bestEntry];
+        float center[3], normal[3] {}, point[3];
+        for (int k = 0; k < 3; k++) {
+            center[k] = origin[k] + direction[k] * best;
+        }
+        bool startsInside = best == 0.0f;
+        if (trackedTypes_[trackedTypeIndex_[entry.index]].config.shape == SimpleColliderShape::Sphere && not startsInside) {
+            float offset[3], offsetLength = 0.0f;
+            for (int k = 0; k < 3; k++) {
+                offset[k] = center[k] - center_[axes[k]][entry.index];
+                offsetLength += offset[k] * offset[k];
+            }
+            offsetLength = std::sqrt(offsetLength);
+            for (int k = 0; k < 3; k++) {
+                normal[k] = offsetLength > 0.0f ? offset[k] / offsetLength : -direction[k];
+                point[k] = center[k] - normal[k] * radius;
+            }
+        } else {
+            float boxMin[3] {entry.min, entry.min1, entry.min2};
+            float boxMax[3] {entry.max, entry.max1, entry.max2};
+            for (int k = 0; k < 3; k++) {
+                if (bestAxis == -1) {
+                    normal[k] = -direction[k];
+                } else if (k == bestAxis) {
+                    normal[k] = direction[k] > 0.0f ? -1.0f : 1.0f;
+                }
+                point[k] = std::clamp(center[k], boxMin[k], boxMax[k]);
+            }
+        }
+
+        RayHit hit {.hit = true, .entity = descriptors_[entry.index], .distance = best};
+        float* pointOut[3] {&hit.point.x, &hit.point.y, &hit.point.z};
+        float* normalOut[3] {&hit.normal.x, &hit.normal.y, &hit.normal.z};
+        for (int k = 0; k < 3; k++) {
+            *pointOut[axes[k]] = point[k];
+            *normalOut[axes[k]] = normal[k];
+        }
+        return hit;
+    }
+
+    std::span<const OverlapPair> SimpleCollisionSystem::getOverlaps() const {
+        return overlaps_;
+    }
+
+    OverlapEventsMessage SimpleCollisionSystem::getLastEvents() const {
+        return {.begun = begun_, .ended = ended_};
+    }
+
+    const SimpleCollisionStats& SimpleCollisionSystem::getLastStepStats() const {
+        return stats_;
+    }
+
+} // lpg
@@ -0,0 +1,206 @@
+//
+// Created by volt on 2026-10-19.
+//
+
+
+
+
+#ifndef LPG_ENGINE_SRC_LPG_SYSTEMS_SIMPLECOLLISIONSYSTEM_HPP_
+#define LPG_ENGINE_SRC_LPG_SYSTEMS_SIMPLECOLLISIONSYSTEM_HPP_
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include <axxegro/com/math/math.hpp>
+
+#include "../core/entity.hpp"
+#include "../core/message.hpp"
+#include "SpatialQuery.hpp"
+
+namespace lpg {
+
+    class World;
+
+    enum class SimpleColliderShape {
+        Box,
+        Sphere
+    };
+
+    /*
+     * Collider of every entity of one type. Boxes are axis-aligned with halfExtents multiplied by the entity's scale;
+     * spheres have radius halfExtents.x times the largest component of the scale.
+     * Two entities are tested only if either one's layers intersect the other's collidesWith.
+     */
+    struct SimpleColliderConfig {
+        SimpleColliderShape shape = SimpleColliderShape::Box;
+        al::Vec3f halfExtents {0.5f, 0.5f, 0.5f};
+        uint32_t layers = 1;
+        uint32_t collidesWith = ~uint32_t{0};
+    };
+
+    /*
+     * a < b, so a pair always has the same representation.
+     */
+    struct OverlapPair {
+        EntityDescriptor a;
+        EntityDescriptor b;
+
+        friend bool operator==(const OverlapPair&, const OverlapPair&) = default;
+    };
+
+    /*
+     * Overlaps that began and ended during one step, sorted by (a, b). The spans stay valid until the next step.
+     * Ended pairs may name entities that were despawned.
+     */
+    struct OverlapEventsMessage {
+        std::span<const OverlapPair> begun;
+        std::span<const OverlapPair> ended;
+    };
+
+    struct SimpleCollisionStats {
+        int numColliders = 0;
+        int numCandidatePairs = 0; // pairs overlapping on the sweep axis within a band
+        int numOverlaps = 0;
+        bool fullSort = false; // the sweep order was rebuilt instead of updated
+    };
+
+    /*
+     * Overlap detection for entities that do not need a full physics simulation, e.g. triggers, pickups and bullets.
+     * Positions and scales are gathered every step, one contiguous run of entities at a time, straight from Vec3f
+     * position and scale fields with the SIMD kernels of SimdKernels.hpp, or with the batch accessors of types
+     * without such fields; entities embedded as components of other entities are not included.
+     *
+     * The broadphase is sweep and prune along the axis on which the colliders are spread out the most.
+     * The sweep order of the previous step is kept and fixed with an insertion sort, which is close to linear
+     * for moving colliders; it is rebuilt when entities are spawned or despawned, or when the axis changes.
+     * The sorted colliders are then dealt into bands along the wider of the two other axes, which are swept
+     * separately, so that large crowds do not pair up everything that merely overlaps on the sweep axis.
+     * Candidate pairs go through an exact box/sphere test. Every entity that took part in an overlap that began
+     * or ended during the step is then sent one OverlapEventsMessage with its own pairs through World::sendMessage,
+     * i.e. to its LPG_MESSAGE_HANDLER(OverlapEventsMessage) and to its behaviours awaiting one. Despawned entities
+     * get nothing. The system declares no Queries, so it runs exclusively and handlers may write to any entity.
+     */
+    class SimpleCollisionSystem {
+    public:
+        explicit SimpleCollisionSystem(World& world);
+
+        template<typename TEntity>
+        void addEntityType(const SimpleColliderConfig& config = {}) {
+            addEntityType(detail::GetEntityTypeId<TEntity>(), config);
+        }
+
+        void addEntityType(int entityTypeId, const SimpleColliderConfig& config);
+
+        void msg(FixedUpdateMessage* message);
+
+        /*
+         * All overlaps found by the last step, sorted by (a, b).
+         */
+        [[nodiscard]] std::span<const OverlapPair> getOverlaps() const;
+
+        /*
+         * Every overlap that began or ended during the last step, for consumers other than the entities involved.
+         */
+        [[nodiscard]] OverlapEventsMessage getLastEvents() const;
+        [[nodiscard]] const SimpleCollisionStats& getLastStepStats() const;
+
+        /*
+         * Closest collider hit by each query, as of the last step; hits[i] answers rays[i].
+         * Each step packs the colliders for queries, which then only read them. Queries run on the world's worker
+         * threads and the calling thread. Calls may overlap with each other, but not with msg().
+         * A query starting inside a collider hits it at distance 0, with the normal facing back along the query.
+         * A swept sphere is tested against boxes grown by its radius, so it hits their edges and corners slightly early.
+         */
+        void castRays(std::span<const RayQuery> rays, std::span<RayHit> hits);
+        void castSpheres(std::span<const SphereCastQuery> spheres, std::span<RayHit> hits);
+
+    private:
+
+        struct TrackedType {
+            int entityTypeId;
+            SimpleColliderConfig config;
+            // property indices of the Vec3f position and scale fields, -1 if the type has none
+            bool resolved = false;
+            int32_t positionProperty = -1;
+            int32_t scaleProperty = -1;
+        };
+
+        struct EntityOverlapEvent {
+            EntityDescriptor entity;
+            bool ended;
+            OverlapPair pair;
+        };
+
+        /*
+         * Bounds on the sweep axis and on the two others.
+         */
+        struct SweepEntry {
+            float min, max;
+            float min1, max1;
+            float min2, max2;
+            uint32_t index;
+        };
+
+        /*
+         * Bounds of consecutive entries of queryEntries_, in the axis order of SweepEntry.
+         */
+        struct QueryBounds {
+            float min[3];
+            float max[3];
+        };
+
+        // bands at least this many average collider extents wide, with at least MinSweepBandSize colliders on average
+        static constexpr double SweepBandExtents = 2.0;
+        static constexpr size_t MaxSweepBands = 64;
+        static constexpr size_t MinSweepBandSize = 64;
+
+        // sort-tile packing: slabs of sweep order, each sorted on the wider of the other two axes and cut into chunks
+        static constexpr size_t QuerySlabSize = 256;
+        static constexpr size_t QueryChunkSize = 16;
+
+        bool gatherColliders();
+        void updateSweepOrder(bool structureChanged);
+        void findOverlaps();
+        void buildQueryTree();
+        void reportEvents();
+        void sendEvents();
+        [[nodiscard]] RayHit castSphere(const RayQuery& ray, float radius) const;
+
+        World* world_;
+        std::vector<TrackedType> trackedTypes_;
+
+        // one element per collider, in page order
+        std::vector<EntityDescriptor> descriptors_;
+        std::vector<uint16_t> trackedTypeIndex_;
+        std::vector<float> center_[3];
+        std::vector<float> min_[3];
+        std::vector<float> max_[3];
+        std::vector<float> radius_; // 0 for boxes
+        std::vector<al::Vec3f> gatherScratch_; // for types gathered with their batch accessors
+
+        std::vector<uint64_t> structureVersions_; // of every gathered page, to detect spawns and despawns
+        std::vector<uint32_t> sweepOrder_;
+        std::vector<SweepEntry> sweep_;
+        std::vector<SweepEntry> sweepBands_; // band after band, with the band axis as min1/max1
+        std::vector<size_t> sweepBandOffsets_;
+        std::vector<size_t> sweepBandEnds_;
+        int sweepAxis_ = 0;
+        std::vector<SweepEntry> queryEntries_;
+        std::vector<QueryBounds> querySlabs_;
+        std::vector<QueryBounds> queryChunks_;
+        std::vector<float> querySlabMaxSoFar_; // running maximum of the slabs' max on the sweep axis
+
+        std::vector<OverlapPair> overlaps_;
+        std::vector<OverlapPair> previousOverlaps_;
+        std::vector<OverlapPair> begun_;
+        std::vector<OverlapPair> ended_;
+        std::vector<EntityOverlapEvent> entityEvents_; // both entities of every event, sorted by entity
+        std::vector<OverlapPair> entityEventPairs_; // the pairs of entityEvents_, which the messages point into
+
+        SimpleCollisionStats stats_;
+    };
+
+} // lpg
+
+#endif //LPG_ENGINE_SRC_LPG_SYSTEMS_SIMPLECOLLISIONSYSTEM_HPP_
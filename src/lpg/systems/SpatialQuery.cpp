@@ -0,0 +1,90 @@
+//
+// Created by volt on 2026-10-19.
+//
+
+
+
+
+#include "SpatialQuery.hpp"
+
+#include <algorithm>
+#include <numeric>
+
+#include "../core/Profiler.hpp"
+#include "../util/ThreadPool.hpp"
+
+namespace lpg::detail {
+
+    /*
+     * Spreads the low 21 bits of value so that two zero bits follow each of them.
+     */
+    static uint64_t SpreadBits3(uint64_t value) {
+        value &= 0x1FFFFF;
+        value = (value | value << 32) & 0x1F00000000FFFF;
+        value = (value | value << 16) & 0x1F0000FF0000FF;
+        value = (value | value << 8) & 0x100F00F00F00F00F;
+        value = (value | value << 4) & 0x10C30C30C30C30C3;
+        value = (value | value << 2) & 0x1249249249249249;
+        return value;
+    }
+
+    std::vector<uint32_t> CoherentQueryOrder(std::span<const RayQuery> rays) {
+        float lo[3] {std::numeric_limits<float>::max(), std::numeric_limits<float>::max(), std::numeric_limits<float>::max()};
+        float hi[3] {std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest()};
+        for (const auto& ray: rays) {
+            float origin[3] {ray.origin.x, ray.origin.y, ray.origin.z};
+            for (int axis = 0; axis < 3; axis++) {
+                lo[axis] = std::min(lo[axis], origin[axis]);
+                hi[axis] = std::max(hi[axis], origin[axis]);
+            }
+        }
+
+        // 3 bits of octant above 3 * 20 bits of Morton code
+        constexpr float CellsPerAxis = float(1 << 20) - 1.0f;
+        std::vector<uint64_t> keys(rays.size());
+        for (size_t i = 0; i < rays.size(); i++) {
+            const auto& ray = rays[i];
+            float origin[3] {ray.origin.x, ray.origin.y, ray.origin.z};
+            uint64_t key = uint64_t(ray.direction.x < 0.0f) << 62 | uint64_t(ray.direction.y < 0.0f) << 61 | uint64_t(ray.direction.z < 0.0f) << 60;
+            for (int axis = 0; axis < 3; axis++) {
+                float extent = hi[axis] - lo[axis];
+                float cell = extent > 0.0f ? (origin[axis] - lo[axis]) / extent * CellsPerAxis : 0.0f;
+                // NaN origins end up in cell 0
+                uint64_t quantized = cell > 0.0f ? static_cast<uint64_t>(std::min(cell, CellsPerAxis)) : 0;
+                key |= SpreadBits3(quantized) << (2 - axis);
+            }
+            keys[i] = key;
+        }
+
+        std::vector<uint32_t> order(rays.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::sort(order.begin(), order.end(), [&keys](uint32_t a, uint32_t b) {
+            return keys[a] < keys[b];
+        });
+        return order;
+    }
+
+    void RunSpatialQueries(ThreadPool* threadPool, std::span<const RayQuery> rays, const std::function<void(uint32_t)>& fn) {
+        LPG_PROFILE_ZONE("RunSpatialQueries");
+        if (rays.size() <= SpatialQueryBatchSize) {
+            // too few to be worth sorting and distributing
+            for (uint32_t i = 0; i < rays.size(); i++) {
+                fn(i);
+            }
+            return;
+        }
+        std::vector<uint32_t> order = CoherentQueryOrder(rays);
+        if (not threadPool) {
+            for (uint32_t i: order) {
+                fn(i);
+            }
+            return;
+        }
+        threadPool->parallelFor(order.size(), SpatialQueryBatchSize, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                fn(order[i]);
+            }
+        });
+    }
+
+} // lpg::detail
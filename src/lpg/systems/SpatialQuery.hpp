@@ -0,0 +1,78 @@
+//
+// Created by volt on 2026-10-19.
+//
+
+
+
+
+#ifndef LPG_ENGINE_SRC_LPG_SYSTEMS_SPATIALQUERY_HPP_
+#define LPG_ENGINE_SRC_LPG_SYSTEMS_SPATIALQUERY_HPP_
+
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <span>
+#include <vector>
+
+#include <axxegro/com/math/math.hpp>
+
+#include "../core/entity.hpp"
+
+namespace lpg {
+
+    class ThreadPool;
+
+    /*
+     * direction does not need to be normalized; distances are in world units along it.
+     * collidesWith is matched against the layers of the colliders, or the collision filter group of Bullet objects.
+     */
+    struct RayQuery {
+        al::Vec3f origin;
+        al::Vec3f direction;
+        float maxDistance = std::numeric_limits<float>::max();
+        uint32_t collidesWith = ~uint32_t{0};
+    };
+
+    /*
+     * A sphere of the given radius swept along the ray.
+     */
+    struct SphereCastQuery {
+        RayQuery ray;
+        float radius = 0.0f;
+    };
+
+    /*
+     * The closest hit along the ray. For sphere casts, point is where the sphere touches the collider,
+     * and distance how far its center traveled.
+     */
+    struct RayHit {
+        bool hit = false;
+        EntityDescriptor entity = NullEntity; // NullEntity for Bullet objects that do not belong to an entity
+        float distance = 0.0f;
+        al::Vec3f point;
+        al::Vec3f normal;
+
+        static constexpr EntityDescriptor NullEntity = ~EntityDescriptor{0};
+    };
+
+    namespace detail {
+
+        inline constexpr size_t SpatialQueryBatchSize = 64;
+
+        /*
+         * Indices of the queries sorted by direction octant, then along a Morton curve through their origins,
+         * so that consecutive queries, and the batches handed to one thread, visit the same part of the scene.
+         */
+        std::vector<uint32_t> CoherentQueryOrder(std::span<const RayQuery> rays);
+
+        /*
+         * Calls fn(queryIndex) for every query in coherent order, in batches of SpatialQueryBatchSize
+         * spread over threadPool and the calling thread; on the calling thread only if threadPool is nullptr.
+         */
+        void RunSpatialQueries(ThreadPool* threadPool, std::span<const RayQuery> rays, const std::function<void(uint32_t)>& fn);
+
+    } // namespace detail
+
+} // lpg
+
+#endif //LPG_ENGINE_SRC_LPG_SYSTEMS_SPATIALQUERY_HPP_
@@ -0,0 +1,151 @@
+//
+// Created by volt on 2026-10-19.
+//
+
+
+
+
+#include "HeightGrid.hpp"
+
+#include <cmath>
+#include <stdexcept>
+
+namespace lpg {
+
+    HeightGrid::HeightGrid(int width, int depth, float cellSize, float minHeight, float maxHeight):
+        width_(width), depth_(depth), cellSize_(cellSize), minHeight_(minHeight), maxHeight_(maxHeight) {
+        if (width < 2 || depth < 2) {
+            throw std::runtime_error("HeightGrid needs at least 2x2 samples");
+        }
+        if (not (cellSize > 0.0f) || not (minHeight <= maxHeight)) {
+            throw std::runtime_error("Invalid HeightGrid cell size or height range");
+        }
+        heights_.assign(size_t(width) * depth, std::clamp(0.0f, minHeight, maxHeight));
+    }
+
+    int HeightGrid::getWidth() const {
+        return width_;
+    }
+
+    int HeightGrid::getDepth() const {
+        return depth_;
+    }
+
+    float HeightGrid::getCellSize() const {
+        return cellSize_;
+    }
+
+    float HeightGrid::getMinHeight() const {
+        return minHeight_;
+    }
+
+    float HeightGrid::getMaxHeight() const {
+        return maxHeight_;
+    }
+
+    HeightGridRegion HeightGrid::getBounds() const {
+        return {0, 0, width_, depth_};
+    }
+
+    const float* HeightGrid::data() const {
+        return heights_.data();
+    }
+
+    al::Vec3f HeightGrid::getNormal(int x, int y) const {
+        // central differences, one-sided at the borders
+        int left = std::max(x - 1, 0), right = std::min(x + 1, width_ - 1);
+        int down = std::max(y - 1, 0), up = std::min(y + 1, depth_ - 1);
+        float dx = (getHeight(right, y) - getHeight(left, y)) / ((right - left) * cellSize_);
+        float dy = (getHeight(x, up) - getHeight(x, down)) / ((up - down) * cellSize_);
+        float length = std::sqrt(dx * dx + dy * dy + 1.0f);
+        return {-dx / length, -dy / length, 1.0f / length};
+    }
+
+    void HeightGrid::setHeight(int x, int y, float height) {
+        edit({x, y, x + 1, y + 1}, [height](int, int, float& value) {
+            value = height;
+        });
+    }
+
+    int HeightGrid::applyEdits() {
+        {
+            std::lock_guard lock(stagedMutex_);
+            for (const auto& [region, heights]: stagedEdits_) {
+                int regionWidth = region.x1 - region.x0;
+                for (int y = region.y0; y < region.y1; y++) {
+                    auto source = heights.begin() + size_t(y - region.y0) * regionWidth;
+                    std::copy(source, source + regionWidth, heights_.begin() + size_t(y) * width_ + region.x0);
+                }
+                appliedRegions_.push_back(region);
+            }
+            stagedEdits_.clear();
+        }
+
+        // outside the lock, so that subscribers may stage further edits
+        for (const auto& region: appliedRegions_) {
+            notify(region);
+        }
+        int numApplied = static_cast<int>(appliedRegions_.size());
+        appliedRegions_.clear();
+        return numApplied;
+    }
+
+    std::vector<int> HeightGrid::buildTriangleIndices() const {
+        std::vector<int> indices;
+        indices.reserve(size_t(width_ - 1) * (depth_ - 1) * 6);
+        for (int y = 0; y < depth_ - 1; y++) {
+            for (int x = 0; x < width_ - 1; x++) {
+                int base = y * width_ + x;
+                for (int offset: {0, 1, width_, 1, width_ + 1, width_}) {
+                    indices.push_back(base + offset);
+                }
+            }
+        }
+        return indices;
+    }
+
+    int HeightGrid::subscribe(Callback callback) {
+        subscriptions_.push_back({.id = ++lastSubscriptionId_, .callback = std::move(callback)});
+        return lastSubscriptionId_;
+    }
+
+    void HeightGrid::unsubscribe(int subscriptionId) {
+        std::erase_if(subscriptions_, [subscriptionId](const Subscription& subscription) {
+            return subscription.id == subscriptionId;
+        });
+    }
+
+    HeightGridRegion HeightGrid::clip(const HeightGridRegion& region) const {
+        return {std::max(region.x0, 0), std::max(region.y0, 0), std::min(region.x1, width_), std::min(region.y1, depth_)};
+    }
+
+    std::vector<float>& HeightGrid::stageEdit(const HeightGridRegion& region) {
+        // starts from the buffer with the earlier staged edits over it, in the order they were made
+        int regionWidth = region.x1 - region.x0;
+        std::vector<float> heights(size_t(regionWidth) * (region.y1 - region.y0));
+        for (int y = region.y0; y < region.y1; y++) {
+            auto source = heights_.begin() + size_t(y) * width_ + region.x0;
+            std::copy(source, source + regionWidth, heights.begin() + size_t(y - region.y0) * regionWidth);
+        }
+        for (const auto& earlier: stagedEdits_) {
+            HeightGridRegion overlap {std::max(region.x0, earlier.region.x0), std::max(region.y0, earlier.region.y0),
+                                      std::min(region.x1, earlier.region.x1), std::min(region.y1, earlier.region.y1)};
+            if (overlap.empty()) {
+                continue;
+            }
+            int earlierWidth = earlier.region.x1 - earlier.region.x0;
+            for (int y = overlap.y0; y < overlap.y1; y++) {
+                auto source = earlier.heights.begin() + size_t(y - earlier.region.y0) * earlierWidth + (overlap.x0 - earlier.region.x0);
+                std::copy(source, source + (overlap.x1 - overlap.x0), heights.begin() + size_t(y - region.y0) * regionWidth + (overlap.x0 - region.x0));
+            }
+        }
+        return stagedEdits_.emplace_back(StagedEdit {.region = region, .heights = std::move(heights)}).heights;
+    }
+
+    void HeightGrid::notify(const HeightGridRegion& region) {
+        for (const auto& subscription: subscriptions_) {
+            subscription.callback(region);
+        }
+    }
+
+} // lpg
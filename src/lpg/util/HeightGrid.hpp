@@ -0,0 +1,178 @@
+//
+// Created by volt on 2026-10-19.
+//
+
+
+
+
+#ifndef LPG_ENGINE_SRC_LPG_UTIL_HEIGHTGRID_HPP_
+#define LPG_ENGINE_SRC_LPG_UTIL_HEIGHTGRID_HPP_
+
+#include <algorithm>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+#include <axxegro/com/math/math.hpp>
+
+namespace lpg {
+
+    /*
+     * Samples [x0, x1) x [y0, y1) of a HeightGrid.
+     */
+    struct HeightGridRegion {
+        int x0 = 0, y0 = 0;
+        int x1 = 0, y1 = 0;
+
+        [[nodiscard]] bool empty() const {
+            return x0 >= x1 || y0 >= y1;
+        }
+
+        [[nodiscard]] HeightGridRegion merged(const HeightGridRegion& other) const {
+            if (empty()) {
+                return other;
+            }
+            if (other.empty()) {
+                return *this;
+            }
+            return {std::min(x0, other.x0), std::min(y0, other.y0), std::max(x1, other.x1), std::max(y1, other.y1)};
+        }
+
+        /*
+         * Grown by numSamples on every side and clipped to a width x depth grid, e.g. to cover the vertices whose
+         * normals changed along with the heights.
+         */
+        [[nodiscard]] HeightGridRegion grown(int numSamples, int width, int depth) const {
+            return {std::max(x0 - numSamples, 0), std::max(y0 - numSamples, 0), std::min(x1 + numSamples, width), std::min(y1 + numSamples, depth)};
+        }
+    };
+
+    /*
+     * width x depth height samples cellSize apart, stored row by row in one float buffer that is allocated once.
+     * The buffer is what consumers read, with no copy: PhysicsSimulationSystem::addHeightGrid hands it to a
+     * btHeightfieldTerrainShape, and render meshes are built from it with forEachVertex.
+     * Heights stay within [minHeight, maxHeight], which fixes the bounds of the collision shape.
+     *
+     * Consumers read the buffer without locking, possibly on other threads, so edits do not write it directly:
+     * each one stages the heights of its region, and applyEdits() copies them over, then notifies the subscribers
+     * with the samples that changed, so consumers update only those. A grid added to a PhysicsSimulationSystem
+     * has its edits applied by the system, between two steps; otherwise call applyEdits() while no consumer runs.
+     */
+    class HeightGrid {
+    public:
+        using Callback = std::function<void(const HeightGridRegion&)>;
+
+        HeightGrid(int width, int depth, float cellSize, float minHeight, float maxHeight);
+
+        HeightGrid(const HeightGrid&) = delete;
+        HeightGrid& operator=(const HeightGrid&) = delete;
+
+        [[nodiscard]] int getWidth() const;
+        [[nodiscard]] int getDepth() const;
+        [[nodiscard]] float getCellSize() const;
+        [[nodiscard]] float getMinHeight() const;
+        [[nodiscard]] float getMaxHeight() const;
+        [[nodiscard]] HeightGridRegion getBounds() const;
+
+        [[nodiscard]] float getHeight(int x, int y) const {
+            return heights_[y * width_ + x];
+        }
+
+        /*
+         * Row y starts at data() + y * getWidth(). The pointer is valid for the lifetime of the grid.
+         */
+        [[nodiscard]] const float* data() const;
+
+        /*
+         * Unit normal in grid space, with x and y along the grid and z up.
+         */
+        [[nodiscard]] al::Vec3f getNormal(int x, int y) const;
+
+        /*
+         * Calls fn(x, y, float& height) for every sample of region and clamps the results. Later edits see the
+         * staged heights of earlier ones; getHeight and the buffer only change at applyEdits(). Safe to call from any thread.
+         */
+        template<typename Fn>
+        void edit(HeightGridRegion region, Fn&& fn) {
+            region = clip(region);
+            if (region.empty()) {
+                return;
+            }
+            std::lock_guard lock(stagedMutex_);
+            float* height = stageEdit(region).data();
+            for (int y = region.y0; y < region.y1; y++) {
+                for (int x = region.x0; x < region.x1; x++, height++) {
+                    fn(x, y, *height);
+                    *height = std::clamp(*height, minHeight_, maxHeight_);
+                }
+            }
+        }
+
+        void setHeight(int x, int y, float height);
+
+        /*
+         * Copies the staged edits into the buffer and notifies the subscribers, once per edit.
+         * Returns the number of edits applied. No consumer of the buffer may be running.
+         */
+        int applyEdits();
+
+        /*
+         * Calls fn(x, y, al::Vec3f position, al::Vec3f normal) for every sample of region, with the position
+         * (x * cellSize, y * cellSize, height) in grid space. Vertex (x, y) of a mesh built this way
+         * has index y * getWidth() + x, matching buildTriangleIndices.
+         */
+        template<typename Fn>
+        void forEachVertex(HeightGridRegion region, Fn&& fn) const {
+            region = clip(region);
+            for (int y = region.y0; y < region.y1; y++) {
+                for (int x = region.x0; x < region.x1; x++) {
+                    al::Vec3f position {x * cellSize_, y * cellSize_, heights_[y * width_ + x]};
+                    fn(x, y, position, getNormal(x, y));
+                }
+            }
+        }
+
+        /*
+         * Two triangles per cell, for a mesh with one vertex per sample.
+         */
+        [[nodiscard]] std::vector<int> buildTriangleIndices() const;
+
+        /*
+         * Callbacks run on the thread that calls applyEdits(), after the buffer is updated.
+         */
+        int subscribe(Callback callback);
+        void unsubscribe(int subscriptionId);
+
+    private:
+        struct Subscription {
+            int id;
+            Callback callback;
+        };
+
+        struct StagedEdit {
+            HeightGridRegion region;
+            std::vector<float> heights; // row by row, region.x1 - region.x0 per row
+        };
+
+        [[nodiscard]] HeightGridRegion clip(const HeightGridRegion& region) const;
+        std::vector<float>& stageEdit(const HeightGridRegion& region);
+        void notify(const HeightGridRegion& region);
+
+        int width_;
+        int depth_;
+        float cellSize_;
+        float minHeight_;
+        float maxHeight_;
+        std::vector<float> heights_;
+
+        std::mutex stagedMutex_;
+        std::vector<StagedEdit> stagedEdits_;
+        std::vector<HeightGridRegion> appliedRegions_; // scratch for applyEdits
+
+        std::vector<Subscription> subscriptions_;
+        int lastSubscriptionId_ = 0;
+    };
+
+} // lpg
+
+#endif //LPG_ENGINE_SRC_LPG_UTIL_HEIGHTGRID_HPP_
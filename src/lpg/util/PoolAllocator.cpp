@@ -0,0 +1,51 @@
+//
+// Created by volt on 2026-10-19.
+//
+
+
+
+
+#include "PoolAllocator.hpp"
+
+#include <algorithm>
+#include <new>
+
+namespace lpg {
+
+    void* PoolAllocator::allocate(size_t size) {
+        if (size == 0 || size > MaxPooledSize) {
+            return ::operator new(size);
+        }
+        size_t sizeClass = SizeClassOf(size);
+        if (not freeLists_[sizeClass]) {
+            refill(sizeClass);
+        }
+        FreeBlock* block = freeLists_[sizeClass];
+        freeLists_[sizeClass] = block->next;
+        return block;
+    }
+
+    void PoolAllocator::deallocate(void* ptr, size_t size) {
+        if (size == 0 || size > MaxPooledSize) {
+            ::operator delete(ptr);
+            return;
+        }
+        size_t sizeClass = SizeClassOf(size);
+        auto* block = static_cast<FreeBlock*>(ptr);
+        block->next = freeLists_[sizeClass];
+        freeLists_[sizeClass] = block;
+    }
+
+    void PoolAllocator::refill(size_t sizeClass) {
+        size_t blockSize = (sizeClass + 1) * SizeClassGranularity;
+        size_t numBlocks = std::max<size_t>(1, ChunkSize / blockSize);
+
+        auto& chunk = chunks_.emplace_back(std::make_unique_for_overwrite<std::byte[]>(numBlocks * blockSize));
+        for (size_t i = 0; i < numBlocks; i++) {
+            auto* block = reinterpret_cast<FreeBlock*>(chunk.get() + i * blockSize);
+            block->next = freeLists_[sizeClass];
+            freeLists_[sizeClass] = block;
+        }
+    }
+
+} // lpg
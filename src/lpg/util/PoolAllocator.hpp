@@ -0,0 +1,54 @@
+//
+// Created by volt on 2026-10-19.
+//
+
+
+
+
+#ifndef LPG_ENGINE_SRC_LPG_UTIL_POOLALLOCATOR_HPP_
+#define LPG_ENGINE_SRC_LPG_UTIL_POOLALLOCATOR_HPP_
+
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace lpg {
+
+    /*
+     * Size-class free lists carved out of large chunks. Blocks are never returned to the system
+     * until the allocator is destroyed. Requests above MaxPooledSize go straight to operator new.
+     * Not thread-safe.
+     */
+    class PoolAllocator {
+    public:
+        static constexpr size_t SizeClassGranularity = 64;
+        static constexpr size_t NumSizeClasses = 32;
+        static constexpr size_t MaxPooledSize = SizeClassGranularity * NumSizeClasses;
+        static constexpr size_t ChunkSize = 64 * 1024;
+
+        PoolAllocator() = default;
+        PoolAllocator(const PoolAllocator&) = delete;
+        PoolAllocator& operator=(const PoolAllocator&) = delete;
+
+        void* allocate(size_t size);
+        void deallocate(void* ptr, size_t size);
+
+    private:
+        struct FreeBlock {
+            FreeBlock* next;
+        };
+
+        static size_t SizeClassOf(size_t size) {
+            return (size + SizeClassGranularity - 1) / SizeClassGranularity - 1;
+        }
+
+        void refill(size_t sizeClass);
+
+        std::array<FreeBlock*, NumSizeClasses> freeLists_ {};
+        std::vector<std::unique_ptr<std::byte[]>> chunks_;
+    };
+
+} // lpg
+
+#endif //LPG_ENGINE_SRC_LPG_UTIL_POOLALLOCATOR_HPP_
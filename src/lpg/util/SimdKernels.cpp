@@ -0,0 +1,369 @@
+//
+// Created by volt on 2026-10-19.
+//
+
+
+
+
+#include "SimdKernels.hpp"
+
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <stdexcept>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define LPG_SIMD_X86
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+#endif
+
+// MSVC accepts intrinsics of any instruction set without flags; GCC and Clang need them enabled per function
+#if defined(__GNUC__) || defined(__clang__)
+#define LPG_TARGET_SSE2 __attribute__((target("sse2")))
+#define LPG_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define LPG_TARGET_SSE2
+#define LPG_TARGET_AVX2
+#endif
+
+namespace lpg::simd {
+
+    namespace detail {
+
+        struct KernelTable {
+            void (*gatherFloat)(TypeErasedStridedSpan, size_t, float*);
+            void (*scatterFloat)(const float*, TypeErasedStridedSpan, size_t);
+            void (*gatherVec3f)(TypeErasedStridedSpan, size_t, Vec3fArrays);
+            void (*scatterVec3f)(Vec3fArrays, TypeErasedStridedSpan, size_t);
+            void (*addScaled)(float*, const float*, float, size_t);
+        };
+
+        static void GatherFloatScalar(TypeErasedStridedSpan span, size_t fieldOffset, float* out) {
+            const std::byte* field = span.data() + fieldOffset;
+            for (size_t i = 0; i < span.numElements(); i++) {
+                std::memcpy(&out[i], field + i * span.stride(), sizeof(float));
+            }
+        }
+
+        static void ScatterFloatScalar(const float* in, TypeErasedStridedSpan span, size_t fieldOffset) {
+            std::byte* field = span.data() + fieldOffset;
+            for (size_t i = 0; i < span.numElements(); i++) {
+                std::memcpy(field + i * span.stride(), &in[i], sizeof(float));
+            }
+        }
+
+        static void GatherVec3fScalar(TypeErasedStridedSpan span, size_t fieldOffset, Vec3fArrays out, size_t first = 0) {
+            const std::byte* field = span.data() + fieldOffset;
+            for (size_t i = first; i < span.numElements(); i++) {
+                float xyz[3];
+                std::memcpy(xyz, field + i * span.stride(), sizeof(xyz));
+                out.x[i] = xyz[0];
+                out.y[i] = xyz[1];
+                out.z[i] = xyz[2];
+            }
+        }
+
+        static void ScatterVec3fScalar(Vec3fArrays in, TypeErasedStridedSpan span, size_t fieldOffset, size_t first = 0) {
+            std::byte* field = span.data() + fieldOffset;
+            for (size_t i = first; i < span.numElements(); i++) {
+                float xyz[3] {in.x[i], in.y[i], in.z[i]};
+                std::memcpy(field + i * span.stride(), xyz, sizeof(xyz));
+            }
+        }
+
+        static void AddScaledScalar(float* inOut, const float* addend, float scale, size_t count) {
+            for (size_t i = 0; i < count; i++) {
+                inOut[i] += addend[i] * scale;
+            }
+        }
+
+        static constexpr KernelTable ScalarKernels {
+            .gatherFloat = GatherFloatScalar,
+            .scatterFloat = ScatterFloatScalar,
+            .gatherVec3f = [](TypeErasedStridedSpan span, size_t fieldOffset, Vec3fArrays out) {
+                GatherVec3fScalar(span, fieldOffset, out);
+            },
+            .scatterVec3f = [](Vec3fArrays in, TypeErasedStridedSpan span, size_t fieldOffset) {
+                ScatterVec3fScalar(in, span, fieldOffset);
+            },
+            .addScaled = AddScaledScalar
+        };
+
+#ifdef LPG_SIMD_X86
+
+        /*
+         * Loads four elements as rows of 16 bytes and transposes them. A row reads 4 bytes past the Vec3f,
+         * which stay inside the element or the next one as long as the element is not the last of the span;
+         * the last element is always left to the scalar tail.
+         */
+        LPG_TARGET_SSE2
+        static void GatherVec3fSSE2(TypeErasedStridedSpan span, size_t fieldOffset, Vec3fArrays out) {
+            const std::byte* field = span.data() + fieldOffset;
+            size_t stride = span.stride();
+            size_t i = 0;
+            for (; i + 4 < span.numElements(); i += 4) {
+                const std::byte* p = field + i * stride;
+                __m128 r0 = _mm_loadu_ps(reinterpret_cast<const float*>(p));
+                __m128 r1 = _mm_loadu_ps(reinterpret_cast<const float*>(p + stride));
+                __m128 r2 = _mm_loadu_ps(reinterpret_cast<const float*>(p + 2 * stride));
+                __m128 r3 = _mm_loadu_ps(reinterpret_cast<const float*>(p + 3 * stride));
+                _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+                _mm_storeu_ps(out.x + i, r0);
+                _mm_storeu_ps(out.y + i, r1);
+                _mm_storeu_ps(out.z + i, r2);
+            }
+            GatherVec3fScalar(span, fieldOffset, out, i);
+        }
+
+        /*
+         * Transposes four elements back into rows and writes exactly 12 bytes of each.
+         */
+        LPG_TARGET_SSE2
+        static void ScatterVec3fSSE2(Vec3fArrays in, TypeErasedStridedSpan span, size_t fieldOffset) {
+            std::byte* field = span.data() + fieldOffset;
+            size_t stride = span.stride();
+            size_t i = 0;
+            for (; i + 4 <= span.numElements(); i += 4) {
+                __m128 r0 = _mm_loadu_ps(in.x + i);
+                __m128 r1 = _mm_loadu_ps(in.y + i);
+                __m128 r2 = _mm_loadu_ps(in.z + i);
+                __m128 r3 = _mm_setzero_ps();
+                _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+                __m128 rows[4] {r0, r1, r2, r3};
+                for (int j = 0; j < 4; j++) {
+                    std::byte* p = field + (i + j) * stride;
+                    _mm_storel_pi(reinterpret_cast<__m64*>(p), rows[j]);
+                    _mm_store_ss(reinterpret_cast<float*>(p + 8), _mm_movehl_ps(rows[j], rows[j]));
+                }
+            }
+            ScatterVec3fScalar(in, span, fieldOffset, i);
+        }
+
+        LPG_TARGET_SSE2
+        static void AddScaledSSE2(float* inOut, const float* addend, float scale, size_t count) {
+            __m128 vScale = _mm_set1_ps(scale);
+            size_t i = 0;
+            for (; i + 4 <= count; i += 4) {
+                __m128 v = _mm_add_ps(_mm_loadu_ps(inOut + i), _mm_mul_ps(_mm_loadu_ps(addend + i), vScale));
+                _mm_storeu_ps(inOut + i, v);
+            }
+            AddScaledScalar(inOut + i, addend + i, scale, count - i);
+        }
+
+        static constexpr KernelTable SSE2Kernels {
+            .gatherFloat = GatherFloatScalar, // without a gather instruction there is nothing to gain over scalar loads
+            .scatterFloat = ScatterFloatScalar,
+            .gatherVec3f = GatherVec3fSSE2,
+            .scatterVec3f = ScatterVec3fSSE2,
+            .addScaled = AddScaledSSE2
+        };
+
+        /*
+         * Byte offsets of eight consecutive elements, for gathers with scale 1. Element offsets within a block
+         * of eight fit in 32 bits for any realistic stride.
+         */
+        LPG_TARGET_AVX2
+        static __m256i StrideOffsets(size_t stride) {
+            auto s = static_cast<int32_t>(stride);
+            return _mm256_setr_epi32(0, s, 2 * s, 3 * s, 4 * s, 5 * s, 6 * s, 7 * s);
+        }
+
+        LPG_TARGET_AVX2
+        static void GatherFloatAVX2(TypeErasedStridedSpan span, size_t fieldOffset, float* out) {
+            const std::byte* field = span.data() + fieldOffset;
+            size_t stride = span.stride();
+            __m256i offsets = StrideOffsets(stride);
+            size_t i = 0;
+            for (; i + 8 <= span.numElements(); i += 8) {
+                const auto* base = reinterpret_cast<const float*>(field + i * stride);
+                _mm256_storeu_ps(out + i, _mm256_i32gather_ps(base, offsets, 1));
+            }
+            GatherFloatScalar(span.subspan(i, span.numElements() - i), fieldOffset, out + i);
+        }
+
+        LPG_TARGET_AVX2
+        static void AddScaledAVX2(float* inOut, const float* addend, float scale, size_t count) {
+            __m256 vScale = _mm256_set1_ps(scale);
+            size_t i = 0;
+            for (; i + 8 <= count; i += 8) {
+                __m256 v = _mm256_add_ps(_mm256_loadu_ps(inOut + i), _mm256_mul_ps(_mm256_loadu_ps(addend + i), vScale));
+                _mm256_storeu_ps(inOut + i, v);
+            }
+            AddScaledSSE2(inOut + i, addend + i, scale, count - i);
+        }
+
+        /*
+         * Three gathers per eight Vec3fs measured slower than the SSE2 loads and transposes, and AVX2 has no scatter,
+         * so Vec3fs move through the SSE2 kernels.
+         */
+        static constexpr KernelTable AVX2Kernels {
+            .gatherFloat = GatherFloatAVX2,
+            .scatterFloat = ScatterFloatScalar,
+            .gatherVec3f = GatherVec3fSSE2,
+            .scatterVec3f = ScatterVec3fSSE2,
+            .addScaled = AddScaledAVX2
+        };
+
+#endif
+
+        static InstructionSet DetectInstructionSet() {
+#ifdef LPG_SIMD_X86
+#if defined(_MSC_VER) && !defined(__clang__)
+            int info[4];
+            __cpuid(info, 0);
+            int maxLeaf = info[0];
+            __cpuid(info, 1);
+            bool hasSSE2 = info[3] & (1 << 26);
+            bool osSavesYmm = (info[2] & (1 << 27)) && (info[2] & (1 << 28)) && (_xgetbv(0) & 0x6) == 0x6;
+            bool hasAVX2 = false;
+            if (maxLeaf >= 7 && osSavesYmm) {
+                __cpuidex(info, 7, 0);
+                hasAVX2 = info[1] & (1 << 5);
+            }
+#else
+            __builtin_cpu_init();
+            bool hasSSE2 = __builtin_cpu_supports("sse2");
+            bool hasAVX2 = __builtin_cpu_supports("avx2");
+#endif
+            if (hasAVX2) {
+                return InstructionSet::AVX2;
+            }
+            if (hasSSE2) {
+                return InstructionSet::SSE2;
+            }
+#endif
+            return InstructionSet::Scalar;
+        }
+
+        static const KernelTable* GetKernelTable(InstructionSet instructionSet) {
+            switch (instructionSet) {
+#ifdef LPG_SIMD_X86
+                case InstructionSet::AVX2: return &AVX2Kernels;
+                case InstructionSet::SSE2: return &SSE2Kernels;
+#endif
+                default: return &ScalarKernels;
+            }
+        }
+
+        struct DispatchState {
+            InstructionSet supported = DetectInstructionSet();
+            std::atomic<InstructionSet> active {supported};
+            std::atomic<const KernelTable*> kernels {GetKernelTable(supported)};
+        };
+
+        static DispatchState& GetDispatchState() {
+            static DispatchState state;
+            return state;
+        }
+
+        static const KernelTable& GetKernels() {
+            return *GetDispatchState().kernels.load(std::memory_order_relaxed);
+        }
+    }
+
+    InstructionSet GetSupportedInstructionSet() {
+        return detail::GetDispatchState().supported;
+    }
+
+    InstructionSet GetInstructionSet() {
+        return detail::GetDispatchState().active.load(std::memory_order_relaxed);
+    }
+
+    void SetInstructionSet(InstructionSet instructionSet) {
+        auto& state = detail::GetDispatchState();
+        if (instructionSet > state.supported) {
+            throw std::runtime_error("Instruction set not supported by this CPU");
+        }
+        state.active.store(instructionSet, std::memory_order_relaxed);
+        state.kernels.store(detail::GetKernelTable(instructionSet), std::memory_order_relaxed);
+    }
+
+    void GatherFloat(TypeErasedStridedSpan span, size_t fieldOffset, float* out) {
+        detail::GetKernels().gatherFloat(span, fieldOffset, out);
+    }
+
+    void ScatterFloat(const float* in, TypeErasedStridedSpan span, size_t fieldOffset) {
+        detail::GetKernels().scatterFloat(in, span, fieldOffset);
+    }
+
+    void GatherVec3f(TypeErasedStridedSpan span, size_t fieldOffset, Vec3fArrays out) {
+        detail::GetKernels().gatherVec3f(span, fieldOffset, out);
+    }
+
+    void ScatterVec3f(Vec3fArrays in, TypeErasedStridedSpan span, size_t fieldOffset) {
+        detail::GetKernels().scatterVec3f(in, span, fieldOffset);
+    }
+
+    void AddScaled(float* inOut, const float* addend, float scale, size_t count) {
+        detail::GetKernels().addScaled(inOut, addend, scale, count);
+    }
+
+    std::vector<KernelValidationReport> ValidateKernels(size_t count, uint32_t seed) {
+        // a float, a Vec3f and a float per element, so that the Vec3f is neither first nor last
+        constexpr size_t FloatsPerElement = 5;
+        constexpr size_t Vec3fOffset = sizeof(float);
+        constexpr size_t FloatOffset = 4 * sizeof(float);
+
+        std::mt19937 rng(seed);
+        std::uniform_real_distribution<float> valueDist(-100.0f, 100.0f);
+        auto randomFloats = [&](size_t n) {
+            std::vector<float> result(n);
+            for (auto& value: result) {
+                value = valueDist(rng);
+            }
+            return result;
+        };
+        std::vector<float> elements = randomFloats(count * FloatsPerElement);
+        std::vector<float> scattered = randomFloats(4 * count);
+        std::vector<float> addend = randomFloats(count);
+
+        struct Results {
+            std::vector<float> gathered;
+            std::vector<float> elements;
+            std::vector<float> added;
+        };
+        auto run = [&](InstructionSet instructionSet) {
+            SetInstructionSet(instructionSet);
+            Results results {.gathered = std::vector<float>(4 * count), .elements = elements, .added = std::vector<float>(scattered.begin(), scattered.begin() + count)};
+            float* gathered = results.gathered.data();
+            float* in = scattered.data();
+            TypeErasedStridedSpan span {reinterpret_cast<std::byte*>(results.elements.data()), count, FloatsPerElement * sizeof(float)};
+
+            GatherFloat(span, FloatOffset, gathered);
+            GatherVec3f(span, Vec3fOffset, {gathered + count, gathered + 2 * count, gathered + 3 * count});
+            ScatterFloat(in, span, FloatOffset);
+            ScatterVec3f({in + count, in + 2 * count, in + 3 * count}, span, Vec3fOffset);
+            AddScaled(results.added.data(), addend.data(), 0.37f, count);
+            return results;
+        };
+
+        InstructionSet previous = GetInstructionSet();
+        Results expected = run(InstructionSet::Scalar);
+        std::vector<KernelValidationReport> reports;
+        for (auto instructionSet: {InstructionSet::SSE2, InstructionSet::AVX2}) {
+            if (instructionSet > GetSupportedInstructionSet()) {
+                break;
+            }
+            Results actual = run(instructionSet);
+            KernelValidationReport report {.instructionSet = instructionSet, .count = count};
+            for (size_t i = 0; i < actual.gathered.size(); i++) {
+                report.gatherMismatches += actual.gathered[i] != expected.gathered[i];
+            }
+            for (size_t i = 0; i < actual.elements.size(); i++) {
+                report.scatterMismatches += actual.elements[i] != expected.elements[i];
+            }
+            for (size_t i = 0; i < count; i++) {
+                float error = std::abs(actual.added[i] - expected.added[i]) / std::max(1.0f, std::abs(expected.added[i]));
+                report.addScaledError = std::max(report.addScaledError, error);
+            }
+            reports.push_back(report);
+        }
+        SetInstructionSet(previous);
+        return reports;
+    }
+
+} // lpg::simd
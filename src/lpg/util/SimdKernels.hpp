@@ -0,0 +1,121 @@
+//
+// Created by volt on 2026-10-19.
+//
+
+
+
+
+#ifndef LPG_ENGINE_SRC_LPG_UTIL_SIMDKERNELS_HPP_
+#define LPG_ENGINE_SRC_LPG_UTIL_SIMDKERNELS_HPP_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "strided_span.hpp"
+
+namespace lpg::simd {
+
+    enum class InstructionSet {
+        Scalar,
+        SSE2,
+        AVX2
+    };
+
+    /*
+     * The best instruction set supported by the CPU, detected once per process.
+     */
+    InstructionSet GetSupportedInstructionSet();
+
+    /*
+     * The instruction set the functions below dispatch to. Defaults to the supported one.
+     */
+    InstructionSet GetInstructionSet();
+
+    /*
+     * Forces a narrower instruction set, e.g. to compare results against the scalar path.
+     * Throws if the CPU does not support it.
+     */
+    void SetInstructionSet(InstructionSet instructionSet);
+
+    /*
+     * Structure-of-arrays scratch for Vec3f fields, one array per component.
+     */
+    struct Vec3fArrays {
+        float* x;
+        float* y;
+        float* z;
+    };
+
+    /*
+     * Copy the float or Vec3f field at fieldOffset (e.g. PropertyInfo::offset) of every element of span
+     * into out, or back from in. The field must not straddle elements.
+     */
+    void GatherFloat(TypeErasedStridedSpan span, size_t fieldOffset, float* out);
+    void ScatterFloat(const float* in, TypeErasedStridedSpan span, size_t fieldOffset);
+    void GatherVec3f(TypeErasedStridedSpan span, size_t fieldOffset, Vec3fArrays out);
+    void ScatterVec3f(Vec3fArrays in, TypeErasedStridedSpan span, size_t fieldOffset);
+
+    /*
+     * inOut[i] += addend[i] * scale
+     */
+    void AddScaled(float* inOut, const float* addend, float scale, size_t count);
+
+    inline void AddScaled(Vec3fArrays inOut, Vec3fArrays addend, float scale, size_t count) {
+        AddScaled(inOut.x, addend.x, scale, count);
+        AddScaled(inOut.y, addend.y, scale, count);
+        AddScaled(inOut.z, addend.z, scale, count);
+    }
+
+    inline constexpr size_t BlockSize = 256;
+
+    /*
+     * Runs kernel(Vec3fArrays values, size_t count) over the Vec3f field at fieldOffset of every element,
+     * BlockSize elements at a time: each block is gathered into stack scratch, transformed in place and scattered back.
+     * A kernel taking a third argument also gets the index of values.x[0] in span, e.g. to read other fields.
+     */
+    template<typename TKernel>
+    void TransformVec3f(TypeErasedStridedSpan span, size_t fieldOffset, TKernel&& kernel) {
+        alignas(32) float x[BlockSize], y[BlockSize], z[BlockSize];
+        for (size_t first = 0; first < span.numElements(); first += BlockSize) {
+            size_t count = std::min(BlockSize, span.numElements() - first);
+            auto block = span.subspan(first, count);
+            Vec3fArrays values {x, y, z};
+            GatherVec3f(block, fieldOffset, values);
+            if constexpr(requires{kernel(values, count, first);}) {
+                kernel(values, count, first);
+            } else {
+                kernel(values, count);
+            }
+            ScatterVec3f(values, block, fieldOffset);
+        }
+    }
+
+    /*
+     * Differences found by ValidateKernels between the kernels of one instruction set and the scalar ones.
+     * Gathers and scatters only move bytes, so they must match exactly.
+     */
+    struct KernelValidationReport {
+        InstructionSet instructionSet;
+        size_t count;
+        size_t gatherMismatches; // values gathered by GatherFloat and GatherVec3f
+        size_t scatterMismatches; // floats of the span after ScatterFloat and ScatterVec3f, including those around the fields
+        float addScaledError; // largest relative difference of AddScaled
+
+        [[nodiscard]] bool passed(float tolerance = 1e-6f) const {
+            return gatherMismatches == 0 && scatterMismatches == 0 && addScaledError <= tolerance;
+        }
+    };
+
+    /*
+     * Runs the kernels of every instruction set the CPU supports beyond Scalar over count random elements,
+     * switching between them with SetInstructionSet, and compares them with the scalar kernels.
+     * Restores the instruction set afterwards; no other thread may use the kernels meanwhile.
+     * Meant for tests and for checking a new platform or compiler; it allocates and is not fast.
+     */
+    std::vector<KernelValidationReport> ValidateKernels(size_t count = 1027, uint32_t seed = 1);
+
+} // lpg::simd
+
+#endif //LPG_ENGINE_SRC_LPG_UTIL_SIMDKERNELS_HPP_
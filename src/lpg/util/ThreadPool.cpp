@@ -0,0 +1,129 @@
+//
+// Created by volt on 2026-10-19.
+//
+
+
+
+
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <memory>
+
+namespace lpg {
+
+    ThreadPool::ThreadPool(int numThreads) {
+        workers_.reserve(numThreads);
+        for (int i = 0; i < numThreads; i++) {
+            workers_.emplace_back([this](std::stop_token stopToken) {
+                workerLoop(stopToken);
+            });
+        }
+    }
+
+    ThreadPool::~ThreadPool() {
+        for (auto& worker: workers_) {
+            worker.request_stop();
+        }
+        taskAvailable_.notify_all();
+        workers_.clear();
+    }
+
+    void ThreadPool::submit(std::function<void()> task) {
+        {
+            std::lock_guard lock(mutex_);
+            tasks_.push_back(std::move(task));
+        }
+        taskAvailable_.notify_one();
+    }
+
+    namespace detail {
+
+        /*
+         * Shared with the helper tasks, which may only start after parallelFor returned;
+         * by then every batch is claimed and they leave without touching fn.
+         */
+        struct ParallelForState {
+            const std::function<void(size_t, size_t)>* fn;
+            size_t numItems;
+            size_t batchSize;
+            size_t numBatches;
+            std::atomic<size_t> nextBatch {0};
+            std::atomic<size_t> numBatchesDone {0};
+            std::mutex errorMutex;
+            std::exception_ptr firstError;
+
+            void runBatches() {
+                size_t numDone = 0;
+                for (size_t batch = nextBatch.fetch_add(1); batch < numBatches; batch = nextBatch.fetch_add(1)) {
+                    size_t begin = batch * batchSize;
+                    try {
+                        (*fn)(begin, std::min(begin + batchSize, numItems));
+                    } catch (...) {
+                        std::lock_guard lock(errorMutex);
+                        if (not firstError) {
+                            firstError = std::current_exception();
+                        }
+                    }
+                    numDone++;
+                }
+                if (numDone > 0 && numBatchesDone.fetch_add(numDone) + numDone == numBatches) {
+                    numBatchesDone.notify_all();
+                }
+            }
+        };
+
+    } // namespace detail
+
+    void ThreadPool::parallelFor(size_t numItems, size_t batchSize, const std::function<void(size_t, size_t)>& fn) {
+        if (numItems == 0) {
+            return;
+        }
+        auto state = std::make_shared<detail::ParallelForState>();
+        state->fn = &fn;
+        state->numItems = numItems;
+        state->batchSize = std::max<size_t>(batchSize, 1);
+        state->numBatches = (numItems + state->batchSize - 1) / state->batchSize;
+
+        size_t numHelpers = std::min(state->numBatches - 1, workers_.size());
+        for (size_t i = 0; i < numHelpers; i++) {
+            submit([state] {
+                state->runBatches();
+            });
+        }
+        state->runBatches();
+
+        for (size_t numDone = state->numBatchesDone.load(); numDone != state->numBatches; numDone = state->numBatchesDone.load()) {
+            state->numBatchesDone.wait(numDone);
+        }
+        if (state->firstError) {
+            std::rethrow_exception(state->firstError);
+        }
+    }
+
+    int ThreadPool::numThreads() const {
+        return static_cast<int>(workers_.size());
+    }
+
+    int ThreadPool::DefaultNumThreads() {
+        return std::max(1, static_cast<int>(std::thread::hardware_concurrency()) - 1);
+    }
+
+    void ThreadPool::workerLoop(std::stop_token stopToken) {
+        while (true) {
+            std::function<void()> task;
+            {
+                std::unique_lock lock(mutex_);
+                if (not taskAvailable_.wait(lock, stopToken, [this] { return not tasks_.empty(); })) {
+                    return;
+                }
+                task = std::move(tasks_.front());
+                tasks_.pop_front();
+            }
+            task();
+        }
+    }
+
+} // lpg
@@ -0,0 +1,58 @@
+//
+// Created by volt on 2026-10-19.
+//
+
+
+
+
+#ifndef LPG_ENGINE_SRC_LPG_UTIL_THREADPOOL_HPP_
+#define LPG_ENGINE_SRC_LPG_UTIL_THREADPOOL_HPP_
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <stop_token>
+#include <thread>
+#include <vector>
+
+namespace lpg {
+
+    /*
+     * A fixed set of worker threads consuming a shared FIFO of tasks.
+     * Tasks still queued when the pool is destroyed are discarded.
+     */
+    class ThreadPool {
+    public:
+        explicit ThreadPool(int numThreads);
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        void submit(std::function<void()> task);
+
+        /*
+         * Calls fn(begin, end) for consecutive batches of at most batchSize items covering [0, numItems),
+         * on the workers and the calling thread, and returns once all of them are done.
+         * The calling thread takes batches too, so this is safe from inside a task of the same pool even when
+         * every worker is busy. The first exception thrown by fn is rethrown after the remaining batches finish.
+         */
+        void parallelFor(size_t numItems, size_t batchSize, const std::function<void(size_t, size_t)>& fn);
+
+        [[nodiscard]] int numThreads() const;
+
+        static int DefaultNumThreads();
+
+    private:
+        void workerLoop(std::stop_token stopToken);
+
+        std::mutex mutex_;
+        std::condition_variable_any taskAvailable_;
+        std::deque<std::function<void()>> tasks_;
+        std::vector<std::jthread> workers_;
+    };
+
+} // lpg
+
+#endif //LPG_ENGINE_SRC_LPG_UTIL_THREADPOOL_HPP_
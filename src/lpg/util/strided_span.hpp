@@ -8,8 +8,13 @@
 #ifndef LPG_ENGINE_SRC_LPG_UTIL_STRIDED_SPAN_HPP_
 #define LPG_ENGINE_SRC_LPG_UTIL_STRIDED_SPAN_HPP_
 
-#include <iterator>
+#include <algorithm>
+#include <compare>
 #include <cstddef>
+#include <iterator>
+#include <ranges>
+#include <type_traits>
+#include <utility>
 
 namespace lpg {
 
@@ -32,6 +37,18 @@ namespace lpg {
             return numElements_;
         }
 
+        std::byte* data() const {
+            return data_;
+        }
+
+        size_t stride() const {
+            return stride_;
+        }
+
+        TypeErasedStridedSpan subspan(size_t offset, size_t count) const {
+            return {data_ + offset * stride_, count, stride_};
+        }
+
         template<typename T>
         auto interpretAs() const;
 
@@ -42,9 +59,93 @@ namespace lpg {
 
 
 
+    /*
+     * A random-access iterator over elements that are stride bytes apart. It holds the element address itself,
+     * so it stays valid after the span it came from is gone. Iterators compared or subtracted must come
+     * from the same span, whose stride must be non-zero, or both be value-initialized.
+     */
     template<typename T>
-    class StridedSpan {
+    class StridedIterator {
     public:
+        using iterator_concept = std::random_access_iterator_tag;
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = std::remove_cv_t<T>;
+        using difference_type = std::ptrdiff_t;
+        using pointer = T*;
+        using reference = T&;
+
+        StridedIterator() = default;
+
+        StridedIterator(std::byte* ptr, size_t stride)
+            : ptr_(ptr),
+              stride_(static_cast<std::ptrdiff_t>(stride)) {
+        }
+
+        operator StridedIterator<const T>() const requires (not std::is_const_v<T>) {
+            return {ptr_, static_cast<size_t>(stride_)};
+        }
+
+        T& operator*() const {
+            return *reinterpret_cast<T*>(ptr_);
+        }
+
+        T* operator->() const {
+            return reinterpret_cast<T*>(ptr_);
+        }
+
+        T& operator[](difference_type n) const {
+            return *reinterpret_cast<T*>(ptr_ + n * stride_);
+        }
+
+        StridedIterator& operator++() {ptr_ += stride_; return *this;}
+        StridedIterator operator++(int) {auto old = *this; ptr_ += stride_; return old;}
+        StridedIterator& operator--() {ptr_ -= stride_; return *this;}
+        StridedIterator operator--(int) {auto old = *this; ptr_ -= stride_; return old;}
+        StridedIterator& operator+=(difference_type n) {ptr_ += n * stride_; return *this;}
+        StridedIterator& operator-=(difference_type n) {ptr_ -= n * stride_; return *this;}
+
+        friend StridedIterator operator+(StridedIterator it, difference_type n) {return it += n;}
+        friend StridedIterator operator+(difference_type n, StridedIterator it) {return it += n;}
+        friend StridedIterator operator-(StridedIterator it, difference_type n) {return it -= n;}
+        friend difference_type operator-(const StridedIterator& a, const StridedIterator& b) {
+            // value-initialized iterators have no stride, and must compare as an empty range
+            if (a.ptr_ == b.ptr_) {
+                return 0;
+            }
+            return (a.ptr_ - b.ptr_) / a.stride_;
+        }
+
+        friend bool operator==(const StridedIterator& a, const StridedIterator& b) {
+            return a.ptr_ == b.ptr_;
+        }
+        friend std::strong_ordering operator<=>(const StridedIterator& a, const StridedIterator& b) {
+            return std::compare_three_way{}(a.ptr_, b.ptr_);
+        }
+
+    private:
+        std::byte* ptr_ = nullptr;
+        std::ptrdiff_t stride_ = 0;
+    };
+
+    /*
+     * A non-owning view of numElements objects of type T, stride bytes apart, e.g. one component
+     * inside every entity of a page. Like std::span, a const StridedSpan still gives mutable elements;
+     * StridedSpan<const T> (see asConst) does not.
+     *
+     * It models std::ranges::random_access_range, sized_range and borrowed_range, so the standard
+     * algorithms, including the parallel ones, run straight over page storage:
+     *     std::for_each(std::execution::par_unseq, span.begin(), span.end(), ...);
+     * subspan, split and chunk divide it into disjoint parts for handing out to worker threads.
+     */
+    template<typename T>
+    class StridedSpan : public std::ranges::view_interface<StridedSpan<T>> {
+    public:
+        using element_type = T;
+        using value_type = std::remove_cv_t<T>;
+        using size_type = size_t;
+        using difference_type = std::ptrdiff_t;
+        using iterator = StridedIterator<T>;
+        using const_iterator = StridedIterator<const T>;
 
         StridedSpan(std::byte *data, size_t numElements, size_t stride)
             : underlying_(data, numElements, stride)
@@ -54,41 +155,59 @@ namespace lpg {
 
         }
 
-        auto&& operator[](this auto&& self, size_t index) {
-            return *reinterpret_cast<T*>(self.underlying_.nth_element(index));
+        template<typename U>
+            requires std::is_same_v<const U, T> && (not std::is_same_v<U, T>)
+        StridedSpan(const StridedSpan<U>& other) : underlying_(other.typeErased()) {
+
         }
 
-        struct iterator {
-            StridedSpan *const sspan_;
-            size_t index_;
+        T& operator[](size_t index) const {
+            return *reinterpret_cast<T*>(underlying_.nth_element(index));
+        }
 
-            using iterator_category = std::random_access_iterator_tag;
-            using difference_type = std::ptrdiff_t;
-            using value_type = std::remove_reference_t<T>;
-            using pointer = value_type*;
-            using reference = value_type&;
+        iterator begin() const {
+            return {underlying_.data(), underlying_.stride()};
+        }
+        iterator end() const {
+            return begin() + static_cast<difference_type>(size());
+        }
+        const_iterator cbegin() const {
+            return begin();
+        }
+        const_iterator cend() const {
+            return end();
+        }
+        size_t size() const {
+            return underlying_.numElements();
+        }
 
+        [[nodiscard]] const TypeErasedStridedSpan& typeErased() const {
+            return underlying_;
+        }
 
-            auto&& operator*() {
-                return *reinterpret_cast<value_type*>(sspan_->underlying_.nth_element(index_));
-            }
-            iterator& operator++() {++index_; return *this;}
-            iterator& operator++(int) {++index_; return *this;}
-            iterator& operator+=(int n) {index_ += n; return *this;}
-            iterator& operator-=(int n) {index_ -= n; return *this;}
-            iterator operator+(int n) {return iterator{sspan_, index_ + n};}
-            iterator operator-(int n) {return iterator{sspan_, index_ - n};}
-            friend auto operator<=>(const iterator &, const iterator &) = default;
-        };
-
-        iterator begin() {
-            return {.sspan_ = this, .index_ = 0};
-        }
-        iterator end() {
-            return {.sspan_ = this, .index_ = size()};
-        }
-        size_t size() {
-            return underlying_.numElements();
+        [[nodiscard]] StridedSpan<const T> asConst() const {
+            return *this;
+        }
+
+        [[nodiscard]] StridedSpan subspan(size_t offset, size_t count) const {
+            return StridedSpan{underlying_.subspan(offset, count)};
+        }
+
+        /*
+         * [0, index) and [index, size())
+         */
+        [[nodiscard]] std::pair<StridedSpan, StridedSpan> split(size_t index) const {
+            return {subspan(0, index), subspan(index, size() - index)};
+        }
+
+        /*
+         * Part partIndex of numParts contiguous parts whose sizes differ by at most one; together they cover the span.
+         */
+        [[nodiscard]] StridedSpan chunk(size_t partIndex, size_t numParts) const {
+            size_t base = size() / numParts;
+            size_t remainder = size() % numParts;
+            size_t offset = partIndex * base + std::min(partIndex, remainder);
+            return subspan(offset, base + (partIndex < remainder));
         }
 
     private:
@@ -104,4 +223,18 @@ namespace lpg {
 
 }
 
+template<typename T>
+inline constexpr bool std::ranges::enable_borrowed_range<lpg::StridedSpan<T>> = true;
+
+// what the StridedSpan documentation promises, so that a change breaking it fails here rather than in a caller
+static_assert(std::random_access_iterator<lpg::StridedIterator<int>>);
+static_assert(std::random_access_iterator<lpg::StridedIterator<const int>>);
+static_assert(std::ranges::random_access_range<lpg::StridedSpan<int>>);
+static_assert(std::ranges::random_access_range<lpg::StridedSpan<const int>>);
+static_assert(std::ranges::sized_range<lpg::StridedSpan<int>>);
+static_assert(std::ranges::view<lpg::StridedSpan<int>>);
+static_assert(std::ranges::view<lpg::StridedSpan<const int>>);
+static_assert(std::ranges::borrowed_range<lpg::StridedSpan<int>>);
+static_assert(std::ranges::borrowed_range<lpg::StridedSpan<const int>>);
+
 #endif //LPG_ENGINE_SRC_LPG_UTIL_STRIDED_SPAN_HPP_